@@ -51,7 +51,7 @@ class QOutputPreviewWidget : public QWidget
 public:
 	QOutputPreviewWidget(IGraphOutput* pOutput);
 
-	void OnOutputChanged();
+	void OnOutputChanged(const SGraphOutputEditorPreview& preview);
 	void SyncUndoValue();
 
 	inline IGraphOutput* GetOutput() const { return m_Output; }
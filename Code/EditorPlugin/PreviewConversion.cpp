@@ -0,0 +1,648 @@
+/** @file PreviewConversion.cpp
+	@brief Source File for the conversion of the rendered outputs to Qt images
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+
+#include "PreviewConversion.h"
+#include "Substance/IProceduralMaterial.h"
+#include <ITexture.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <AzCore/Jobs/JobCompletion.h>
+#include <AzCore/Jobs/JobContext.h>
+#include <AzCore/Jobs/JobFunction.h>
+#include <AzCore/Jobs/JobManager.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PC_SIMD_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PC_TARGET_AVX2
+#else
+#define PC_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#endif
+#endif
+
+namespace PreviewConversion
+{
+
+// Minimum number of pixels converted by each job:
+static const int kPixelsPerJob = 256*256;
+
+/////////////////////////////////////////////////////////////////////////////
+// Scalar helpers
+/////////////////////////////////////////////////////////////////////////////
+
+// Rounded 16 to 8 bits conversion, ie. round(v*255/65535):
+static inline uint32_t Narrow16(uint32_t v)
+{
+	return (((v*0xFF01u) >> 16) + 128) >> 8;
+}
+
+static inline uint32_t FloatToByte(float f)
+{
+	// NaN values are converted to 0:
+	f = f > 0.0f ? f : 0.0f;
+	f = f < 1.0f ? f : 1.0f;
+	return (uint32_t)(int)(f*255.0f + 0.5f);
+}
+
+// Half to float conversion by rescaling the exponent, infinities and NaN are preserved:
+static inline float HalfToFloat(uint32_t h)
+{
+	uint32_t bits = (h & 0x7FFFu) << 13;
+	float f;
+	memcpy(&f, &bits, 4);
+	f *= 5.192296858534828e+33f; // 2^112
+
+	memcpy(&bits, &f, 4);
+	if((h & 0x7C00u) == 0x7C00u) {
+		bits |= 0x7F800000u;
+	}
+	bits |= (h & 0x8000u) << 16;
+	memcpy(&f, &bits, 4);
+	return f;
+}
+
+static inline uint16_t LoadHalf(const uint8_t* p)
+{
+	uint16_t v;
+	memcpy(&v, p, 2);
+	return v;
+}
+
+static inline float LoadFloat(const uint8_t* p)
+{
+	float v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+// The alpha of the gray pixels is masked by the row kernels:
+static inline QRgb Gray(uint32_t l)
+{
+	return l*0x01010101u;
+}
+
+static inline QRgb Rgba(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+	return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SIMD helpers
+/////////////////////////////////////////////////////////////////////////////
+
+#if defined(PC_SIMD_X86)
+
+static inline __m128i Narrow16SSE2(__m128i v)
+{
+	__m128i t = _mm_mulhi_epu16(v, _mm_set1_epi16((short)0xFF01));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_set1_epi16(128)), 8);
+}
+
+static inline __m128i FloatToByteSSE2(__m128 f)
+{
+	f = _mm_max_ps(f, _mm_setzero_ps());
+	f = _mm_min_ps(f, _mm_set1_ps(1.0f));
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+// Same as HalfToFloat() on 4 halves stored in the low bits of 32 bits lanes:
+static inline __m128 HalfToFloatSSE2(__m128i h)
+{
+	const __m128i exponent = _mm_set1_epi32(0x7C00);
+	__m128i bits = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)), 13);
+	__m128 f = _mm_mul_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(_mm_set1_epi32(0x77800000)));
+
+	__m128i infnan = _mm_cmpeq_epi32(_mm_and_si128(h, exponent), exponent);
+	bits = _mm_or_si128(_mm_castps_si128(f), _mm_and_si128(infnan, _mm_set1_epi32(0x7F800000)));
+	bits = _mm_or_si128(bits, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+	return _mm_castsi128_ps(bits);
+}
+
+// Spread 4 bytes stored in the low bits of 32 bits lanes:
+static inline __m128i GraySSE2(__m128i l)
+{
+	l = _mm_or_si128(l, _mm_slli_epi32(l, 8));
+	return _mm_or_si128(l, _mm_slli_epi32(l, 16));
+}
+
+// Swap the red and blue bytes of 4 RGBA8 pixels:
+static inline __m128i SwizzleSSE2(__m128i x)
+{
+	__m128i ag = _mm_and_si128(x, _mm_set1_epi32((int)0xFF00FF00));
+	__m128i rb = _mm_and_si128(x, _mm_set1_epi32(0x00FF00FF));
+	rb = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm_or_si128(ag, rb);
+}
+
+// Pack 4 pixels of 4 bytes stored in 32 bits lanes:
+static inline __m128i PackPixelsSSE2(__m128i p0, __m128i p1, __m128i p2, __m128i p3)
+{
+	return _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+}
+
+PC_TARGET_AVX2 static inline __m256i Narrow16AVX2(__m256i v)
+{
+	__m256i t = _mm256_mulhi_epu16(v, _mm256_set1_epi16((short)0xFF01));
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_set1_epi16(128)), 8);
+}
+
+PC_TARGET_AVX2 static inline __m256i FloatToByteAVX2(__m256 f)
+{
+	f = _mm256_max_ps(f, _mm256_setzero_ps());
+	f = _mm256_min_ps(f, _mm256_set1_ps(1.0f));
+	return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(f, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+}
+
+PC_TARGET_AVX2 static inline __m256i GrayAVX2(__m256i l)
+{
+	return _mm256_mullo_epi32(l, _mm256_set1_epi32(0x01010101));
+}
+
+PC_TARGET_AVX2 static inline __m256i SwizzleAVX2(__m256i x)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	return _mm256_shuffle_epi8(x, mask);
+}
+
+// Pack 8 pixels of 4 bytes, stored by pairs in 32 bits lanes:
+PC_TARGET_AVX2 static inline __m256i PackPixelsAVX2(__m256i p01, __m256i p23, __m256i p45, __m256i p67)
+{
+	// The in-lane packing interleaves the pixels as 0 2 4 6 1 3 5 7:
+	__m256i x = _mm256_packus_epi16(_mm256_packs_epi32(p01, p23), _mm256_packs_epi32(p45, p67));
+	return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+#endif // PC_SIMD_X86
+
+/////////////////////////////////////////////////////////////////////////////
+// Formats
+/////////////////////////////////////////////////////////////////////////////
+
+// Each format loads 1 pixel (scalar), 4 pixels (SSE2) or 8 pixels (AVX2) as QRgb values:
+
+struct FormatL8
+{
+	static const int kBytesPerPixel = 1;
+	static const bool kAlpha = false;
+
+	static inline QRgb Load(const uint8_t* p)
+	{
+		return Gray(p[0]);
+	}
+
+#if defined(PC_SIMD_X86)
+	static inline __m128i Load4(const uint8_t* p)
+	{
+		int v;
+		memcpy(&v, p, 4);
+		__m128i x = _mm_cvtsi32_si128(v);
+		x = _mm_unpacklo_epi8(x, x);
+		return _mm_unpacklo_epi16(x, x);
+	}
+
+	PC_TARGET_AVX2 static inline __m256i Load8(const uint8_t* p)
+	{
+		return GrayAVX2(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p)));
+	}
+#endif
+};
+
+struct FormatR16
+{
+	static const int kBytesPerPixel = 2;
+	static const bool kAlpha = false;
+
+	static inline QRgb Load(const uint8_t* p)
+	{
+		return Gray(Narrow16(LoadHalf(p)));
+	}
+
+#if defined(PC_SIMD_X86)
+	static inline __m128i Load4(const uint8_t* p)
+	{
+		__m128i x = Narrow16SSE2(_mm_loadl_epi64((const __m128i*)p));
+		return GraySSE2(_mm_unpacklo_epi16(x, _mm_setzero_si128()));
+	}
+
+	PC_TARGET_AVX2 static inline __m256i Load8(const uint8_t* p)
+	{
+		__m128i x = Narrow16SSE2(_mm_loadu_si128((const __m128i*)p));
+		return GrayAVX2(_mm256_cvtepu16_epi32(x));
+	}
+#endif
+};
+
+struct FormatRGBA8
+{
+	static const int kBytesPerPixel = 4;
+	static const bool kAlpha = true;
+
+	static inline QRgb Load(const uint8_t* p)
+	{
+		return Rgba(p[0], p[1], p[2], p[3]);
+	}
+
+#if defined(PC_SIMD_X86)
+	static inline __m128i Load4(const uint8_t* p)
+	{
+		return SwizzleSSE2(_mm_loadu_si128((const __m128i*)p));
+	}
+
+	PC_TARGET_AVX2 static inline __m256i Load8(const uint8_t* p)
+	{
+		return SwizzleAVX2(_mm256_loadu_si256((const __m256i*)p));
+	}
+#endif
+};
+
+struct FormatRGBA16
+{
+	static const int kBytesPerPixel = 8;
+	static const bool kAlpha = true;
+
+	static inline QRgb Load(const uint8_t* p)
+	{
+		return Rgba(Narrow16(LoadHalf(p)), Narrow16(LoadHalf(p+2)), Narrow16(LoadHalf(p+4)), Narrow16(LoadHalf(p+6)));
+	}
+
+#if defined(PC_SIMD_X86)
+	static inline __m128i Load4(const uint8_t* p)
+	{
+		__m128i p01 = Narrow16SSE2(_mm_loadu_si128((const __m128i*)p));
+		__m128i p23 = Narrow16SSE2(_mm_loadu_si128((const __m128i*)(p+16)));
+		return SwizzleSSE2(_mm_packus_epi16(p01, p23));
+	}
+
+	PC_TARGET_AVX2 static inline __m256i Load8(const uint8_t* p)
+	{
+		__m256i p0123 = Narrow16AVX2(_mm256_loadu_si256((const __m256i*)p));
+		__m256i p4567 = Narrow16AVX2(_mm256_loadu_si256((const __m256i*)(p+32)));
+
+		// The in-lane packing interleaves the pixels as 0 1 4 5 2 3 6 7:
+		__m256i x = _mm256_permute4x64_epi64(_mm256_packus_epi16(p0123, p4567), _MM_SHUFFLE(3, 1, 2, 0));
+		return SwizzleAVX2(x);
+	}
+#endif
+};
+
+struct FormatR16F
+{
+	static const int kBytesPerPixel = 2;
+	static const bool kAlpha = false;
+
+	static inline QRgb Load(const uint8_t* p)
+	{
+		return Gray(FloatToByte(HalfToFloat(LoadHalf(p))));
+	}
+
+#if defined(PC_SIMD_X86)
+	static inline __m128i Load4(const uint8_t* p)
+	{
+		__m128i h = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128());
+		return GraySSE2(FloatToByteSSE2(HalfToFloatSSE2(h)));
+	}
+
+	PC_TARGET_AVX2 static inline __m256i Load8(const uint8_t* p)
+	{
+		return GrayAVX2(FloatToByteAVX2(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p))));
+	}
+#endif
+};
+
+struct FormatRGBA16F
+{
+	static const int kBytesPerPixel = 8;
+	static const bool kAlpha = true;
+
+	static inline QRgb Load(const uint8_t* p)
+	{
+		return Rgba(
+			FloatToByte(HalfToFloat(LoadHalf(p))),
+			FloatToByte(HalfToFloat(LoadHalf(p+2))),
+			FloatToByte(HalfToFloat(LoadHalf(p+4))),
+			FloatToByte(HalfToFloat(LoadHalf(p+6))));
+	}
+
+#if defined(PC_SIMD_X86)
+	static inline __m128i Load4(const uint8_t* p)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		__m128i h01 = _mm_loadu_si128((const __m128i*)p);
+		__m128i h23 = _mm_loadu_si128((const __m128i*)(p+16));
+		return SwizzleSSE2(PackPixelsSSE2(
+			FloatToByteSSE2(HalfToFloatSSE2(_mm_unpacklo_epi16(h01, zero))),
+			FloatToByteSSE2(HalfToFloatSSE2(_mm_unpackhi_epi16(h01, zero))),
+			FloatToByteSSE2(HalfToFloatSSE2(_mm_unpacklo_epi16(h23, zero))),
+			FloatToByteSSE2(HalfToFloatSSE2(_mm_unpackhi_epi16(h23, zero)))));
+	}
+
+	PC_TARGET_AVX2 static inline __m256i Load8(const uint8_t* p)
+	{
+		return SwizzleAVX2(PackPixelsAVX2(
+			FloatToByteAVX2(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p))),
+			FloatToByteAVX2(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(p+16)))),
+			FloatToByteAVX2(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(p+32)))),
+			FloatToByteAVX2(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(p+48))))));
+	}
+#endif
+};
+
+struct FormatR32F
+{
+	static const int kBytesPerPixel = 4;
+	static const bool kAlpha = false;
+
+	static inline QRgb Load(const uint8_t* p)
+	{
+		return Gray(FloatToByte(LoadFloat(p)));
+	}
+
+#if defined(PC_SIMD_X86)
+	static inline __m128i Load4(const uint8_t* p)
+	{
+		return GraySSE2(FloatToByteSSE2(_mm_loadu_ps((const float*)p)));
+	}
+
+	PC_TARGET_AVX2 static inline __m256i Load8(const uint8_t* p)
+	{
+		return GrayAVX2(FloatToByteAVX2(_mm256_loadu_ps((const float*)p)));
+	}
+#endif
+};
+
+struct FormatRGBA32F
+{
+	static const int kBytesPerPixel = 16;
+	static const bool kAlpha = true;
+
+	static inline QRgb Load(const uint8_t* p)
+	{
+		return Rgba(FloatToByte(LoadFloat(p)), FloatToByte(LoadFloat(p+4)), FloatToByte(LoadFloat(p+8)), FloatToByte(LoadFloat(p+12)));
+	}
+
+#if defined(PC_SIMD_X86)
+	static inline __m128i Load4(const uint8_t* p)
+	{
+		const float* f = (const float*)p;
+		return SwizzleSSE2(PackPixelsSSE2(
+			FloatToByteSSE2(_mm_loadu_ps(f)),
+			FloatToByteSSE2(_mm_loadu_ps(f+4)),
+			FloatToByteSSE2(_mm_loadu_ps(f+8)),
+			FloatToByteSSE2(_mm_loadu_ps(f+12))));
+	}
+
+	PC_TARGET_AVX2 static inline __m256i Load8(const uint8_t* p)
+	{
+		const float* f = (const float*)p;
+		return SwizzleAVX2(PackPixelsAVX2(
+			FloatToByteAVX2(_mm256_loadu_ps(f)),
+			FloatToByteAVX2(_mm256_loadu_ps(f+8)),
+			FloatToByteAVX2(_mm256_loadu_ps(f+16)),
+			FloatToByteAVX2(_mm256_loadu_ps(f+24))));
+	}
+#endif
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Row kernels
+/////////////////////////////////////////////////////////////////////////////
+
+// The output pixels are (pixel & keep) | alpha:
+typedef void (*RowFunction)(const uint8_t* src, QRgb* dst, int count, uint32_t keep, uint32_t alpha);
+
+template<class Format>
+static void ConvertRowScalar(const uint8_t* src, QRgb* dst, int count, uint32_t keep, uint32_t alpha)
+{
+	for(int x = 0; x < count; x++) {
+		dst[x] = (Format::Load(src + x*Format::kBytesPerPixel) & keep) | alpha;
+	}
+}
+
+#if defined(PC_SIMD_X86)
+
+template<class Format>
+static void ConvertRowSSE2(const uint8_t* src, QRgb* dst, int count, uint32_t keep, uint32_t alpha)
+{
+	const __m128i keep4 = _mm_set1_epi32((int)keep);
+	const __m128i alpha4 = _mm_set1_epi32((int)alpha);
+
+	int x = 0;
+	for(; x+4 <= count; x += 4) {
+		__m128i pixels = Format::Load4(src + x*Format::kBytesPerPixel);
+		_mm_storeu_si128((__m128i*)(dst + x), _mm_or_si128(_mm_and_si128(pixels, keep4), alpha4));
+	}
+
+	ConvertRowScalar<Format>(src + x*Format::kBytesPerPixel, dst + x, count - x, keep, alpha);
+}
+
+template<class Format>
+PC_TARGET_AVX2 static void ConvertRowAVX2(const uint8_t* src, QRgb* dst, int count, uint32_t keep, uint32_t alpha)
+{
+	const __m256i keep8 = _mm256_set1_epi32((int)keep);
+	const __m256i alpha8 = _mm256_set1_epi32((int)alpha);
+
+	int x = 0;
+	for(; x+8 <= count; x += 8) {
+		__m256i pixels = Format::Load8(src + x*Format::kBytesPerPixel);
+		_mm256_storeu_si256((__m256i*)(dst + x), _mm256_or_si256(_mm256_and_si256(pixels, keep8), alpha8));
+	}
+
+	ConvertRowScalar<Format>(src + x*Format::kBytesPerPixel, dst + x, count - x, keep, alpha);
+}
+
+#endif // PC_SIMD_X86
+
+template<class Format>
+static RowFunction GetRowFunction(Kernel kernel, int& bytesPerPixel, bool& hasAlpha)
+{
+	bytesPerPixel = Format::kBytesPerPixel;
+	hasAlpha = Format::kAlpha;
+
+#if defined(PC_SIMD_X86)
+	if(kernel == Kernel_AVX2) {
+		return &ConvertRowAVX2<Format>;
+	}
+	if(kernel == Kernel_SSE2) {
+		return &ConvertRowSSE2<Format>;
+	}
+#endif
+	return &ConvertRowScalar<Format>;
+}
+
+static RowFunction GetRowFunction(int format, Kernel kernel, int& bytesPerPixel, bool& hasAlpha)
+{
+	switch(format) {
+	case eTF_L8:				return GetRowFunction<FormatL8>(kernel, bytesPerPixel, hasAlpha);
+	case eTF_R16:				return GetRowFunction<FormatR16>(kernel, bytesPerPixel, hasAlpha);
+	case eTF_R8G8B8A8:			return GetRowFunction<FormatRGBA8>(kernel, bytesPerPixel, hasAlpha);
+	case eTF_R16G16B16A16:		return GetRowFunction<FormatRGBA16>(kernel, bytesPerPixel, hasAlpha);
+	case eTF_R16F:				return GetRowFunction<FormatR16F>(kernel, bytesPerPixel, hasAlpha);
+	case eTF_R16G16B16A16F:		return GetRowFunction<FormatRGBA16F>(kernel, bytesPerPixel, hasAlpha);
+	case eTF_R32F:				return GetRowFunction<FormatR32F>(kernel, bytesPerPixel, hasAlpha);
+	case eTF_R32G32B32A32F:		return GetRowFunction<FormatRGBA32F>(kernel, bytesPerPixel, hasAlpha);
+	default:					return nullptr;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Dispatch
+/////////////////////////////////////////////////////////////////////////////
+
+static bool CpuSupportsAVX2()
+{
+#if defined(PC_SIMD_X86)
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7) {
+		return false;
+	}
+
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1<<27)) != 0;
+	bool avx = (info[2] & (1<<28)) != 0;
+	bool f16c = (info[2] & (1<<29)) != 0;
+	__cpuidex(info, 7, 0);
+	bool avx2 = (info[1] & (1<<5)) != 0;
+
+	// Check that the OS saves the YMM registers:
+	return osxsave && avx && f16c && avx2 && (_xgetbv(0) & 6) == 6;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("f16c") != 0;
+#endif
+#else
+	return false;
+#endif
+}
+
+bool IsKernelSupported(Kernel kernel)
+{
+	switch(kernel) {
+	case Kernel_Scalar:
+	case Kernel_Best:
+		return true;
+#if defined(PC_SIMD_X86)
+	case Kernel_SSE2:
+		return true;
+	case Kernel_AVX2:
+	{
+		static const bool avx2 = CpuSupportsAVX2();
+		return avx2;
+	}
+#endif
+	default:
+		return false;
+	}
+}
+
+const char* GetKernelName(Kernel kernel)
+{
+	switch(kernel) {
+	case Kernel_Scalar: return "scalar";
+	case Kernel_SSE2: return "sse2";
+	case Kernel_AVX2: return "avx2";
+	default: return "best";
+	}
+}
+
+bool IsFormatSupported(int format)
+{
+	int bytesPerPixel;
+	bool hasAlpha;
+	return GetRowFunction(format, Kernel_Scalar, bytesPerPixel, hasAlpha) != nullptr;
+}
+
+bool IsLuminanceFormat(int format)
+{
+	int bytesPerPixel;
+	bool hasAlpha;
+	return GetRowFunction(format, Kernel_Scalar, bytesPerPixel, hasAlpha) != nullptr && !hasAlpha;
+}
+
+bool Convert(int format, const void* src, int width, int height, QRgb* dst, int dstStride, bool opaque, Kernel kernel, int jobCount)
+{
+	if(kernel == Kernel_Best || !IsKernelSupported(kernel)) {
+		kernel = IsKernelSupported(Kernel_AVX2) ? Kernel_AVX2 : (IsKernelSupported(Kernel_SSE2) ? Kernel_SSE2 : Kernel_Scalar);
+	}
+
+	int bytesPerPixel;
+	bool hasAlpha;
+	RowFunction convertRow = GetRowFunction(format, kernel, bytesPerPixel, hasAlpha);
+	if(!convertRow) {
+		return false;
+	}
+
+	if(width <= 0 || height <= 0) {
+		return true;
+	}
+
+	uint32_t keep = (opaque || !hasAlpha) ? 0x00FFFFFFu : 0xFFFFFFFFu;
+	uint32_t alpha = (opaque || !hasAlpha) ? 0xFF000000u : 0u;
+	size_t srcStride = (size_t)width*bytesPerPixel;
+
+	auto convertRows = [=](int row0, int row1) {
+		for(int y = row0; y < row1; y++) {
+			convertRow((const uint8_t*)src + y*srcStride, dst + (size_t)y*dstStride, width, keep, alpha);
+		}
+	};
+
+	// The rows are converted by the shared workers of the job manager, or by the caller without a job manager:
+	AZ::JobContext* jobContext = AZ::JobContext::GetGlobalContext();
+	if(jobCount <= 0) {
+		int workers = jobContext ? (int)jobContext->GetJobManager().GetNumWorkerThreads() + 1 : 1;
+		jobCount = std::min(workers, std::max(width*height/kPixelsPerJob, 1));
+	}
+	jobCount = std::min(jobCount, height);
+
+	if(jobCount <= 1 || !jobContext) {
+		convertRows(0, height);
+		return true;
+	}
+
+	// Split the rows in jobs, the caller converts the first range:
+	AZ::JobCompletion completion(jobContext);
+	int rowsPerJob = (height + jobCount - 1)/jobCount;
+	for(int row0 = rowsPerJob; row0 < height; row0 += rowsPerJob) {
+		int row1 = std::min(row0 + rowsPerJob, height);
+		AZ::Job* job = AZ::CreateJobFunction([=]() {
+			convertRows(row0, row1);
+		}, true, jobContext);
+		job->SetDependent(&completion);
+		job->Start();
+	}
+
+	convertRows(0, std::min(rowsPerJob, height));
+
+	completion.StartAndWaitForCompletion();
+	return true;
+}
+
+bool ToImage(const SGraphOutputEditorPreview& preview, QImage& image)
+{
+	if(!preview.Data || !IsFormatSupported(preview.Format)) {
+		return false;
+	}
+
+	image = QImage(preview.Width, preview.Height, QImage::Format_RGB32);
+	return Convert(preview.Format, preview.Data, preview.Width, preview.Height, (QRgb*)image.bits(), image.bytesPerLine()/4, true);
+}
+
+} // namespace PreviewConversion
+
+#endif // USE_SUBSTANCE
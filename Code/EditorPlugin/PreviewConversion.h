@@ -0,0 +1,62 @@
+/** @file PreviewConversion.h
+	@brief Header for the conversion of the rendered outputs to Qt images
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef SUBSTANCE_PROCEDURALMATERIALEDITORPLUGIN_PREVIEWCONVERSION_H
+#define SUBSTANCE_PROCEDURALMATERIALEDITORPLUGIN_PREVIEWCONVERSION_H
+#pragma once
+
+#if defined(USE_SUBSTANCE)
+
+#include <QColor>
+#include <QImage>
+
+struct SGraphOutputEditorPreview;
+
+/**
+ Conversion of the output pixels to QRgb values (0xAARRGGBB).
+
+ Each supported engine format (R16, RGBA16, RGBA8, L8, half and float
+ variants) has its own templated kernel, with SSE2 and AVX2 versions doing the
+ 16 to 8 bits narrowing and the swizzling by groups of pixels; they produce
+ the same values as the scalar reference. The rows of the images are split
+ in jobs of the job manager.
+*/
+namespace PreviewConversion
+{
+	enum Kernel
+	{
+		Kernel_Scalar,
+		Kernel_SSE2,
+		Kernel_AVX2,
+		Kernel_Best
+	};
+
+	/// Check if a kernel is supported by the CPU.
+	bool IsKernelSupported(Kernel kernel);
+
+	/// Retrieve the name of a kernel.
+	const char* GetKernelName(Kernel kernel);
+
+	/// Check if an engine format can be converted.
+	bool IsFormatSupported(int format);
+
+	/// Check if an engine format has a single channel.
+	bool IsLuminanceFormat(int format);
+
+	/// Convert an image of an engine format (tightly packed rows) to QRgb values.
+	/// dstStride is the distance between two destination rows, in pixels.
+	/// If opaque is set, the alpha of all the pixels is 255, otherwise the alpha
+	/// channel of the source is kept (255 for the formats without alpha).
+	/// jobCount is the number of row ranges converted in parallel (0 to pick it from the image size).
+	bool Convert(int format, const void* src, int width, int height, QRgb* dst, int dstStride, bool opaque,
+		Kernel kernel = Kernel_Best, int jobCount = 0);
+
+	/// Convert an editor preview to a RGB32 image.
+	bool ToImage(const SGraphOutputEditorPreview& preview, QImage& image);
+}
+
+#endif // USE_SUBSTANCE
+#endif // SUBSTANCE_PROCEDURALMATERIALEDITORPLUGIN_PREVIEWCONVERSION_H
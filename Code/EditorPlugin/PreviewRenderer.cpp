@@ -0,0 +1,212 @@
+/** @file PreviewRenderer.cpp
+	@brief Source File for the asynchronous renderer of the editor output previews
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+
+#include "PreviewRenderer.h"
+#include "GraphInstance.h"
+#include "GraphOutput.h"
+#include <Substance/framework/preset.h>
+
+#include <PreviewRenderer.moc>
+
+CPreviewRenderer::CPreviewRenderer()
+	: QObject()
+	, m_Callbacks(this)
+	, m_LastRunUID(0)
+	, m_Generation(0)
+{
+	m_Renderer.setRenderCallbacks(&m_Callbacks);
+}
+
+CPreviewRenderer::~CPreviewRenderer()
+{
+	m_Renderer.cancelAll();
+	m_Renderer.flush();
+	ReleaseCopies();
+}
+
+CPreviewRenderer::SGraphCopy& CPreviewRenderer::GetCopy(IGraphInstance* pGraph)
+{
+	auto it = m_Copies.find(pGraph->GetGraphInstanceID());
+	if (it != m_Copies.end())
+	{
+		return it->second;
+	}
+
+	// The copy uses the graph description of the material package:
+	auto graph = (GraphInstance*)pGraph;
+	SGraphCopy& copy = m_Copies[pGraph->GetGraphInstanceID()];
+	copy.material = pGraph->GetProceduralMaterial();
+	copy.material->AddRef();
+	copy.instance.reset(new SubstanceAir::GraphInstance(graph->getInstance()->mDesc));
+
+	for (auto output : graph->getInstance()->getOutputs())
+	{
+		if (output->isFormatOverridden())
+		{
+			copy.instance->findOutput(output->mDesc.mUid)->overrideFormat(output->getFormatOverride());
+		}
+	}
+
+	return copy;
+}
+
+void CPreviewRenderer::ReleaseCopies()
+{
+	for (auto& it : m_Copies)
+	{
+		it.second.results.clear();
+		it.second.instance.reset();
+		it.second.material->Release();
+	}
+	m_Copies.clear();
+}
+
+unsigned int CPreviewRenderer::Render(IGraphInstance* pGraph, int maxSize)
+{
+	auto graph = (GraphInstance*)pGraph;
+	SGraphCopy& copy = GetCopy(pGraph);
+	auto instance = copy.instance.get();
+
+	{
+		// The graph may be pushed by the renderers of the gem at the same time:
+		CryAutoCriticalSection graphLock(graph->getRenderLock());
+
+		// Copy the input values, the enabled outputs, and the outputs to recompute:
+		SubstanceAir::Preset preset;
+		preset.fill(*graph->getInstance());
+		preset.apply(*instance);
+
+		for (auto output : graph->getInstance()->getOutputs())
+		{
+			SubstanceAir::OutputInstance* copied = instance->findOutput(output->mDesc.mUid);
+			copied->mEnabled = output->mEnabled;
+			if (output->isDirty())
+			{
+				copied->flagAsDirty();
+			}
+		}
+	}
+
+	bool dirty = false;
+	for (auto output : instance->getOutputs())
+	{
+		dirty = dirty || (output->mEnabled && output->isDirty());
+	}
+	if (!dirty)
+	{
+		return 0;
+	}
+
+	// Compute the reduced size from the log2 output size of the graph:
+	int shift = 0;
+	Vec2i size(0, 0);
+	if (maxSize > 0)
+	{
+		IGraphInput* pSizeInput = pGraph->GetInputByName("$outputsize");
+		if (pSizeInput)
+		{
+			size = pSizeInput->GetValue();
+		}
+		shift = std::max(0, std::max(size.x, size.y) - (int)IntegerLog2((uint32)maxSize));
+	}
+
+	if (shift == 0)
+	{
+		m_Renderer.push(*instance);
+	}
+	else
+	{
+		// Override the size of the outputs while the job is pushed, keeping their other format settings.
+		// Only the outputs to recompute are resized, as a format override flags the output as dirty:
+		struct SResizedOutput
+		{
+			SubstanceAir::OutputInstance* output;
+			bool overridden;
+			SubstanceAir::OutputFormat format;
+		};
+		std::vector<SResizedOutput> resized;
+		for (auto output : instance->getOutputs())
+		{
+			if (!output->mEnabled || !output->isDirty())
+			{
+				continue;
+			}
+			resized.push_back({ output, output->isFormatOverridden(), output->getFormatOverride() });
+
+			SubstanceAir::OutputFormat format = output->getFormatOverride();
+			format.forceWidth = 1u << std::max(0, size.x - shift);
+			format.forceHeight = 1u << std::max(0, size.y - shift);
+			output->overrideFormat(format);
+		}
+
+		m_Renderer.push(*instance);
+
+		// Restore the formats, this flags the resized outputs as dirty for the full resolution render:
+		for (const auto& previous : resized)
+		{
+			previous.output->overrideFormat(previous.overridden ? previous.format : SubstanceAir::OutputFormat());
+		}
+	}
+
+	// Discard the outputs of the previous runs which are deprecated by this one:
+	m_LastRunUID = m_Renderer.run(SubstanceAir::Renderer::Run_Asynchronous | SubstanceAir::Renderer::Run_Replace, 1);
+	logDEBUG("Preview: render job UID = "<<m_LastRunUID);
+	return m_LastRunUID;
+}
+
+void CPreviewRenderer::Cancel()
+{
+	m_Renderer.cancelAll();
+	m_Renderer.flush();
+	CryInterlockedIncrement(&m_Generation);
+
+	// The materials of the graphs may be released after this call:
+	ReleaseCopies();
+	m_LastRunUID = 0;
+}
+
+bool CPreviewRenderer::GetPreview(IGraphOutput* pOutput, SGraphOutputEditorPreview& preview)
+{
+	auto it = m_Copies.find(pOutput->GetGraphInstance()->GetGraphInstanceID());
+	if (it == m_Copies.end())
+	{
+		return false;
+	}
+
+	// Keep the latest result alive while the preview references its buffer:
+	auto& result = it->second.results[pOutput->GetGraphOutputID()];
+	auto output = it->second.instance->findOutput(pOutput->GetGraphOutputID());
+	for (auto grabbed = output->grabResult(); grabbed; grabbed = output->grabResult())
+	{
+		result = std::move(grabbed);
+	}
+	if (!result)
+	{
+		return false;
+	}
+
+	((GraphOutput*)pOutput)->FillEditorPreview(*result, preview);
+	return true;
+}
+
+bool CPreviewRenderer::IsPending() const
+{
+	return m_LastRunUID != 0 && m_Renderer.isPending(m_LastRunUID);
+}
+
+void CPreviewRenderer::CCallbacks::outputComputed(SubstanceAir::UInt runUid, size_t userData,
+	const SubstanceAir::GraphInstance* graphInstance,
+	SubstanceAir::OutputInstance* outputInstance)
+{
+	// Called on the render thread, the result stays in the output instance until grabbed:
+	Q_EMIT m_Parent->outputComputed(m_Parent->m_Generation, outputInstance->mDesc.mUid);
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,103 @@
+/** @file PreviewRenderer.h
+	@brief Header for the asynchronous renderer of the editor output previews
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef SUBSTANCE_PROCEDURALMATERIALEDITORPLUGIN_PREVIEWRENDERER_H
+#define SUBSTANCE_PROCEDURALMATERIALEDITORPLUGIN_PREVIEWRENDERER_H
+#pragma once
+
+#if defined(USE_SUBSTANCE)
+
+#include <QObject>
+
+#include "Substance/IProceduralMaterial.h"
+#include <Substance/framework/callbacks.h>
+#include <Substance/framework/renderer.h>
+#include <map>
+#include <memory>
+
+/**
+ Long-lived renderer of the editor output previews.
+
+ The graphs are rendered on the renderer worker thread, and each new run
+ replaces the outputs still pending from the previous ones, so that only the
+ latest input values get rendered while a slider is dragged.
+ The computed outputs are notified with the outputComputed() signal, emitted
+ from the render thread: connect it with a queued connection.
+
+ The previews render a copy of each graph, with the input values of the graph
+ of the material, so that the previews and the textures of the level never
+ grab each other's results from the shared output instances.
+*/
+class CPreviewRenderer : public QObject
+{
+	Q_OBJECT
+
+public:
+	CPreviewRenderer();
+	~CPreviewRenderer();
+
+	/// Queue the rendering of the outputs of a graph which are dirty, or which were left dirty by a
+	/// reduced resolution render, returns the run UID (0 if there is nothing to render).
+	/// If maxSize is not zero, the outputs larger than maxSize are rendered at a
+	/// reduced resolution keeping their aspect ratio (progressive previews).
+	unsigned int Render(IGraphInstance* pGraph, int maxSize = 0);
+
+	/// Cancel all the pending renders and wait for the render thread to be idle, then release the graph copies.
+	/// The notifications already queued are tagged with a previous generation.
+	void Cancel();
+
+	/// Retrieve the latest preview of an output, which stays valid until the next call for this output.
+	bool GetPreview(IGraphOutput* pOutput, SGraphOutputEditorPreview& preview);
+
+	/// Check if some renders are still pending.
+	bool IsPending() const;
+
+	/// Retrieve the generation of the renders, incremented at each Cancel().
+	inline unsigned int GetGeneration() const { return m_Generation; }
+
+signals:
+	void outputComputed(unsigned int generation, unsigned int graphOutputID);
+
+private:
+	class CCallbacks : public SubstanceAir::RenderCallbacks
+	{
+	public:
+		CCallbacks(CPreviewRenderer* pParent) : m_Parent(pParent) {}
+
+		using SubstanceAir::RenderCallbacks::outputComputed;
+
+		virtual void outputComputed(SubstanceAir::UInt runUid, size_t userData,
+			const SubstanceAir::GraphInstance* graphInstance,
+			SubstanceAir::OutputInstance* outputInstance) override;
+
+	private:
+		CPreviewRenderer* m_Parent;
+	};
+
+	// Copy of a graph rendered for the previews:
+	struct SGraphCopy
+	{
+		IProceduralMaterial* material;		// Referenced while the copy lives
+		std::unique_ptr<SubstanceAir::GraphInstance> instance;
+		std::map<unsigned int, std::unique_ptr<SubstanceAir::RenderResult>> results;	// Latest result of each output
+	};
+
+	// Retrieve the copy of a graph, creating it if needed:
+	SGraphCopy& GetCopy(IGraphInstance* pGraph);
+
+	// Release the graph copies, once the renderer is idle:
+	void ReleaseCopies();
+
+	// The callbacks must outlive the renderer:
+	CCallbacks									m_Callbacks;
+	SubstanceAir::Renderer						m_Renderer;
+	unsigned int								m_LastRunUID;
+	volatile int								m_Generation;
+	std::map<GraphInstanceID, SGraphCopy>		m_Copies;
+};
+
+#endif // USE_SUBSTANCE
+#endif // SUBSTANCE_PROCEDURALMATERIALEDITORPLUGIN_PREVIEWRENDERER_H
@@ -21,6 +21,8 @@
 
 #include "QProceduralMaterialEditorMainWindow.h"
 #include "OutputPreviewWidget.h"
+#include "PreviewConversion.h"
+#include "PreviewRenderer.h"
 #include <CryExtension/CryCreateClassInstance.h>
 #include "ProceduralMaterialScanner.h"
 #include "GraphInputWidgets.h"
@@ -40,7 +42,6 @@ struct IRenderMesh;
 #include "BaseLibrary.h"
 #include "Material/MaterialManager.h"
 #include "GraphInstance.h"
-#include <Substance/framework/renderer.h>
 
 static void QAlertMessageBox(const QString& caption, const QString& text)
 {
@@ -58,13 +59,19 @@ const int QProceduralMaterialEditorMainWindow::FILENAME_ROLE = Qt::UserRole + 2;
 
 const char* QProceduralMaterialEditorMainWindow::PROPERTY_INPUT = "_smtlInput";
 
+//size of the previews rendered while the inputs are edited, and delay before the full size render
+const int QProceduralMaterialEditorMainWindow::PROGRESSIVE_PREVIEW_SIZE = 256;
+const int QProceduralMaterialEditorMainWindow::PROGRESSIVE_PREVIEW_DELAY = 400;
+
 //--------------------------------------------------------------------------------------------
 QProceduralMaterialEditorMainWindow::QProceduralMaterialEditorMainWindow(QWidget* parent)
     : QMainWindow(parent)
     , Ui::QProceduralMaterialEditorMainWindow()
     , m_CurrentMaterial(nullptr)
     , m_QueueRenderGraph(nullptr)
+    , m_RefineRenderGraph(nullptr)
     , m_RenderUID(INVALID_PROCEDURALMATERIALRENDERUID)
+    , m_PreviewRenderer(new CPreviewRenderer)
 {
     setupUi(this);
 
@@ -75,6 +82,15 @@ QProceduralMaterialEditorMainWindow::QProceduralMaterialEditorMainWindow(QWidget
     m_PreviewWidget = new QWidget;
     scrollPreview->setWidget(m_PreviewWidget);
 
+    //the preview outputs are computed on the render thread
+    connect(m_PreviewRenderer, &CPreviewRenderer::outputComputed, this, &QProceduralMaterialEditorMainWindow::OnPreviewOutputComputed, Qt::QueuedConnection);
+
+    //full size previews are rendered once the inputs stop changing
+    m_RefineTimer = new QTimer(this);
+    m_RefineTimer->setSingleShot(true);
+    m_RefineTimer->setInterval(PROGRESSIVE_PREVIEW_DELAY);
+    connect(m_RefineTimer, &QTimer::timeout, this, &QProceduralMaterialEditorMainWindow::OnRefineTimerTimeout);
+
     //menu items
     connect(action_Import_Substance, &QAction::triggered, this, &QProceduralMaterialEditorMainWindow::OnFileImportSubstanceTriggered);
     connect(action_Export_Textures, &QAction::triggered, this, &QProceduralMaterialEditorMainWindow::OnFileExportTexturesTriggered);
@@ -140,6 +156,16 @@ QProceduralMaterialEditorMainWindow::~QProceduralMaterialEditorMainWindow()
 
     GetIEditor()->UnregisterNotifyListener(this);
 
+    //stop rendering before releasing the graphs
+    m_PreviewRenderer->Cancel();
+    delete m_PreviewRenderer;
+
+    if (m_CurrentMaterial)
+    {
+        m_CurrentMaterial->Release();
+        m_CurrentMaterial = nullptr;
+    }
+
     delete m_StandardModel;
     delete m_StatusBarLabel;
 }
@@ -227,41 +253,15 @@ void QProceduralMaterialEditorMainWindow::OnEditorNotifyEvent(EEditorNotifyEvent
             //if an input change is pending, just update editor preview
             if (m_QueueRenderGraph)
             {
-                std::vector<IGraphOutput*>  disabledOutputs;
-
-                //mark all outputs as enabled for preview purposes
-                for (int o = 0; o < m_QueueRenderGraph->GetOutputCount(); o++)
-                {
-                    IGraphOutput* pOutput = m_QueueRenderGraph->GetOutput(o);
-                    if (!pOutput->IsEnabled())
-                    {
-                        pOutput->SetEnabled(true);
-                        disabledOutputs.push_back(pOutput);
-                    }
-                }
-
-                // Here we should request the rendering of our previews:
-                logDEBUG("Rendering outputs for preview...");
-                m_StatusBarProgress->setMaximum(0);
-                SubstanceAir::Renderer renderer;
-                auto graph = (GraphInstance*)m_QueueRenderGraph;
-                renderer.push(*(graph->getInstance()));
+                //render low resolution previews first, then refine them when idle
+                RenderPreviews(m_QueueRenderGraph, PROGRESSIVE_PREVIEW_SIZE);
 
-                unsigned int res = renderer.run();
-                logDEBUG("Preview: render job UID = "<<res);
-                
-                // We should now update the output previews:
-                UpdateOutputPreviews();
+                m_RefineRenderGraph = m_QueueRenderGraph;
+                m_RefineTimer->start();
 
                 m_QueueRenderGraph = nullptr;
-
-                //restore output settings
-                for (auto iter = disabledOutputs.begin(); iter != disabledOutputs.end(); iter++)
-                {
-                    (*iter)->SetEnabled(false);
-                }
             }
-            else
+            else if (!m_PreviewRenderer->IsPending())
             {
                 m_StatusBarProgress->setMaximum(1);
             }
@@ -311,6 +311,7 @@ void QProceduralMaterialEditorMainWindow::OnFileImportSubstanceTriggered()
                 DisplayProceduralMaterial(m_CurrentMaterial->GetPath());
             }
 
+            pMaterial->Release();
             return;
         }
 
@@ -344,8 +345,8 @@ void QProceduralMaterialEditorMainWindow::CreateMaterialFromPath(const char* pat
     if (pMaterial)
     {
         CreateMaterial(pMaterial);
-        // Delete the material interface:
-        delete pMaterial;
+        // Release the material interface:
+        pMaterial->Release();
     }
     else
     {
@@ -457,7 +458,7 @@ void QProceduralMaterialEditorMainWindow::OnFileExportTexturesTriggered()
                     continue;
                 }
 
-                if (!pOutput->GetEditorPreview(editorPreview))
+                if (!m_PreviewRenderer->GetPreview(pOutput, editorPreview))
                 {
                     QAlertMessageBox(tr("Unable to save file"), tr("Unable to read editor preview"));
                     continue;
@@ -478,6 +479,18 @@ void QProceduralMaterialEditorMainWindow::OnFileExportTexturesTriggered()
                     filename = pGraph->GetName() + string("_") + filename;
                 }
 
+                //convert to 8 bits luminance or BGRA pixels, which is the memory layout of QRgb
+                const int width = editorPreview.Width;
+                const int height = editorPreview.Height;
+                const bool bLuminance = PreviewConversion::IsLuminanceFormat(editorPreview.Format);
+
+                std::vector<QRgb> pixels((size_t)width * height);
+                if (!PreviewConversion::Convert(editorPreview.Format, editorPreview.Data, width, height, pixels.data(), width, false))
+                {
+                    QAlertMessageBox(tr("Unable to save file"), tr("Unsupported output format"));
+                    continue;
+                }
+
                 //create full file path
                 string fullPath = PathUtil::AddSlash(saveName) + materialName + string("_") + filename;
 
@@ -495,24 +508,33 @@ void QProceduralMaterialEditorMainWindow::OnFileExportTexturesTriggered()
                 static const int kTGA_RGB = 2;
                 static const int kTGA_L = 3;
 
-                const int width = editorPreview.Width;
-                const int height = editorPreview.Height;
-
                 memset(tgaHeader, 0, sizeof(tgaHeader));
-                tgaHeader[2] = (editorPreview.BytesPerPixel == 1) ? kTGA_L : kTGA_RGB;
+                tgaHeader[2] = bLuminance ? kTGA_L : kTGA_RGB;
                 tgaHeader[12] = width & 0x00FF;
                 tgaHeader[13] = (width & 0xFF00) / 256;
                 tgaHeader[14] = height & 0x0FF;
                 tgaHeader[15] = (height & 0xFF00) / 256;
-                tgaHeader[16] = editorPreview.BytesPerPixel * 8;
+                tgaHeader[16] = bLuminance ? 8 : 32;
+                tgaHeader[17] = bLuminance ? 0 : 8; //alpha bits
 
                 outFile.Write(tgaHeader, sizeof(tgaHeader));
 
+                std::vector<byte> luminance(bLuminance ? width : 0);
                 for (int y = height - 1; y >= 0; y--)
                 {
-                    int stride = width * editorPreview.BytesPerPixel;
-                    int offset = stride * y;
-                    outFile.Write(static_cast<byte*>(editorPreview.Data) + offset, stride);
+                    const QRgb* pRow = &pixels[(size_t)y * width];
+                    if (bLuminance)
+                    {
+                        for (int x = 0; x < width; x++)
+                        {
+                            luminance[x] = (byte)qBlue(pRow[x]);
+                        }
+                        outFile.Write(luminance.data(), width);
+                    }
+                    else
+                    {
+                        outFile.Write(pRow, width * sizeof(QRgb));
+                    }
                 }
 
                 outFile.Flush();
@@ -905,7 +927,11 @@ void QProceduralMaterialEditorMainWindow::AddGraphInputWidgets(IGraphInput* inpu
 
 void QProceduralMaterialEditorMainWindow::DisplayProceduralMaterial(const char* path)
 {
+    // The previous material is only released once the new one is retrieved, so that
+    // displaying it again reuses the shared instance (path may also point into it):
+    IProceduralMaterial* pPreviousMaterial = m_CurrentMaterial;
     m_CurrentMaterial = nullptr;
+    m_QueueRenderGraph = nullptr;
     m_GraphInputHandlerMap.clear();
 
     CreateOutputPreviews(0);
@@ -933,6 +959,13 @@ void QProceduralMaterialEditorMainWindow::DisplayProceduralMaterial(const char*
 
         m_StatusBarLabel->setText(tr("No Substance Selected"));
 
+        if (pPreviousMaterial)
+        {
+            m_PreviewRenderer->Cancel();
+            m_RefineRenderGraph = nullptr;
+            pPreviousMaterial->Release();
+        }
+
         return;
     }
 
@@ -943,7 +976,7 @@ void QProceduralMaterialEditorMainWindow::DisplayProceduralMaterial(const char*
     }
 
     IProceduralMaterial* pMaterial = nullptr;
-    EBUS_EVENT_RESULT(pMaterial, SubstanceRequestBus, GetMaterialFromPath, path, true);
+    EBUS_EVENT_RESULT(pMaterial, SubstanceRequestBus, GetMaterialFromPath, path, false);
     if (pMaterial)
     {
         m_StatusBarLabel->setText(QString(path));
@@ -1037,17 +1070,91 @@ void QProceduralMaterialEditorMainWindow::DisplayProceduralMaterial(const char*
 
         m_StatusBarLabel->setText(tr("Failed to load Substance"));
     }
+
+    if (pPreviousMaterial)
+    {
+        //drop the previews still rendering for the previous material
+        m_PreviewRenderer->Cancel();
+        m_RefineRenderGraph = nullptr;
+        pPreviousMaterial->Release();
+    }
 }
 
-void QProceduralMaterialEditorMainWindow::UpdateOutputPreviews()
+void QProceduralMaterialEditorMainWindow::UpdateOutputPreviews(GraphOutputID graphOutputID)
 {
-    //update preview widgets
+    //update preview widgets, or only the one of the given output
     for (auto iter = m_OutputPreviewWidgets.begin(); iter != m_OutputPreviewWidgets.end(); iter++)
     {
-        (*iter)->OnOutputChanged();
+        //the previews are rendered from a copy of the graph, see CPreviewRenderer
+        SGraphOutputEditorPreview preview;
+        if ((graphOutputID == INVALID_GRAPHOUTPUTID || (*iter)->GetOutput()->GetGraphOutputID() == graphOutputID)
+            && m_PreviewRenderer->GetPreview((*iter)->GetOutput(), preview))
+        {
+            (*iter)->OnOutputChanged(preview);
+        }
+    }
+}
+
+void QProceduralMaterialEditorMainWindow::RenderPreviews(IGraphInstance* pGraph, int maxSize)
+{
+    std::vector<IGraphOutput*>  disabledOutputs;
+
+    //mark all outputs as enabled for preview purposes
+    for (int o = 0; o < pGraph->GetOutputCount(); o++)
+    {
+        IGraphOutput* pOutput = pGraph->GetOutput(o);
+        if (!pOutput->IsEnabled())
+        {
+            pOutput->SetEnabled(true);
+            disabledOutputs.push_back(pOutput);
+        }
+    }
+
+    // Request the rendering of our previews, they are updated as the outputs get computed.
+    // Only the outputs altered by the changed inputs, or left at a reduced resolution, are recomputed:
+    logDEBUG("Rendering "<<pGraph->GetDirtyOutputs(nullptr, 0)<<" dirty outputs for preview (max size: "<<maxSize<<")...");
+    if (m_PreviewRenderer->Render(pGraph, maxSize) != 0)
+    {
+        m_StatusBarProgress->setMaximum(0);
+    }
+
+    //restore output settings
+    for (auto iter = disabledOutputs.begin(); iter != disabledOutputs.end(); iter++)
+    {
+        (*iter)->SetEnabled(false);
     }
 }
 
+void QProceduralMaterialEditorMainWindow::OnRefineTimerTimeout()
+{
+    if (!m_RefineRenderGraph)
+    {
+        return;
+    }
+
+    //wait for the pending input changes and texture exports
+    if (m_QueueRenderGraph || m_RenderUID != INVALID_PROCEDURALMATERIALRENDERUID)
+    {
+        m_RefineTimer->start();
+        return;
+    }
+
+    //the low resolution render left the outputs it recomputed dirty
+    RenderPreviews(m_RefineRenderGraph, 0);
+    m_RefineRenderGraph = nullptr;
+}
+
+void QProceduralMaterialEditorMainWindow::OnPreviewOutputComputed(unsigned int generation, unsigned int graphOutputID)
+{
+    //ignore the outputs notified before the previews were cancelled
+    if (generation != m_PreviewRenderer->GetGeneration())
+    {
+        return;
+    }
+
+    UpdateOutputPreviews(graphOutputID);
+}
+
 void QProceduralMaterialEditorMainWindow::RefreshTreeView()
 {
     TFileVector files;
@@ -34,6 +34,7 @@ struct IGraphInstance;
 
 class GIGraphInputHandler;
 class QOutputPreviewWidget;
+class CPreviewRenderer;
 
 /*
 */
@@ -77,6 +78,8 @@ protected://signals
 	void OnEditReimportSubstance();
 	void OnTabPropertiesCurrentChanged(int index);
 	void OnTreeViewSelectionChanged(const QItemSelection& selected, const QItemSelection& deselected);
+	void OnPreviewOutputComputed(unsigned int generation, unsigned int graphOutputID);
+	void OnRefineTimerTimeout();
 
 private:
 	void AddSingleLabel(QWidget* widget, const QString& text);
@@ -85,7 +88,8 @@ private:
 	void CreateMaterialFromPath(const char* path);
 	void CreateOutputPreviews(int graphIndex);
 	void DisplayProceduralMaterial(const char* path);
-	void UpdateOutputPreviews();
+	void RenderPreviews(IGraphInstance* pGraph, int maxSize);
+	void UpdateOutputPreviews(GraphOutputID graphOutputID = INVALID_GRAPHOUTPUTID);
 	void RefreshTreeView();
 	const char* TranslateInputName(const char* name) const;
 	QStandardItem* FindMaterialItem(const string& path) const;
@@ -97,6 +101,9 @@ private:
 
 	static const char* PROPERTY_INPUT;
 
+	static const int PROGRESSIVE_PREVIEW_SIZE;
+	static const int PROGRESSIVE_PREVIEW_DELAY;
+
 private:
 	QStandardItemModel*										m_StandardModel;
 	QLabel*													m_StatusBarLabel;
@@ -107,7 +114,10 @@ private:
 
 	IProceduralMaterial*									m_CurrentMaterial;
 	IGraphInstance*											m_QueueRenderGraph;
+	IGraphInstance*											m_RefineRenderGraph;
+	QTimer*													m_RefineTimer;
 	ProceduralMaterialRenderUID								m_RenderUID;
+	CPreviewRenderer*										m_PreviewRenderer;
 	std::map<GraphInputID, GIGraphInputHandler*>			m_GraphInputHandlerMap;
 	std::map<IProceduralMaterial*, int>						m_MaterialModifiedCountMap;
 	std::vector<QOutputPreviewWidget*>						m_OutputPreviewWidgets;
@@ -0,0 +1,219 @@
+/** @file PreviewConversionBenchmark.cpp
+	@brief Benchmark of the preview conversion kernels
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include <AzTest/AzTest.h>
+#include "PreviewConversion.h"
+#include <AzCore/Jobs/JobContext.h>
+#include <AzCore/Jobs/JobManager.h>
+#include <AzCore/Memory/PoolAllocator.h>
+#include <AzCore/Memory/SystemAllocator.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace PreviewConversion;
+
+class PreviewConversionBenchmark
+    : public ::testing::Test
+{
+protected:
+    static const int kSize = 4096;
+
+    void SetUp() override
+    {
+        // The rows are converted on the jobs of a job manager with a worker per core:
+        m_OwnsAllocators = !AZ::AllocatorInstance<AZ::SystemAllocator>::IsReady();
+        if (m_OwnsAllocators)
+        {
+            AZ::AllocatorInstance<AZ::SystemAllocator>::Create();
+            AZ::AllocatorInstance<AZ::PoolAllocator>::Create();
+            AZ::AllocatorInstance<AZ::ThreadPoolAllocator>::Create();
+        }
+        AZ::JobManagerDesc desc;
+        AZ::JobManagerThreadDesc threadDesc;
+        for (unsigned int i = 0; i < std::max(std::thread::hardware_concurrency(), 1u); i++)
+        {
+            desc.m_workerThreads.push_back(threadDesc);
+        }
+        m_JobManager = aznew AZ::JobManager(desc);
+        m_JobContext = aznew AZ::JobContext(*m_JobManager);
+        AZ::JobContext::SetGlobalContext(m_JobContext);
+    }
+
+    void TearDown() override
+    {
+        AZ::JobContext::SetGlobalContext(nullptr);
+        delete m_JobContext;
+        delete m_JobManager;
+        if (m_OwnsAllocators)
+        {
+            AZ::AllocatorInstance<AZ::ThreadPoolAllocator>::Destroy();
+            AZ::AllocatorInstance<AZ::PoolAllocator>::Destroy();
+            AZ::AllocatorInstance<AZ::SystemAllocator>::Destroy();
+        }
+    }
+
+    // Fill an image with random values of the given format:
+    void Generate(int format, int bytesPerPixel, std::vector<uint8_t>& image)
+    {
+        image.resize((size_t)kSize*kSize*bytesPerPixel);
+        unsigned int seed = 1;
+        auto random = [&seed]() {
+            seed = seed*1103515245u + 12345u;
+            return seed >> 8;
+        };
+
+        if (format == eTF_R32F || format == eTF_R32G32B32A32F)
+        {
+            // Mostly in [0,1], with some values out of range:
+            float* values = (float*)image.data();
+            for (size_t i = 0; i < image.size()/4; i++)
+            {
+                values[i] = (random() % 12000)/10000.0f - 0.1f;
+            }
+        }
+        else
+        {
+            // Any bit pattern, including the half infinities and NaN:
+            for (size_t i = 0; i < image.size(); i++)
+            {
+                image[i] = (uint8_t)random();
+            }
+        }
+    }
+
+    // Convert an image and return the throughput in MPix/s:
+    double Run(int format, const std::vector<uint8_t>& image, std::vector<QRgb>& out, bool opaque, Kernel kernel, int jobCount)
+    {
+        out.resize((size_t)kSize*kSize);
+        auto start = std::chrono::high_resolution_clock::now();
+        EXPECT_TRUE(Convert(format, image.data(), kSize, kSize, out.data(), kSize, opaque, kernel, jobCount));
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        return kSize*kSize/(seconds*1e6);
+    }
+
+    void RunBenchmark(int format, int bytesPerPixel, const char* name)
+    {
+        std::vector<uint8_t> image;
+        Generate(format, bytesPerPixel, image);
+
+        for (bool opaque : { true, false })
+        {
+            std::vector<QRgb> reference;
+            double scalar = Run(format, image, reference, opaque, Kernel_Scalar, 1);
+            if (opaque)
+            {
+                printf("[%s] %-6s: %8.2f MPix/s per core\n", name, GetKernelName(Kernel_Scalar), scalar);
+            }
+
+            // The SIMD kernels must produce the same pixels as the scalar reference:
+            for (Kernel kernel : { Kernel_SSE2, Kernel_AVX2 })
+            {
+                if (!IsKernelSupported(kernel))
+                {
+                    continue;
+                }
+
+                std::vector<QRgb> out;
+                double rate = Run(format, image, out, opaque, kernel, 1);
+                if (opaque)
+                {
+                    printf("[%s] %-6s: %8.2f MPix/s per core (x%.2f)\n", name, GetKernelName(kernel), rate, rate/scalar);
+                }
+                EXPECT_TRUE(out == reference);
+            }
+
+            if (opaque)
+            {
+                int cores = (int)std::max(std::thread::hardware_concurrency(), 1u);
+                std::vector<QRgb> out;
+                double rate = Run(format, image, out, opaque, Kernel_Best, cores);
+                printf("[%s] %d jobs: %8.2f MPix/s\n", name, cores, rate);
+                EXPECT_TRUE(out == reference);
+            }
+        }
+    }
+
+    AZ::JobManager* m_JobManager;
+    AZ::JobContext* m_JobContext;
+    bool m_OwnsAllocators;
+};
+
+TEST_F(PreviewConversionBenchmark, R16)
+{
+    RunBenchmark(eTF_R16, 2, "R16");
+}
+
+TEST_F(PreviewConversionBenchmark, RGBA16)
+{
+    RunBenchmark(eTF_R16G16B16A16, 8, "RGBA16");
+}
+
+TEST_F(PreviewConversionBenchmark, RGBA8)
+{
+    RunBenchmark(eTF_R8G8B8A8, 4, "RGBA8");
+}
+
+TEST_F(PreviewConversionBenchmark, L8)
+{
+    RunBenchmark(eTF_L8, 1, "L8");
+}
+
+TEST_F(PreviewConversionBenchmark, R16F)
+{
+    RunBenchmark(eTF_R16F, 2, "R16F");
+}
+
+TEST_F(PreviewConversionBenchmark, RGBA16F)
+{
+    RunBenchmark(eTF_R16G16B16A16F, 8, "RGBA16F");
+}
+
+TEST_F(PreviewConversionBenchmark, R32F)
+{
+    RunBenchmark(eTF_R32F, 4, "R32F");
+}
+
+TEST_F(PreviewConversionBenchmark, RGBA32F)
+{
+    RunBenchmark(eTF_R32G32B32A32F, 16, "RGBA32F");
+}
+
+TEST_F(PreviewConversionBenchmark, Values)
+{
+    // 16 bits values are rounded to the nearest 8 bits value:
+    std::vector<uint16_t> values(65536);
+    for (int v = 0; v < 65536; v++)
+    {
+        values[v] = (uint16_t)v;
+    }
+
+    std::vector<QRgb> out(65536);
+    ASSERT_TRUE(Convert(eTF_R16, values.data(), 65536, 1, out.data(), 65536, true));
+    for (int v = 0; v < 65536; v++)
+    {
+        ASSERT_EQ(out[v], 0xFF000000u | 0x010101u*((v*255 + 32767)/65535));
+    }
+
+    // Channels order and alpha:
+    const uint8_t rgba[4] = { 0x11, 0x22, 0x33, 0x44 };
+    QRgb pixel = 0;
+    ASSERT_TRUE(Convert(eTF_R8G8B8A8, rgba, 1, 1, &pixel, 1, false));
+    EXPECT_EQ(pixel, 0x44112233u);
+    ASSERT_TRUE(Convert(eTF_R8G8B8A8, rgba, 1, 1, &pixel, 1, true));
+    EXPECT_EQ(pixel, 0xFF112233u);
+
+    // Half values (1.0, 0.5, -2.0, +inf):
+    const uint16_t halves[4] = { 0x3C00, 0x3800, 0xC000, 0x7C00 };
+    ASSERT_TRUE(Convert(eTF_R16G16B16A16F, halves, 1, 1, &pixel, 1, false));
+    EXPECT_EQ(pixel, 0xFFFF8000u);
+
+    EXPECT_FALSE(Convert(eTF_Unknown, rgba, 1, 1, &pixel, 1, true));
+}
@@ -10,6 +10,7 @@
 
 #include "Substance/IProceduralMaterial.h"
 #include "Substance/framework/package.h"
+#include <CryThread.h>
 
 #if defined(USE_SUBSTANCE)
 
@@ -55,12 +56,38 @@ public:
 	/// Get an output object by ID
 	virtual IGraphOutput* GetOutputByID(GraphOutputID outputID);
 
+	/// Get the outputs recomputed by the next render of this graph.
+	virtual int GetDirtyOutputs(IGraphOutput** ppOutputs, int maxCount);
+
 	//! Retrieve the substance graph instance:
 	inline SubstanceAir::GraphInstance* getInstance() const { return _instance; }
 
+	//! Retrieve the index of this graph in the parent package:
+	inline unsigned int getGraphIndex() const { return _index; }
+
+	//! Retrieve the parent material:
+	inline SubstanceMaterial* getMaterial() const { return _parent; }
+
 	//! Retrieve a default input value:
 	bool getDefaultInputValue(unsigned int id, GraphValueVariant& val);
 
+	//! Check if an input is marked as static in the material:
+	bool isStaticInput(unsigned int id) const;
+
+	//! Flag as dirty the outputs altered by an input, once its value changed:
+	void flagAlteredOutputs(GraphInputID inputID);
+
+	//! Check if an output is altered by an input, directly or through the outputs it is composed of:
+	bool isAlteredBy(const SubstanceAir::OutputInstance* output, GraphInputID inputID) const;
+
+	//! Retrieve the lock held while this graph is pushed and run on a renderer.
+	//! The pushes read and reset the states of the graph; a synchronous run is rendered under the lock,
+	//! an asynchronous one is computed after it is released:
+	inline CryCriticalSection& getRenderLock() { return _renderLock; }
+
+	//! Add the gem objects of this graph to a sizer:
+	void GetMemoryUsage(ICrySizer* s) const;
+
 protected:
 	// Pointer on the parent material:
 	SubstanceMaterial* _parent;
@@ -78,6 +105,9 @@ protected:
 	// List of graph inputs:
 	typedef std::vector<GraphInput*> GraphInputList;
 	GraphInputList _inputs;
+
+	// Lock on the push/run calls of this graph:
+	CryCriticalSection _renderLock;
 };
 
 #endif // USE_SUBSTANCE
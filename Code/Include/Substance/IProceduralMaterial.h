@@ -70,6 +70,12 @@ struct IProceduralMaterial
 
 	/// Reimport Substance SBSAR from Disk
 	virtual void ReimportSubstance() = 0;
+
+	/// Add a reference on this material.
+	virtual void AddRef() = 0;
+
+	/// Release a reference on this material, materials retrieved from the SubstanceRequestBus must be released when not needed anymore.
+	virtual void Release() = 0;
 };
 
 /**/
@@ -106,6 +112,10 @@ struct IGraphInstance
 
 	/// Get an output object by ID
 	virtual IGraphOutput* GetOutputByID(GraphOutputID outputID) = 0;
+
+	/// Get the outputs recomputed by the next render of this graph (the dirty and enabled ones).
+	/// Fills up to maxCount outputs and returns their total number.
+	virtual int GetDirtyOutputs(IGraphOutput** ppOutputs, int maxCount) = 0;
 };
 
 /**/
@@ -136,6 +146,16 @@ enum class GraphInputWidgetType
 	Image
 };
 
+/** Priority classes of the queued renders, from the most to the least urgent. */
+enum class ProceduralMaterialRenderPriority
+{
+	Visible,		///< On screen now, rendered ahead of all the queued work
+	Streaming,		///< Being streamed in
+	Background,		///< Precomputed ahead of use, rendered after the other classes
+	EditorPreview,	///< Editor previews, the outdated renders are discarded
+	Count
+};
+
 /**/
 struct GraphValueVariant
 {
@@ -232,7 +252,8 @@ struct IGraphInput
 	/// Retrieve the value of this input.
 	virtual GraphValueVariant GetValue() const = 0;
 
-	/// Assign a new value to this input. You must call QueueRender/Render(A)Sync to update the output textures.
+	/// Assign a new value to this input, flagging as dirty the outputs it alters if the value changes.
+	/// You must call QueueRender/Render(A)Sync to update the output textures.
 	virtual void SetValue(const GraphValueVariant& value) = 0;
 
 	/// Get the minimum value for this input.
@@ -21,8 +21,33 @@
 
 #if defined(USE_SUBSTANCE)
 #include "IProceduralMaterial.h"
+#include <AzCore/std/containers/vector.h>
 
 struct ISubstanceLibAPI;
+struct ICrySizer;
+
+/// Statistics of a completed render job, the delays are measured from the run call.
+struct SProceduralMaterialRenderJobStats
+{
+	AZStd::vector<GraphInstanceID>	GraphInstances;		///< Graph instances of the computed outputs
+	int								OutputCount;		///< Number of computed outputs
+	float							FirstOutputMs;		///< Delay before the first computed output
+	float							TotalMs;			///< Delay before the last computed output
+};
+
+/// Counters of the per-frame render budget, accumulated since the start of the game.
+struct SProceduralMaterialRenderBudgetStats
+{
+	unsigned int					Frames;				///< Number of frames
+	unsigned int					BusyFrames;			///< Frames during which the renderer was working
+	unsigned int					HeldFrames;			///< Frames during which the renderer was held to pay back an overrun
+	unsigned int					OverrunFrames;		///< Frames during which the renderer worked longer than the budget
+	unsigned int					DeferredRuns;		///< Synchronous renders deferred because too many jobs were in flight
+	unsigned int					PendingJobs;		///< Render jobs currently in flight
+	float							LastFrameMs;		///< Render time of the last frame
+	float							OverrunMs;			///< Total render time above the budget
+	float							MaxOverrunMs;		///< Largest render time above the budget in a frame
+};
 #endif // USE_SUBSTANCE
 
 
@@ -44,19 +69,40 @@ public:
 	virtual int GetMaximumOutputSize() const = 0;
 
 	/** Get a ProceduralMaterial object given a file path. 
+	  * Materials are shared: a reference is added on the returned material and the caller
+	  * must call Release() on it when done.
 	  * If bForceLoad is true, we will load the material from disk
 	  */
 	virtual IProceduralMaterial* GetMaterialFromPath(const char* path, bool bForceLoad) const = 0;
 
-	/// Queue a GraphInstance for rendering.
+	/// Retrieve a graph instance from its ID, or nullptr if its material is not loaded anymore.
+	virtual IGraphInstance* GetGraphInstance(GraphInstanceID graphInstanceID) const = 0;
+
+	/// Queue a GraphInstance for rendering, with the Streaming priority.
 	virtual void QueueRender(IGraphInstance* pGraphInstance) = 0;
 
-	/// Renders all queued graphs asynchronously. Returns a handle so you can query for completion.
+	/** Queue a GraphInstance for rendering with a priority class.
+	  * distance is the camera distance hint used to order the graphs of a class (closest first, < 0 if unknown).
+	  */
+	virtual void QueueRenderWithPriority(IGraphInstance* pGraphInstance, ProceduralMaterialRenderPriority priority, float distance) = 0;
+
+	/// Queue a GraphInstance for rendering, with the Visible priority within substance_visibleDistance and Background beyond.
+	virtual void QueueRenderAtDistance(IGraphInstance* pGraphInstance, float distance) = 0;
+
+	/// Renders all queued graphs asynchronously, one job per priority class.
+	/// Returns a handle so you can query for completion (the job which is rendered last).
 	virtual ProceduralMaterialRenderUID RenderASync() = 0;
 
 	/// Renders all queued graphs synchronously.
+	/// When substance_frameBudget is set, the render is run asynchronously within the frame budget instead.
 	virtual void RenderSync() = 0;
 
+	/// Check if the renders started with RenderSync/RenderASync under the frame budget are still pending.
+	virtual bool IsRenderPending() const = 0;
+
+	/// Retrieve the counters of the per-frame render budget.
+	virtual SProceduralMaterialRenderBudgetStats GetRenderBudgetStats() const = 0;
+
 	/// Given a substance archive and destination path, create the appropriate smtl/sub files.
 	virtual bool CreateProceduralMaterial(const char* basePath, const char* sbsarPath, const char* smtlPath) = 0;
 
@@ -68,8 +114,34 @@ public:
 
 	// Retrieve the Substance Library API
 	virtual ISubstanceLibAPI* GetSubstanceLibAPI() const = 0;
+
+	/// Add the memory used by the procedural materials, the packages and the substance allocations to a sizer.
+	virtual void GetMemoryUsage(ICrySizer* pSizer) const = 0;
 #endif // USE_SUBSTANCE
 };
 using SubstanceRequestBus = AZ::EBus<SubstanceRequests>;
 
+//----------------------------------------------------------------------------------------------------
+class SubstanceNotifications : public AZ::EBusTraits
+{
+public:
+	////////////////////////////////////////////////////////////////////////////
+	// EBusTraits
+	static const AZ::EBusHandlerPolicy HandlerPolicy = AZ::EBusHandlerPolicy::Multiple;
+	static const AZ::EBusAddressPolicy AddressPolicy = AZ::EBusAddressPolicy::Single;
+	////////////////////////////////////////////////////////////////////////////
+
+#if defined(USE_SUBSTANCE)
+	/** Called on the main thread when an output has been computed by a render job.
+	  * elapsedMs is the delay between the run call and the computation of the output.
+	  * The render result itself is grabbed by the caller of the render (or the texture loader).
+	  */
+	virtual void OnOutputComputed(ProceduralMaterialRenderUID renderUID, GraphInstanceID graphInstanceID, GraphOutputID graphOutputID, float elapsedMs) {}
+
+	/// Called on the main thread once a render job is not pending anymore (completed or cancelled).
+	virtual void OnRenderJobCompleted(ProceduralMaterialRenderUID renderUID, const SProceduralMaterialRenderJobStats& stats) {}
+#endif // USE_SUBSTANCE
+};
+using SubstanceNotificationBus = AZ::EBus<SubstanceNotifications>;
+
 #endif// GEM_46AED0DF_955D_4582_9583_0B4D2422A727_CODE_INCLUDE_SUBSTANCEBUS_H
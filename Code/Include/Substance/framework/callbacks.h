@@ -10,7 +10,7 @@
 
 #include "typedefs.h"
 
-#include <substance/engineid.h>
+#include <Substance/engineid.h>
 
 
 struct SubstanceDevice_;
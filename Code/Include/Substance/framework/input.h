@@ -9,7 +9,7 @@
 #include "inputimage.h"
 #include "channel.h"
 
-#include <substance/inputdesc.h>
+#include <Substance/inputdesc.h>
 
 
 
@@ -9,7 +9,7 @@
 #include "platform.h"
 #include "typedefs.h"
 
-#include <substance/pixelformat.h>
+#include <Substance/pixelformat.h>
 
 struct SubstanceTexture_;
 struct SubstanceTextureInput_;
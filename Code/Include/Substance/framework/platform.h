@@ -19,7 +19,7 @@
 
 #include "typedefs.h"
 
-#include <substance/engineid.h>
+#include <Substance/engineid.h>
 
 #include <assert.h>
 #include <memory.h>
@@ -98,8 +98,8 @@ struct IntToType { enum { Number = N }; };
 		#define SUBSTANCE_PLATFORM_BLEND
 	#endif
 
-	#include <substance/texture.h>
-	#include <substance/textureinput.h>
+	#include <Substance/texture.h>
+	#include <Substance/textureinput.h>
 
 
 	namespace SubstanceAir
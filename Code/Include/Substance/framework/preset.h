@@ -8,7 +8,7 @@
 
 #include "typedefs.h"
 
-#include <substance/inputdesc.h>
+#include <Substance/inputdesc.h>
 
 
 
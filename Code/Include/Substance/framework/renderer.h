@@ -10,7 +10,7 @@
 #include "package.h"
 #include "callbacks.h"
 
-#include <substance/version.h>
+#include <Substance/version.h>
 
 
 
@@ -10,7 +10,7 @@
 #include "typedefs.h"
 
 #if !defined(AIR_PLATFORM_AGNOSTIC)
-	#include <substance/context.h>
+	#include <Substance/context.h>
 #endif //if !defined(AIR_PLATFORM_AGNOSTIC)
 
 
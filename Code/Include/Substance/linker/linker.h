@@ -52,6 +52,6 @@
 #include "handle.h"
 
 /** Engine IDs enumeration header */
-#include <substance/engineid.h>
+#include <Substance/engineid.h>
 
 #endif /* ifndef _SUBSTANCE_LINKER_LINKER_H */
@@ -0,0 +1,695 @@
+/** @file BlockCompression.cpp
+	@brief Source File for the BC5/BC7 block compression of the rendered textures
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <AzCore/Jobs/JobCompletion.h>
+#include <AzCore/Jobs/JobContext.h>
+#include <AzCore/Jobs/JobFunction.h>
+#include <AzCore/Jobs/JobManager.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BC_SIMD_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BC_TARGET_AVX2
+#else
+#define BC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace BlockCompression
+{
+
+// Interpolation weights of the BC7 4 bit indices:
+static const int kWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Writer of the bits of a 128 bits block, LSB first:
+struct BlockWriter
+{
+	uint64_t lo;
+	uint64_t hi;
+	unsigned int pos;
+
+	BlockWriter() : lo(0), hi(0), pos(0)
+	{
+	}
+
+	void write(uint64_t value, unsigned int bits)
+	{
+		if(pos < 64) {
+			lo |= value << pos;
+			if(pos + bits > 64) {
+				hi |= value >> (64 - pos);
+			}
+		}
+		else {
+			hi |= value << (pos - 64);
+		}
+		pos += bits;
+	}
+
+	void flush(uint8_t* block) const
+	{
+		for(int i=0; i<8; ++i) {
+			block[i] = (uint8_t)(lo >> (8*i));
+			block[8+i] = (uint8_t)(hi >> (8*i));
+		}
+	}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// BC4/BC5
+/////////////////////////////////////////////////////////////////////////////
+
+// The indices are computed on the [max,min] interpolation line: t = round((max-v)*7/range),
+// then remapped to the BC4 palette order (0 = max, 1 = min, 2..7 = interpolated values):
+static inline uint8_t remapBC4Index(int t)
+{
+	int idx = (t+1)&7;
+	return (uint8_t)(idx < 2 ? idx^1 : idx);
+}
+
+static void writeBC4(uint8_t maxv, uint8_t minv, const uint8_t* indices, uint8_t* block)
+{
+	block[0] = maxv;
+	block[1] = minv;
+
+	uint64_t bits = 0;
+	for(int i=0; i<16; ++i) {
+		bits |= (uint64_t)indices[i] << (3*i);
+	}
+	for(int i=0; i<6; ++i) {
+		block[2+i] = (uint8_t)(bits >> (8*i));
+	}
+}
+
+static void encodeBC4Scalar(const uint8_t* pixels, int channel, uint8_t* block)
+{
+	uint8_t minv = 255, maxv = 0;
+	for(int i=0; i<16; ++i) {
+		uint8_t v = pixels[4*i+channel];
+		minv = std::min(minv, v);
+		maxv = std::max(maxv, v);
+	}
+
+	uint8_t indices[16];
+	int range = maxv - minv;
+	for(int i=0; i<16; ++i) {
+		int t = range == 0 ? 0 : ((maxv - pixels[4*i+channel])*14 + range) / (2*range);
+		indices[i] = range == 0 ? 0 : remapBC4Index(t);
+	}
+
+	writeBC4(maxv, minv, indices, block);
+}
+
+#if defined(BC_SIMD_X86)
+
+// Count the thresholds (2k-1)*range (k=1..7) reached by d = (max-v)*14, and remap to the palette order:
+static inline __m128i computeBC4IndicesSSE2(__m128i values, __m128i maxv, int range)
+{
+	__m128i d = _mm_mullo_epi16(_mm_sub_epi16(maxv, values), _mm_set1_epi16(14));
+	__m128i t = _mm_setzero_si128();
+	for(int k=1; k<=7; ++k) {
+		t = _mm_sub_epi16(t, _mm_cmpgt_epi16(d, _mm_set1_epi16((short)((2*k-1)*range - 1))));
+	}
+
+	__m128i idx = _mm_and_si128(_mm_add_epi16(t, _mm_set1_epi16(1)), _mm_set1_epi16(7));
+	__m128i swap = _mm_and_si128(_mm_cmplt_epi16(idx, _mm_set1_epi16(2)), _mm_set1_epi16(1));
+	return _mm_xor_si128(idx, swap);
+}
+
+static inline int hminEpi16(__m128i v)
+{
+	v = _mm_min_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2)));
+	v = _mm_min_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2,3,0,1)));
+	v = _mm_min_epi16(v, _mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1)));
+	return _mm_cvtsi128_si32(v) & 0xFFFF;
+}
+
+static inline int hmaxEpi16(__m128i v)
+{
+	v = _mm_max_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2)));
+	v = _mm_max_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2,3,0,1)));
+	v = _mm_max_epi16(v, _mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1)));
+	return _mm_cvtsi128_si32(v) & 0xFFFF;
+}
+
+static void encodeBC4SSE2(const uint8_t* pixels, int channel, uint8_t* block)
+{
+	// Extract the channel as 16 bits values:
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i shift = _mm_cvtsi32_si128(8*channel);
+	__m128i c0 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(pixels)), shift), mask);
+	__m128i c1 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(pixels+16)), shift), mask);
+	__m128i c2 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(pixels+32)), shift), mask);
+	__m128i c3 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i*)(pixels+48)), shift), mask);
+	__m128i v0 = _mm_packs_epi32(c0, c1);
+	__m128i v1 = _mm_packs_epi32(c2, c3);
+
+	int minv = hminEpi16(_mm_min_epi16(v0, v1));
+	int maxv = hmaxEpi16(_mm_max_epi16(v0, v1));
+	int range = maxv - minv;
+
+	uint8_t indices[16];
+	if(range == 0) {
+		memset(indices, 0, 16);
+	}
+	else {
+		__m128i vmax = _mm_set1_epi16((short)maxv);
+		__m128i i0 = computeBC4IndicesSSE2(v0, vmax, range);
+		__m128i i1 = computeBC4IndicesSSE2(v1, vmax, range);
+		_mm_storeu_si128((__m128i*)indices, _mm_packus_epi16(i0, i1));
+	}
+
+	writeBC4((uint8_t)maxv, (uint8_t)minv, indices, block);
+}
+
+BC_TARGET_AVX2 static void encodeBC4AVX2(const uint8_t* pixels, int channel, uint8_t* block)
+{
+	// Extract the channel as 16 bits values, in pixel order:
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+	const __m128i shift = _mm_cvtsi32_si128(8*channel);
+	__m256i c0 = _mm256_and_si256(_mm256_srl_epi32(_mm256_loadu_si256((const __m256i*)(pixels)), shift), mask);
+	__m256i c1 = _mm256_and_si256(_mm256_srl_epi32(_mm256_loadu_si256((const __m256i*)(pixels+32)), shift), mask);
+	__m256i v = _mm256_permute4x64_epi64(_mm256_packs_epi32(c0, c1), _MM_SHUFFLE(3,1,2,0));
+
+	__m128i lo = _mm256_castsi256_si128(v);
+	__m128i hi = _mm256_extracti128_si256(v, 1);
+	int minv = hminEpi16(_mm_min_epi16(lo, hi));
+	int maxv = hmaxEpi16(_mm_max_epi16(lo, hi));
+	int range = maxv - minv;
+
+	uint8_t indices[16];
+	if(range == 0) {
+		memset(indices, 0, 16);
+	}
+	else {
+		__m256i d = _mm256_mullo_epi16(_mm256_sub_epi16(_mm256_set1_epi16((short)maxv), v), _mm256_set1_epi16(14));
+		__m256i t = _mm256_setzero_si256();
+		for(int k=1; k<=7; ++k) {
+			t = _mm256_sub_epi16(t, _mm256_cmpgt_epi16(d, _mm256_set1_epi16((short)((2*k-1)*range - 1))));
+		}
+
+		__m256i idx = _mm256_and_si256(_mm256_add_epi16(t, _mm256_set1_epi16(1)), _mm256_set1_epi16(7));
+		__m256i swap = _mm256_and_si256(_mm256_cmpgt_epi16(_mm256_set1_epi16(2), idx), _mm256_set1_epi16(1));
+		idx = _mm256_xor_si256(idx, swap);
+		_mm_storeu_si128((__m128i*)indices, _mm_packus_epi16(_mm256_castsi256_si128(idx), _mm256_extracti128_si256(idx, 1)));
+	}
+
+	writeBC4((uint8_t)maxv, (uint8_t)minv, indices, block);
+}
+
+#endif // BC_SIMD_X86
+
+/////////////////////////////////////////////////////////////////////////////
+// BC7 mode 6
+/////////////////////////////////////////////////////////////////////////////
+
+struct BC7Endpoints
+{
+	int q[2][4];	// 7 bits endpoint components
+	int p[2];		// p-bits
+	int color[2][4];// reconstructed 8 bits endpoints
+	int palette[16][4];
+};
+
+// Fit the endpoints on the principal axis of the block colors:
+static void fitBC7Endpoints(const uint8_t* pixels, float e[2][4])
+{
+	float mean[4] = { 0, 0, 0, 0 };
+	float minc[4] = { 255, 255, 255, 255 };
+	float maxc[4] = { 0, 0, 0, 0 };
+	for(int i=0; i<16; ++i) {
+		for(int c=0; c<4; ++c) {
+			float v = pixels[4*i+c];
+			mean[c] += v;
+			minc[c] = std::min(minc[c], v);
+			maxc[c] = std::max(maxc[c], v);
+		}
+	}
+	for(int c=0; c<4; ++c) {
+		mean[c] /= 16.0f;
+	}
+
+	float cov[4][4] = { { 0 } };
+	for(int i=0; i<16; ++i) {
+		float d[4];
+		for(int c=0; c<4; ++c) {
+			d[c] = pixels[4*i+c] - mean[c];
+		}
+		for(int a=0; a<4; ++a) {
+			for(int b=a; b<4; ++b) {
+				cov[a][b] += d[a]*d[b];
+			}
+		}
+	}
+	for(int a=0; a<4; ++a) {
+		for(int b=0; b<a; ++b) {
+			cov[a][b] = cov[b][a];
+		}
+	}
+
+	// Power iterations from the bounding box diagonal:
+	float axis[4];
+	for(int c=0; c<4; ++c) {
+		axis[c] = maxc[c] - minc[c];
+	}
+	for(int iter=0; iter<8; ++iter) {
+		float next[4];
+		float len = 0.0f;
+		for(int a=0; a<4; ++a) {
+			next[a] = cov[a][0]*axis[0] + cov[a][1]*axis[1] + cov[a][2]*axis[2] + cov[a][3]*axis[3];
+			len = std::max(len, std::fabs(next[a]));
+		}
+		if(len < 1e-6f) {
+			break;
+		}
+		for(int a=0; a<4; ++a) {
+			axis[a] = next[a]/len;
+		}
+	}
+
+	float len2 = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2] + axis[3]*axis[3];
+	if(len2 < 1e-6f) {
+		// Flat block:
+		for(int c=0; c<4; ++c) {
+			e[0][c] = e[1][c] = mean[c];
+		}
+		return;
+	}
+
+	// Project the colors on the axis:
+	float tmin = 1e30f, tmax = -1e30f;
+	for(int i=0; i<16; ++i) {
+		float t = 0.0f;
+		for(int c=0; c<4; ++c) {
+			t += (pixels[4*i+c] - mean[c])*axis[c];
+		}
+		tmin = std::min(tmin, t);
+		tmax = std::max(tmax, t);
+	}
+
+	for(int c=0; c<4; ++c) {
+		e[0][c] = std::min(std::max(mean[c] + axis[c]*tmin/len2, 0.0f), 255.0f);
+		e[1][c] = std::min(std::max(mean[c] + axis[c]*tmax/len2, 0.0f), 255.0f);
+	}
+}
+
+// Quantize the endpoints to 7 bits with the p-bit giving the lowest error, and build the palette:
+static void quantizeBC7Endpoints(float e[2][4], BC7Endpoints& ep)
+{
+	for(int k=0; k<2; ++k) {
+		int color[4];
+		for(int c=0; c<4; ++c) {
+			color[c] = (int)(e[k][c] + 0.5f);
+		}
+
+		int bestErr = -1;
+		for(int p=0; p<2; ++p) {
+			int q[4];
+			int err = 0;
+			for(int c=0; c<4; ++c) {
+				q[c] = std::min(std::max((color[c] - p + 1) >> 1, 0), 127);
+				int rec = (q[c] << 1) | p;
+				err += (rec - color[c])*(rec - color[c]);
+			}
+			if(bestErr < 0 || err < bestErr) {
+				bestErr = err;
+				ep.p[k] = p;
+				for(int c=0; c<4; ++c) {
+					ep.q[k][c] = q[c];
+					ep.color[k][c] = (q[c] << 1) | p;
+				}
+			}
+		}
+	}
+
+	for(int i=0; i<16; ++i) {
+		for(int c=0; c<4; ++c) {
+			ep.palette[i][c] = ((64-kWeights4[i])*ep.color[0][c] + kWeights4[i]*ep.color[1][c] + 32) >> 6;
+		}
+	}
+}
+
+static void writeBC7Mode6(BC7Endpoints& ep, uint8_t* indices, uint8_t* block)
+{
+	// The MSB of the anchor index is implicit, swap the endpoints if needed:
+	int e0 = 0, e1 = 1;
+	if(indices[0] >= 8) {
+		std::swap(e0, e1);
+		for(int i=0; i<16; ++i) {
+			indices[i] = (uint8_t)(15 - indices[i]);
+		}
+	}
+
+	BlockWriter writer;
+	writer.write(1u<<6, 7);
+	for(int c=0; c<4; ++c) {
+		writer.write(ep.q[e0][c], 7);
+		writer.write(ep.q[e1][c], 7);
+	}
+	writer.write(ep.p[e0], 1);
+	writer.write(ep.p[e1], 1);
+	writer.write(indices[0], 3);
+	for(int i=1; i<16; ++i) {
+		writer.write(indices[i], 4);
+	}
+	writer.flush(block);
+}
+
+static void encodeBC7Scalar(const uint8_t* pixels, uint8_t* block)
+{
+	float e[2][4];
+	BC7Endpoints ep;
+	fitBC7Endpoints(pixels, e);
+	quantizeBC7Endpoints(e, ep);
+
+	// Select the closest palette entry for each pixel:
+	uint8_t indices[16];
+	for(int i=0; i<16; ++i) {
+		int bestErr = 0x7FFFFFFF;
+		for(int j=0; j<16; ++j) {
+			int err = 0;
+			for(int c=0; c<4; ++c) {
+				int d = pixels[4*i+c] - ep.palette[j][c];
+				err += d*d;
+			}
+			if(err < bestErr) {
+				bestErr = err;
+				indices[i] = (uint8_t)j;
+			}
+		}
+	}
+
+	writeBC7Mode6(ep, indices, block);
+}
+
+#if defined(BC_SIMD_X86)
+
+// Sum the adjacent 32 bits pairs of two registers (pairs of a first, then pairs of b):
+static inline __m128i pairSumEpi32(__m128i a, __m128i b)
+{
+	__m128 fa = _mm_castsi128_ps(a);
+	__m128 fb = _mm_castsi128_ps(b);
+	__m128i even = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2,0,2,0)));
+	__m128i odd = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3,1,3,1)));
+	return _mm_add_epi32(even, odd);
+}
+
+static void encodeBC7SSE2(const uint8_t* pixels, uint8_t* block)
+{
+	float e[2][4];
+	BC7Endpoints ep;
+	fitBC7Endpoints(pixels, e);
+	quantizeBC7Endpoints(e, ep);
+
+	// 2 pixels per register, as 16 bits RGBA:
+	const __m128i zero = _mm_setzero_si128();
+	__m128i px[8];
+	for(int k=0; k<4; ++k) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(pixels + 16*k));
+		px[2*k] = _mm_unpacklo_epi8(v, zero);
+		px[2*k+1] = _mm_unpackhi_epi8(v, zero);
+	}
+
+	// Best error and index for each group of 4 pixels:
+	__m128i bestErr[4], bestIdx[4];
+	for(int g=0; g<4; ++g) {
+		bestErr[g] = _mm_set1_epi32(0x7FFFFFFF);
+		bestIdx[g] = _mm_setzero_si128();
+	}
+
+	for(int j=0; j<16; ++j) {
+		const int* pal = ep.palette[j];
+		__m128i palv = _mm_set_epi16((short)pal[3], (short)pal[2], (short)pal[1], (short)pal[0],
+			(short)pal[3], (short)pal[2], (short)pal[1], (short)pal[0]);
+		__m128i jv = _mm_set1_epi32(j);
+
+		for(int g=0; g<4; ++g) {
+			__m128i d0 = _mm_sub_epi16(px[2*g], palv);
+			__m128i d1 = _mm_sub_epi16(px[2*g+1], palv);
+			__m128i err = pairSumEpi32(_mm_madd_epi16(d0, d0), _mm_madd_epi16(d1, d1));
+
+			__m128i better = _mm_cmplt_epi32(err, bestErr[g]);
+			bestErr[g] = _mm_or_si128(_mm_and_si128(better, err), _mm_andnot_si128(better, bestErr[g]));
+			bestIdx[g] = _mm_or_si128(_mm_and_si128(better, jv), _mm_andnot_si128(better, bestIdx[g]));
+		}
+	}
+
+	__m128i idx16 = _mm_packs_epi32(bestIdx[0], bestIdx[1]);
+	__m128i idx16b = _mm_packs_epi32(bestIdx[2], bestIdx[3]);
+	uint8_t indices[16];
+	_mm_storeu_si128((__m128i*)indices, _mm_packus_epi16(idx16, idx16b));
+
+	writeBC7Mode6(ep, indices, block);
+}
+
+BC_TARGET_AVX2 static void encodeBC7AVX2(const uint8_t* pixels, uint8_t* block)
+{
+	float e[2][4];
+	BC7Endpoints ep;
+	fitBC7Endpoints(pixels, e);
+	quantizeBC7Endpoints(e, ep);
+
+	// 4 pixels per register, as 16 bits RGBA:
+	__m256i px[4];
+	for(int k=0; k<4; ++k) {
+		px[k] = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(pixels + 16*k)));
+	}
+
+	// Best error and index for each group of 8 pixels, in the hadd lane order:
+	__m256i bestErr[2], bestIdx[2];
+	for(int g=0; g<2; ++g) {
+		bestErr[g] = _mm256_set1_epi32(0x7FFFFFFF);
+		bestIdx[g] = _mm256_setzero_si256();
+	}
+
+	for(int j=0; j<16; ++j) {
+		const int* pal = ep.palette[j];
+		__m256i palv = _mm256_set1_epi64x((long long)(uint16_t)pal[0] | ((long long)(uint16_t)pal[1] << 16)
+			| ((long long)(uint16_t)pal[2] << 32) | ((long long)(uint16_t)pal[3] << 48));
+		__m256i jv = _mm256_set1_epi32(j);
+
+		for(int g=0; g<2; ++g) {
+			__m256i d0 = _mm256_sub_epi16(px[2*g], palv);
+			__m256i d1 = _mm256_sub_epi16(px[2*g+1], palv);
+			__m256i err = _mm256_hadd_epi32(_mm256_madd_epi16(d0, d0), _mm256_madd_epi16(d1, d1));
+
+			__m256i better = _mm256_cmpgt_epi32(bestErr[g], err);
+			bestErr[g] = _mm256_min_epi32(bestErr[g], err);
+			bestIdx[g] = _mm256_blendv_epi8(bestIdx[g], jv, better);
+		}
+	}
+
+	// Restore the pixel order from the hadd lane order:
+	__m256i i0 = _mm256_permute4x64_epi64(bestIdx[0], _MM_SHUFFLE(3,1,2,0));
+	__m256i i1 = _mm256_permute4x64_epi64(bestIdx[1], _MM_SHUFFLE(3,1,2,0));
+	__m256i idx16 = _mm256_permute4x64_epi64(_mm256_packs_epi32(i0, i1), _MM_SHUFFLE(3,1,2,0));
+	uint8_t indices[16];
+	_mm_storeu_si128((__m128i*)indices, _mm_packus_epi16(_mm256_castsi256_si128(idx16), _mm256_extracti128_si256(idx16, 1)));
+
+	writeBC7Mode6(ep, indices, block);
+}
+
+#endif // BC_SIMD_X86
+
+/////////////////////////////////////////////////////////////////////////////
+// Dispatch
+/////////////////////////////////////////////////////////////////////////////
+
+static bool cpuSupportsAVX2()
+{
+#if defined(BC_SIMD_X86)
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7) {
+		return false;
+	}
+
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1<<27)) != 0;
+	bool avx = (info[2] & (1<<28)) != 0;
+	__cpuidex(info, 7, 0);
+	bool avx2 = (info[1] & (1<<5)) != 0;
+
+	// Check that the OS saves the YMM registers:
+	return osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+#else
+	return false;
+#endif
+}
+
+bool isKernelSupported(Kernel kernel)
+{
+	switch(kernel) {
+	case Kernel_Scalar:
+	case Kernel_Best:
+		return true;
+#if defined(BC_SIMD_X86)
+	case Kernel_SSE2:
+		return true;
+	case Kernel_AVX2:
+	{
+		static const bool avx2 = cpuSupportsAVX2();
+		return avx2;
+	}
+#endif
+	default:
+		return false;
+	}
+}
+
+Kernel getBestKernel()
+{
+	if(isKernelSupported(Kernel_AVX2)) {
+		return Kernel_AVX2;
+	}
+	if(isKernelSupported(Kernel_SSE2)) {
+		return Kernel_SSE2;
+	}
+	return Kernel_Scalar;
+}
+
+const char* getKernelName(Kernel kernel)
+{
+	switch(kernel) {
+	case Kernel_Scalar: return "scalar";
+	case Kernel_SSE2: return "sse2";
+	case Kernel_AVX2: return "avx2";
+	default: return "best";
+	}
+}
+
+size_t getEncodedSize(int width, int height)
+{
+	return (size_t)((width+3)/4) * ((height+3)/4) * 16;
+}
+
+void encodeBlock(Format format, Kernel kernel, const uint8_t* pixels, uint8_t* block)
+{
+	if(kernel == Kernel_Best) {
+		kernel = getBestKernel();
+	}
+
+#if defined(BC_SIMD_X86)
+	if(kernel == Kernel_AVX2) {
+		if(format == Format_BC5) {
+			encodeBC4AVX2(pixels, 0, block);
+			encodeBC4AVX2(pixels, 1, block+8);
+		}
+		else {
+			encodeBC7AVX2(pixels, block);
+		}
+		return;
+	}
+
+	if(kernel == Kernel_SSE2) {
+		if(format == Format_BC5) {
+			encodeBC4SSE2(pixels, 0, block);
+			encodeBC4SSE2(pixels, 1, block+8);
+		}
+		else {
+			encodeBC7SSE2(pixels, block);
+		}
+		return;
+	}
+#endif
+
+	if(format == Format_BC5) {
+		encodeBC4Scalar(pixels, 0, block);
+		encodeBC4Scalar(pixels, 1, block+8);
+	}
+	else {
+		encodeBC7Scalar(pixels, block);
+	}
+}
+
+// Encode a range of block rows:
+static void encodeRows(Format format, Kernel kernel, const uint8_t* rgba, int width, int height, uint8_t* out, int row0, int row1)
+{
+	int bw = (width+3)/4;
+	uint8_t pixels[64];
+
+	for(int by=row0; by<row1; ++by) {
+		for(int bx=0; bx<bw; ++bx) {
+			int x0 = bx*4;
+			int y0 = by*4;
+			if(x0+4 <= width && y0+4 <= height) {
+				for(int y=0; y<4; ++y) {
+					memcpy(pixels + 16*y, rgba + 4*((size_t)(y0+y)*width + x0), 16);
+				}
+			}
+			else {
+				// Pad the partial blocks with the edge pixels:
+				for(int y=0; y<4; ++y) {
+					for(int x=0; x<4; ++x) {
+						int sx = std::min(x0+x, width-1);
+						int sy = std::min(y0+y, height-1);
+						memcpy(pixels + 16*y + 4*x, rgba + 4*((size_t)sy*width + sx), 4);
+					}
+				}
+			}
+
+			encodeBlock(format, kernel, pixels, out + 16*((size_t)by*bw + bx));
+		}
+	}
+}
+
+void encodeImage(Format format, const uint8_t* rgba, int width, int height, uint8_t* out, Kernel kernel, int jobCount)
+{
+	if(width <= 0 || height <= 0) {
+		return;
+	}
+
+	if(kernel == Kernel_Best || !isKernelSupported(kernel)) {
+		kernel = getBestKernel();
+	}
+
+	// The images are encoded by the shared workers of the job manager, which the texture loader threads
+	// compete for instead of each one starting its own threads. Without a job manager, the caller encodes them:
+	AZ::JobContext* jobContext = AZ::JobContext::GetGlobalContext();
+	int bh = (height+3)/4;
+	if(jobCount <= 0) {
+		jobCount = jobContext ? (int)jobContext->GetJobManager().GetNumWorkerThreads() + 1 : 1;
+	}
+	jobCount = std::min(jobCount, bh);
+
+	if(jobCount <= 1 || !jobContext) {
+		encodeRows(format, kernel, rgba, width, height, out, 0, bh);
+		return;
+	}
+
+	// Split the block rows in jobs, the caller encodes the first range:
+	AZ::JobCompletion completion(jobContext);
+	int rowsPerJob = (bh + jobCount - 1)/jobCount;
+	for(int row0 = rowsPerJob; row0 < bh; row0 += rowsPerJob) {
+		int row1 = std::min(row0 + rowsPerJob, bh);
+		AZ::Job* job = AZ::CreateJobFunction([=]() {
+			encodeRows(format, kernel, rgba, width, height, out, row0, row1);
+		}, true, jobContext);
+		job->SetDependent(&completion);
+		job->Start();
+	}
+
+	encodeRows(format, kernel, rgba, width, height, out, 0, std::min(rowsPerJob, bh));
+
+	completion.StartAndWaitForCompletion();
+}
+
+} // namespace BlockCompression
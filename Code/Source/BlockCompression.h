@@ -0,0 +1,62 @@
+/** @file BlockCompression.h
+	@brief Header for the BC5/BC7 block compression of the rendered textures
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_BLOCKCOMPRESSION_H
+#define GEM_SUBSTANCE_BLOCKCOMPRESSION_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ Block compression of RGBA8 images to BC5 or BC7.
+
+ BC5 stores the red and green channels as two BC4 blocks, which suits the
+ normal maps. BC7 blocks are encoded in mode 6 (single subset, RGBA 7.7.7.7
+ endpoints with p-bits and 4 bit indices), with endpoints fitted on the
+ principal axis of the block colors.
+ Each format has a scalar reference kernel and SSE2/AVX2 kernels producing
+ the same blocks; the best kernel supported by the CPU is selected at runtime.
+ Images are split in rows of blocks encoded by the jobs of the job manager.
+*/
+namespace BlockCompression
+{
+	enum Format
+	{
+		Format_BC5,
+		Format_BC7
+	};
+
+	enum Kernel
+	{
+		Kernel_Scalar,
+		Kernel_SSE2,
+		Kernel_AVX2,
+		Kernel_Best
+	};
+
+	/// Retrieve the best kernel supported by the CPU.
+	Kernel getBestKernel();
+
+	/// Check if a kernel is supported by the CPU.
+	bool isKernelSupported(Kernel kernel);
+
+	/// Retrieve the name of a kernel.
+	const char* getKernelName(Kernel kernel);
+
+	/// Retrieve the size of an encoded image (16 bytes per 4x4 block for both formats).
+	size_t getEncodedSize(int width, int height);
+
+	/// Encode a 4x4 block of RGBA8 pixels (64 bytes in row order) into 16 bytes.
+	void encodeBlock(Format format, Kernel kernel, const uint8_t* pixels, uint8_t* block);
+
+	/// Encode a RGBA8 image, the partial blocks on the borders are padded with the edge pixels.
+	/// jobCount is the number of row ranges encoded in parallel (0 for one per job worker).
+	void encodeImage(Format format, const uint8_t* rgba, int width, int height, uint8_t* out,
+		Kernel kernel = Kernel_Best, int jobCount = 0);
+}
+
+#endif //GEM_SUBSTANCE_BLOCKCOMPRESSION_H
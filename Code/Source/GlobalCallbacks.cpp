@@ -0,0 +1,182 @@
+/** @file GlobalCallbacks.cpp
+	@brief Source File for the substance framework global callbacks of the gem
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "GlobalCallbacks.h"
+#include "RenderCacheSpill.h"
+#include <algorithm>
+
+// Owner of the allocations of the current thread:
+static thread_local unsigned int s_currentOwner = 0;
+
+SubstanceGlobalCallbacks::OwnerScope::OwnerScope(const char* owner) : _previous(s_currentOwner)
+{
+	s_currentOwner = SubstanceGlobalCallbacks::instance().getOwnerID(owner, false);
+}
+
+SubstanceGlobalCallbacks::OwnerScope::~OwnerScope()
+{
+	s_currentOwner = _previous;
+}
+
+SubstanceGlobalCallbacks& SubstanceGlobalCallbacks::instance()
+{
+	static SubstanceGlobalCallbacks callbacks;
+	return callbacks;
+}
+
+SubstanceGlobalCallbacks::SubstanceGlobalCallbacks()
+{
+	_owners.push_back("<engine>");
+}
+
+unsigned int SubstanceGlobalCallbacks::getEnabledMask() const
+{
+	return RenderCacheSpill::instance().isOpen() ? Enable_UserAlloc | Enable_RenderCache : Enable_UserAlloc;
+}
+
+void* SubstanceGlobalCallbacks::memoryAlloc(size_t bytesCount, size_t alignment)
+{
+	return _pool.allocate(bytesCount, alignment, s_currentOwner);
+}
+
+void SubstanceGlobalCallbacks::memoryFree(void* bufferPtr)
+{
+	if(bufferPtr && !_pool.release(bufferPtr)) {
+		logERROR("Substance memory pool: releasing an unknown buffer.");
+	}
+}
+
+void SubstanceGlobalCallbacks::renderCacheEvict(SubstanceAir::UInt64 cacheItemUid, const void* cacheBuffer, size_t cacheBufferSize)
+{
+	RenderCacheSpill::instance().evict(cacheItemUid, cacheBuffer, cacheBufferSize);
+}
+
+void SubstanceGlobalCallbacks::renderCacheFetch(SubstanceAir::UInt64 cacheItemUid, void* cacheBuffer, size_t cacheBufferSize)
+{
+	// The engine can't recompute an item it fetches: an item which can't be restored is restored blank rather than
+	// with stale memory, the outputs depending on it are wrong and are not stored in the texture cache anymore:
+	if(!RenderCacheSpill::instance().fetch(cacheItemUid, cacheBuffer, cacheBufferSize)) {
+		memset(cacheBuffer, 0, cacheBufferSize);
+		CryLogAlways("ERROR: Substance render cache spill: item %llx restored blank, the current render is wrong", (unsigned long long)cacheItemUid);
+	}
+}
+
+void SubstanceGlobalCallbacks::renderCacheRemove(SubstanceAir::UInt64 cacheItemUid)
+{
+	RenderCacheSpill::instance().remove(cacheItemUid);
+}
+
+bool SubstanceGlobalCallbacks::isArrayAllocated(const void* bufferPtr) const
+{
+	return bufferPtr && _pool.isArrayAllocated(bufferPtr);
+}
+
+void SubstanceGlobalCallbacks::detach(const void* bufferPtr)
+{
+	_pool.detach(bufferPtr);
+}
+
+void SubstanceGlobalCallbacks::setOwner(const void* bufferPtr, const char* owner, bool result)
+{
+	_pool.setOwner(bufferPtr, getOwnerID(owner, result));
+}
+
+size_t SubstanceGlobalCallbacks::getOwnerBytes(const char* owner, bool result) const
+{
+	unsigned int id = 0;
+	{
+		CryAutoCriticalSection lock(_lock);
+		auto it = _ownerIDs.find(getOwnerName(owner, result));
+		if(it == _ownerIDs.end()) {
+			return 0;
+		}
+		id = it->second;
+	}
+
+	auto bytes = _pool.getOwnerBytes();
+	auto it = bytes.find(id);
+	return it != bytes.end() ? it->second : 0;
+}
+
+void SubstanceGlobalCallbacks::setBudget(size_t budget)
+{
+	_pool.setBudget(budget);
+}
+
+void SubstanceGlobalCallbacks::trim()
+{
+	_pool.trim();
+}
+
+AZStd::string SubstanceGlobalCallbacks::getOwnerName(const char* owner, bool result)
+{
+	return result ? string_format("%s (results)", owner) : AZStd::string(owner);
+}
+
+unsigned int SubstanceGlobalCallbacks::getOwnerID(const char* owner, bool result)
+{
+	AZStd::string name = getOwnerName(owner, result);
+
+	CryAutoCriticalSection lock(_lock);
+	auto it = _ownerIDs.find(name);
+	if(it != _ownerIDs.end()) {
+		return it->second;
+	}
+
+	unsigned int id = (unsigned int)_owners.size();
+	_owners.push_back(name);
+	_ownerIDs[name] = id;
+	return id;
+}
+
+void SubstanceGlobalCallbacks::dumpStats() const
+{
+	MemoryPool::Stats stats = _pool.getStats();
+	const float mb = 1024.0f*1024.0f;
+
+	CryLogAlways("Substance memory pool: %.2f MB live (peak %.2f MB), %.2f MB requested, %.1f%% lost to the size classes, %.2f MB cached",
+		stats.liveBytes/mb, stats.peakLiveBytes/mb, stats.requestedBytes/mb,
+		stats.liveBytes > 0 ? 100.0f*(stats.liveBytes - stats.requestedBytes)/stats.liveBytes : 0.0f, stats.cachedBytes/mb);
+	CryLogAlways("Substance memory pool: %u slabs (%.2f MB, %.1f%% free, %u released), %u allocations, %.1f%% reused, %u budget overruns, %u cached buffers released for the budget",
+		stats.slabs, stats.slabBytes/mb, stats.slabBytes > 0 ? 100.0f*stats.slabFreeBytes/stats.slabBytes : 0.0f, stats.releasedSlabs,
+		stats.allocations, stats.allocations > 0 ? 100.0f*stats.reuses/stats.allocations : 0.0f, stats.overruns, stats.trims);
+
+	// Live bytes of the owners, largest first:
+	std::vector<std::pair<size_t, unsigned int>> owners;
+	for(const auto& it: _pool.getOwnerBytes()) {
+		if(it.second > 0) {
+			owners.push_back(std::make_pair(it.second, it.first));
+		}
+	}
+	std::sort(owners.rbegin(), owners.rend());
+
+	CryAutoCriticalSection lock(_lock);
+	for(const auto& owner: owners) {
+		CryLogAlways("Substance memory pool: %8.2f MB %s", owner.first/mb, _owners[owner.second].c_str());
+	}
+}
+
+void SubstanceGlobalCallbacks::GetMemoryUsage(ICrySizer* s) const
+{
+	MemoryPool::Stats stats = _pool.getStats();
+	auto bytes = _pool.getOwnerBytes();
+
+	CryAutoCriticalSection lock(_lock);
+	for(const auto& it: bytes) {
+		if(it.second > 0 && it.first < _owners.size()) {
+			SIZER_COMPONENT_NAME(s, _owners[it.first].c_str());
+			s->AddObject(&_owners[it.first], it.second);
+		}
+	}
+
+	SIZER_COMPONENT_NAME(s, "Pool");
+	s->AddObject(&_pool, stats.cachedBytes + stats.slabFreeBytes);
+}
+
+#endif // USE_SUBSTANCE
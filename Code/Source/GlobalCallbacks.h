@@ -0,0 +1,105 @@
+/** @file GlobalCallbacks.h
+	@brief Header for the substance framework global callbacks of the gem
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_GLOBALCALLBACKS_H
+#define GEM_SUBSTANCE_GLOBALCALLBACKS_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include "Substance/framework/callbacks.h"
+#include "MemoryPool.h"
+#include <CryThread.h>
+
+#if defined(USE_SUBSTANCE)
+
+/**
+ Global callbacks of the substance framework.
+
+ The framework and engine buffers are served by a size class pool, which
+ recycles the small objects and the similarly sized pixel buffers, tracks the
+ live bytes of each material and caps its cached blocks to substance_memoryBudget.
+ The large buffers, including the render result textures, are allocated with
+ new[] whenever the requested alignment allows it. Such a result buffer can then
+ be detached from the pool and handed over as is to the engine texture loader,
+ which deletes it with delete[], instead of being copied into a new
+ STextureLoadData allocation.
+
+ Once the render cache spill tier is open, the intermediate results evicted by
+ the engine are handed over to it instead of being dropped and recomputed.
+*/
+class SubstanceGlobalCallbacks : public SubstanceAir::GlobalCallbacks
+{
+public:
+	/// Attribute the allocations of the current thread to a material, or to a shared package, while in scope.
+	class OwnerScope
+	{
+	public:
+		OwnerScope(const char* owner);
+		~OwnerScope();
+
+	protected:
+		unsigned int _previous;
+	};
+
+	static SubstanceGlobalCallbacks& instance();
+
+	virtual unsigned int getEnabledMask() const override;
+
+	virtual void* memoryAlloc(size_t bytesCount, size_t alignment) override;
+
+	virtual void memoryFree(void* bufferPtr) override;
+
+	virtual void renderCacheEvict(SubstanceAir::UInt64 cacheItemUid, const void* cacheBuffer, size_t cacheBufferSize) override;
+
+	virtual void renderCacheFetch(SubstanceAir::UInt64 cacheItemUid, void* cacheBuffer, size_t cacheBufferSize) override;
+
+	virtual void renderCacheRemove(SubstanceAir::UInt64 cacheItemUid) override;
+
+	/// Check if a buffer allocated by memoryAlloc() can be released with delete[] once detached.
+	bool isArrayAllocated(const void* bufferPtr) const;
+
+	/// Stop tracking a buffer handed over to another owner, which releases it with delete[].
+	void detach(const void* bufferPtr);
+
+	/// Attribute a buffer allocated by memoryAlloc() to a material, as part of its render results or not.
+	void setOwner(const void* bufferPtr, const char* owner, bool result);
+
+	/// Retrieve the live bytes attributed to a material, for its render results or its other buffers.
+	size_t getOwnerBytes(const char* owner, bool result) const;
+
+	/// Set the cap of the live and cached bytes of the pool.
+	void setBudget(size_t budget);
+
+	/// Release the buffers cached by the pool.
+	void trim();
+
+	/// Write the pool counters and the live bytes of the materials in the log.
+	void dumpStats() const;
+
+	/// Add the live bytes of the pool owners to a sizer.
+	void GetMemoryUsage(ICrySizer* s) const;
+
+protected:
+	SubstanceGlobalCallbacks();
+
+	// Retrieve the pool owner ID of a material, 0 being the engine:
+	unsigned int getOwnerID(const char* owner, bool result);
+
+	// Build the owner name of the render results of a material:
+	static AZStd::string getOwnerName(const char* owner, bool result);
+
+	MemoryPool _pool;
+
+	// Owner IDs, indexed by owner name, and their names:
+	std::map<AZStd::string, unsigned int> _ownerIDs;
+	std::vector<AZStd::string> _owners;
+
+	mutable CryCriticalSection _lock;
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_GLOBALCALLBACKS_H
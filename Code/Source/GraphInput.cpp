@@ -12,12 +12,15 @@
 #include "GraphInstance.h"
 #include "SubstanceMaterial.h"
 #include <AzCore/IO/SystemFile.h>
+#include <algorithm>
 
 using namespace SubstanceAir;
 
 GraphInput::GraphInput(::GraphInstance* parent, unsigned int id) : 
 	_parent(parent),
-	_id(id)
+	_id(id),
+	_static(false),
+	_dynamic(true)
 {
 	logDEBUG("Creating GraphInput object.");
 
@@ -34,6 +37,15 @@ GraphInput::GraphInput(::GraphInstance* parent, unsigned int id) :
 	if(parent->getDefaultInputValue(id, val)) {
 		SetValue(val);
 	}
+
+	// The values set from now on are runtime changes:
+	_static = parent->isStaticInput(id);
+	_dynamic = false;
+}
+
+bool GraphInput::isSpecializing()
+{
+	return substance_specializeInputs && !gEnv->IsEditor();
 }
 
 GraphInput::~GraphInput()
@@ -160,8 +172,43 @@ GraphValueVariant GraphInput::GetValue() const
 	}
 }
 
+bool GraphInput::hasValue(const GraphValueVariant& value) const
+{
+	if(_instance->mDesc.isString()) {
+		const char* str = (const char*)value;
+		return str && ((InputInstanceString*)_instance)->getString() == str;
+	}
+
+	if(!_instance->mDesc.isNumerical()) {
+		return false;
+	}
+
+	// Only the components of the input type are compared, bitwise for both the floats and the integers:
+	GraphValueVariant current = GetValue();
+	const int* lhs = (const int*)current;
+	const int* rhs = (const int*)value;
+	size_t count = std::min(getComponentsCount(_instance->mDesc.mType), (size_t)4);
+	for(size_t i=0; i<count; ++i) {
+		if(lhs[i] != rhs[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void GraphInput::SetValue(const GraphValueVariant& value)
 {
+	// An unchanged value doesn't invalidate any output:
+	if(hasValue(value)) {
+		return;
+	}
+
+	if(_static && isSpecializing()) {
+		logERROR("Ignoring the change of the static input "<<GetName()<<" in material "<<_parent->GetProceduralMaterial()->GetPath());
+		return;
+	}
+
 	if(_instance->mDesc.isNumerical()) {
 		switch (_instance->mDesc.mType) {
 		case Substance_IType_Float:
@@ -220,7 +267,7 @@ void GraphInput::SetValue(const GraphValueVariant& value)
 			} 
 		default:
 			logERROR("setValue(): Unexpected numerical input with type: "<<(int)_instance->mDesc.mType);
-			break;
+			return;
 		}
 	}
 	else if(_instance->mDesc.isString()) {
@@ -233,11 +280,24 @@ void GraphInput::SetValue(const GraphValueVariant& value)
 			} 
 		default:
 			logERROR("Unexpected string input with type: "<<(int)_instance->mDesc.mType);
-			break;
+			return;
 		}
 	}
 	else {
 		logERROR("Unsupported (image ?) input with type: "<<(int)_instance->mDesc.mType);
+		return;
+	}
+
+	// Only the outputs listing this input in their description are recomputed by the next render:
+	_parent->flagAlteredOutputs(_id);
+
+	// The engine keeps the intermediate results which don't depend on the cached inputs,
+	// so that only the part of the graph after a runtime input is recomputed when it changes:
+	if(!_dynamic) {
+		_dynamic = true;
+		if(isSpecializing() && !_instance->mIsHeavyDuty) {
+			_instance->mUseCache = true;
+		}
 	}
 }
 
@@ -50,7 +50,8 @@ public:
 	/// Retrieve the value of this input.
 	virtual GraphValueVariant GetValue() const;
 
-	/// Assign a new value to this input. You must call QueueRender/Render(A)Sync to update the output textures.
+	/// Assign a new value to this input, flagging as dirty the outputs it alters if the value changes.
+	/// You must call QueueRender/Render(A)Sync to update the output textures.
 	virtual void SetValue(const GraphValueVariant& value);
 
 	/// Get the minimum value for this input.
@@ -65,7 +66,22 @@ public:
 	/// Get the enumeration value for combo box inputs.
 	virtual GraphEnumValue GetEnumValue(int index);
 
+	// Check if this input is marked as static in the material:
+	bool isStatic() const { return _static; }
+
+	// Check if this input was changed since the material was loaded:
+	bool isDynamic() const { return _dynamic; }
+
+	// Retrieve the substance input instance:
+	SubstanceAir::InputInstanceBase* getInstance() const { return _instance; }
+
+	// Check if the inputs are specialized: the changes of the static inputs are ignored and only the dynamic inputs are cached.
+	static bool isSpecializing();
+
 protected:
+	// Check if a value is the current value of this input:
+	bool hasValue(const GraphValueVariant& value) const;
+
 	// Pointer on the parent graph instance:
 	GraphInstance* _parent;
 
@@ -74,6 +90,10 @@ protected:
 
 	// Substance output instance:
 	SubstanceAir::InputInstanceBase* _instance;
+
+	// Static input (locked to its material value) and input changed at runtime:
+	bool _static;
+	bool _dynamic;
 };
 
 #endif // USE_SUBSTANCE
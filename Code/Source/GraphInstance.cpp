@@ -12,11 +12,14 @@
 #include "GraphOutput.h"
 #include "GraphInput.h"
 #include "SubstanceMaterial.h"
+#include "MaterialRegistry.h"
 #include <AzCore/IO/SystemFile.h>
+#include <algorithm>
 
 GraphInstance::GraphInstance(SubstanceMaterial* parent, int idx) : 
 	_parent(parent),
-	_index(idx)
+	_index(idx),
+	_instance(nullptr)
 {
 	AZ_TracePrintf("GraphInstance", "Creating GraphInstance object.");
 	// Create a new graph instance on the requested graph:
@@ -26,7 +29,10 @@ GraphInstance::GraphInstance(SubstanceMaterial* parent, int idx) :
 	}
 
 	SubstanceAir::PackageDesc* pdesc = parent->getPackage();
-	_instance = new SubstanceAir::GraphInstance(pdesc->getGraphs()[0]);
+	_instance = new SubstanceAir::GraphInstance(pdesc->getGraphs()[idx]);
+
+	// The render callbacks retrieve this object from the framework instance:
+	_instance->mUserData = (size_t)this;
 
 	// Init the outputs:
 	for(auto& out: _instance->getOutputs()) {
@@ -63,6 +69,19 @@ IProceduralMaterial* GraphInstance::GetProceduralMaterial() const
 	return _parent;
 }
 
+void GraphInstance::GetMemoryUsage(ICrySizer* s) const
+{
+	s->AddObject(this, sizeof(*this));
+	s->AddObject(_outputs.data(), _outputs.capacity()*sizeof(GraphOutput*));
+	s->AddObject(_inputs.data(), _inputs.capacity()*sizeof(GraphInput*));
+	for(auto out: _outputs) {
+		s->AddObject(out, sizeof(GraphOutput));
+	}
+	for(auto in: _inputs) {
+		s->AddObject(in, sizeof(GraphInput));
+	}
+}
+
 const char* GraphInstance::GetName() const
 {
 	return _instance->mDesc.mLabel.c_str();
@@ -70,8 +89,8 @@ const char* GraphInstance::GetName() const
 
 GraphInstanceID GraphInstance::GetGraphInstanceID() const
 {
-	// We use the index as graph ID.
-	return _index;
+	// Encode the material ID and graph index:
+	return MaterialRegistry::encodeGraphInstanceID(_parent->getMaterialID(), _index);
 }
 
 int GraphInstance::GetInputCount() const
@@ -142,9 +161,71 @@ IGraphOutput* GraphInstance::GetOutputByID(GraphOutputID outputID)
 	return nullptr;
 }
 
+int GraphInstance::GetDirtyOutputs(IGraphOutput** ppOutputs, int maxCount)
+{
+	// The disabled outputs are not rendered even if they are dirty:
+	int count = 0;
+	for(auto& out: _outputs) {
+		if(out->IsEnabled() && out->IsDirty()) {
+			if(count < maxCount) {
+				ppOutputs[count] = out;
+			}
+			count++;
+		}
+	}
+
+	return count;
+}
+
+void GraphInstance::flagAlteredOutputs(GraphInputID inputID)
+{
+	for(auto& out: _instance->getOutputs()) {
+		if(isAlteredBy(out, inputID)) {
+			out->flagAsDirty();
+		}
+	}
+}
+
+bool GraphInstance::isAlteredBy(const SubstanceAir::OutputInstance* output, GraphInputID inputID) const
+{
+	// The altering inputs are sorted by UID:
+	const SubstanceAir::Uids& uids = output->mDesc.mAlteringInputUids;
+	if(std::binary_search(uids.begin(), uids.end(), (SubstanceAir::UInt)inputID)) {
+		return true;
+	}
+
+	// The description doesn't account for the components taken from other outputs of the graph:
+	if(!output->isFormatOverridden()) {
+		return false;
+	}
+
+	const SubstanceAir::OutputFormat& format = output->getFormatOverride();
+	for(int i=0; i<SubstanceAir::OutputFormat::ComponentsCount; ++i) {
+		unsigned int uid = format.perComponent[i].outputUid;
+		if(uid == SubstanceAir::OutputFormat::UseDefault || uid == SubstanceAir::OutputFormat::ComponentEmpty || uid == output->mDesc.mUid) {
+			continue;
+		}
+
+		const SubstanceAir::OutputInstance* source = _instance->findOutput(uid);
+		if(source) {
+			const SubstanceAir::Uids& sourceUids = source->mDesc.mAlteringInputUids;
+			if(std::binary_search(sourceUids.begin(), sourceUids.end(), (SubstanceAir::UInt)inputID)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 bool GraphInstance::getDefaultInputValue(unsigned int id, GraphValueVariant& val)
 {
 	return _parent->getDefaultInputValue(string_format("%d_%d",_index, id), val);
 }
 
+bool GraphInstance::isStaticInput(unsigned int id) const
+{
+	return _parent->isStaticInput(string_format("%d_%d",_index, id));
+}
+
 #endif // USE_SUBSTANCE
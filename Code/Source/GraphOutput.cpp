@@ -49,6 +49,30 @@ GraphOutput::GraphOutput(GraphInstance* parent, GraphOutputID id) :
 	}
 
 	_outputPath = string_format("%s_%s.sub", fbase.c_str(),otype.c_str()).c_str();
+
+	SubstanceMaterial::OutputSettings settings;
+	SubstanceMaterial* smat = (SubstanceMaterial*)_parent->GetProceduralMaterial();
+	if(smat->getOutputSettings(id, settings)) {
+		// The disabled outputs are not rendered:
+		_instance->mEnabled = settings.enabled;
+
+		if(settings.encoding != SubstanceMaterial::OutputEncoding_None) {
+			// The outputs encoded by the gem are rendered as 8 bits RGBA:
+			SubstanceAir::OutputFormat fmt;
+			fmt.format = Substance_PF_RGBA;
+			_instance->overrideFormat(fmt);
+		}
+		else if(!gEnv->IsEditor() && settings.compressed) {
+			// Let the engine produce compressed textures when requested in the material.
+			// The editor keeps the raw outputs for the previews and the exports:
+			int format = GetCompressedFormat();
+			if(format >= 0) {
+				SubstanceAir::OutputFormat fmt;
+				fmt.format = (unsigned int)format;
+				_instance->overrideFormat(fmt);
+			}
+		}
+	}
 }
 
 GraphOutput::~GraphOutput()
@@ -100,22 +124,56 @@ void GraphOutput::SetDirty()
 
 int GraphOutput::GetBytesPerPixel(int format) const
 {
-	switch (format)
+	switch (format & ~Substance_PF_sRGB)
 	{
 	case Substance_PF_RGBA|Substance_PF_16b:					return 8;
 	case Substance_PF_RGBx|Substance_PF_16b:					return 8;
 	case Substance_PF_L|Substance_PF_16b:						return 2;
 	case Substance_PF_RGBA:										return 4;
 	case Substance_PF_L:										return 1;
+	case Substance_PF_RGBA|Substance_PF_16F:					return 8;
+	case Substance_PF_RGBx|Substance_PF_16F:					return 8;
+	case Substance_PF_L|Substance_PF_16F:						return 2;
+	case Substance_PF_RGBA|Substance_PF_32F:					return 16;
+	case Substance_PF_RGBx|Substance_PF_32F:					return 16;
+	case Substance_PF_L|Substance_PF_32F:						return 4;
+	case Substance_PF_BC1:
+	case Substance_PF_BC2:
+	case Substance_PF_BC3:
+	case Substance_PF_BC4:
+	case Substance_PF_BC5:										return 0;
 	default:
 		logERROR("Unsupported substance pixel format: "<<format);
 		return 1;
 	}
 }
 
+int GraphOutput::GetBytesPerBlock(int format) const
+{
+	switch (format & ~Substance_PF_sRGB)
+	{
+	case Substance_PF_BC1:										return 8;
+	case Substance_PF_BC4:										return 8;
+	case Substance_PF_BC2:										return 16;
+	case Substance_PF_BC3:										return 16;
+	case Substance_PF_BC5:										return 16;
+	default:													return 0;
+	}
+}
+
+size_t GraphOutput::GetLevelSize(int format, int width, int height) const
+{
+	int blockSize = GetBytesPerBlock(format);
+	if(blockSize > 0) {
+		return (size_t)((width+3)/4) * ((height+3)/4) * blockSize;
+	}
+
+	return (size_t)width * height * GetBytesPerPixel(format);
+}
+
 ETEX_Format GraphOutput::GetEngineFormat(int format) const
 {
-	switch (format)
+	switch (format & ~Substance_PF_sRGB)
 	{
 	case Substance_PF_RGBx|Substance_PF_16b:	
 		return eTF_R16G16B16A16;	
@@ -127,23 +185,75 @@ ETEX_Format GraphOutput::GetEngineFormat(int format) const
 		return eTF_R8G8B8A8;
 	case Substance_PF_L:
 		return eTF_L8;
+	case Substance_PF_RGBA|Substance_PF_16F:
+	case Substance_PF_RGBx|Substance_PF_16F:
+		return eTF_R16G16B16A16F;
+	case Substance_PF_L|Substance_PF_16F:
+		return eTF_R16F;
+	case Substance_PF_RGBA|Substance_PF_32F:
+	case Substance_PF_RGBx|Substance_PF_32F:
+		return eTF_R32G32B32A32F;
+	case Substance_PF_L|Substance_PF_32F:
+		return eTF_R32F;
+	case Substance_PF_BC1:
+		return eTF_BC1;
+	case Substance_PF_BC2:
+		return eTF_BC2;
+	case Substance_PF_BC3:
+		return eTF_BC3;
+	case Substance_PF_BC4:
+		return eTF_BC4U;
+	case Substance_PF_BC5:
+		return eTF_BC5U;
 	default:
 		logERROR("Unsupported substance pixel format: "<<(int)format);
 		return eTF_Unknown;
 	}
 }
 
+int GraphOutput::GetCompressedFormat() const
+{
+	int format = _instance->mDesc.mFormat;
+
+	// Keep the floating point outputs uncompressed:
+	if(format & Substance_PF_FP) {
+		return -1;
+	}
+
+	// Two channels for the normal maps:
+	if(GetChannel()==GraphOutputChannel::Normal) {
+		return Substance_PF_BC5;
+	}
+
+	switch (format & Substance_PF_MASK_RAWChannels)
+	{
+	case Substance_PF_L:
+		return Substance_PF_BC4;
+	case Substance_PF_RGBA:
+		return Substance_PF_BC3;
+	default:
+		return Substance_PF_BC1;
+	}
+}
+
 bool GraphOutput::GetEditorPreview(SGraphOutputEditorPreview& preview)
 {
-	// We grab the output here and copy it into the preview structure:
+	// We grab the output here and keep it alive while the preview structure references its buffer:
 	auto result = _instance->grabResult();
 	if(!result) {
 		logERROR("Invalid result in GetEditorPreview()");
 		return false;
 	}
+	_lastResult = std::move(result);
+	FillEditorPreview(*_lastResult, preview);
+
+	return true;
+}
 
+void GraphOutput::FillEditorPreview(const SubstanceAir::RenderResult& result, SGraphOutputEditorPreview& preview) const
+{
 	// Assign the data:
-	auto stex = result->getTexture();
+	auto stex = result.getTexture();
 	logDEBUG("MipmapCount="<< (int)stex.mipmapCount);
 	logDEBUG("Width="<< (int)stex.level0Width);
 	logDEBUG("Height="<< (int)stex.level0Height);
@@ -156,8 +266,6 @@ bool GraphOutput::GetEditorPreview(SGraphOutputEditorPreview& preview)
 	preview.Data = stex.buffer;
 	preview.Format = GetEngineFormat((int)stex.pixelFormat);
 	preview.ChannelOrder = (int)stex.channelsOrder;
-
-	return true;
 }
 
 GraphOutputChannel GraphOutput::GetChannel() const
@@ -49,18 +49,30 @@ public:
 	/// Retrieve editor preview buffer
 	virtual bool GetEditorPreview(SGraphOutputEditorPreview& preview);
 
+	/// Describe a result of this output in an editor preview, which points into its buffer.
+	void FillEditorPreview(const SubstanceAir::RenderResult& result, SGraphOutputEditorPreview& preview) const;
+
 	/// Get the associated output channel.
 	virtual GraphOutputChannel GetChannel() const;
 
 	/// Retrieve the output instance:
 	inline SubstanceAir::OutputInstance* getInstance() const { return _instance; }
 
-	/// Retrieve number of bytes per pixel:
+	/// Retrieve number of bytes per pixel (0 for block compressed formats):
 	int GetBytesPerPixel(int format) const;
 
+	/// Retrieve number of bytes per 4x4 block (0 for uncompressed formats):
+	int GetBytesPerBlock(int format) const;
+
+	/// Retrieve the size of a mipmap level:
+	size_t GetLevelSize(int format, int width, int height) const;
+
 	/// Retrieve the engine format:
 	ETEX_Format GetEngineFormat(int format) const;
 
+	/// Retrieve the block compressed format used for this output (-1 to keep it uncompressed):
+	int GetCompressedFormat() const;
+
 protected:
 	// Pointer on the parent graph instance:
 	GraphInstance* _parent;
@@ -73,6 +85,9 @@ protected:
 
 	// outputpath for this graph output:
 	AZStd::string _outputPath;
+
+	// Last result grabbed for the editor preview, which points into its buffer:
+	std::unique_ptr<SubstanceAir::RenderResult> _lastResult;
 };
 
 #endif // USE_SUBSTANCE
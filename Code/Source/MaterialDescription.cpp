@@ -0,0 +1,203 @@
+/** @file MaterialDescription.cpp
+	@brief Source File for the parsing of the procedural material and texture files
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+#include "MaterialDescription.h"
+
+#include <AzCore/XML/rapidxml.h>
+#include <cstdlib>
+#include <cstring>
+
+typedef AZ::rapidxml::xml_node<char> XmlNode;
+
+// Read an attribute like XmlNodeRef::getAttr(), returns null if it is missing:
+static const char* getAttr(const XmlNode* node, const char* key)
+{
+	const AZ::rapidxml::xml_attribute<char>* attr = node->first_attribute(key);
+	return attr ? attr->value() : nullptr;
+}
+
+static bool getAttr(const XmlNode* node, const char* key, std::string& value)
+{
+	const char* str = getAttr(node, key);
+	if(str) {
+		value = str;
+	}
+	return str != nullptr;
+}
+
+static bool getAttr(const XmlNode* node, const char* key, bool& value)
+{
+	const char* str = getAttr(node, key);
+	if(str) {
+		value = !azstricmp(str, "true") || (azstricmp(str, "false") && atoi(str) != 0);
+	}
+	return str != nullptr;
+}
+
+static bool getAttr(const XmlNode* node, const char* key, int& value)
+{
+	const char* str = getAttr(node, key);
+	if(str) {
+		value = atoi(str);
+	}
+	return str != nullptr;
+}
+
+static bool getAttr(const XmlNode* node, const char* key, unsigned int& value)
+{
+	const char* str = getAttr(node, key);
+	if(str) {
+		value = (unsigned int)strtoul(str, nullptr, 10);
+	}
+	return str != nullptr;
+}
+
+static bool getAttr(const XmlNode* node, const char* key, float& value)
+{
+	const char* str = getAttr(node, key);
+	if(str) {
+		value = (float)atof(str);
+	}
+	return str != nullptr;
+}
+
+// Parse a copy of the contents, rapidxml parses in place and needs a terminating null:
+static const XmlNode* parseRoot(AZ::rapidxml::xml_document<char>& doc, std::vector<char>& buffer, const char* xml, size_t size)
+{
+	buffer.assign(xml, xml + size);
+	buffer.push_back('\0');
+	doc.parse<0>(buffer.data());
+	return doc.first_node();
+}
+
+MaterialDescription::MaterialDescription()
+	: streaming(-1), stacked(false)
+{
+	stack.preGraph = 0;
+	stack.postGraph = 0;
+	stack.keepNonConnected = false;
+}
+
+bool MaterialDescription::parse(const char* xml, size_t size, std::string& error)
+{
+	AZ::rapidxml::xml_document<char> doc;
+	std::vector<char> buffer;
+	const XmlNode* root = parseRoot(doc, buffer, xml, size);
+	if(!root) {
+		error = "Invalid XML";
+		return false;
+	}
+
+	if(!getAttr(root, "Source", source)) {
+		error = "No Source parameter";
+		return false;
+	}
+
+	// Optional texture load mode:
+	bool streamed;
+	if(getAttr(root, "Streaming", streamed)) {
+		streaming = streamed ? 1 : 0;
+	}
+
+	for(const XmlNode* child = root->first_node(); child; child = child->next_sibling()) {
+		if(!strcmp(child->name(), "Output")) {
+			Output output;
+			if(getAttr(child, "ID", output.id)) {
+				output.enabled = true;
+				output.compressed = true;
+				output.encoding = Encoding_None;
+				getAttr(child, "Enabled", output.enabled);
+				getAttr(child, "Compressed", output.compressed);
+
+				const char* encode = getAttr(child, "Encode");
+				if(encode) {
+					if(!strcmp(encode, "BC5")) {
+						output.encoding = Encoding_BC5;
+					}
+					else if(!strcmp(encode, "BC7")) {
+						output.encoding = Encoding_BC7;
+					}
+					else if(strcmp(encode, "None")) {
+						warnings.push_back("Unsupported encoding " + std::string(encode) + " for output " + std::to_string(output.id));
+					}
+				}
+
+				outputs.push_back(output);
+			}
+		}
+		else if(!strcmp(child->name(), "Stack")) {
+			// The outputs of the source graph feed the inputs of a graph of another archive:
+			if(getAttr(child, "Source", stack.postPath)) {
+				stacked = true;
+				stack.preGraph = 0;
+				stack.postGraph = 0;
+				stack.keepNonConnected = false;
+				stack.connections.clear();
+				getAttr(child, "PreGraph", stack.preGraph);
+				getAttr(child, "PostGraph", stack.postGraph);
+				getAttr(child, "KeepNonConnected", stack.keepNonConnected);
+
+				// Explicit connections, otherwise they are made from the identifiers and channels:
+				for(const XmlNode* connection = child->first_node(); connection; connection = connection->next_sibling()) {
+					unsigned int out, in;
+					if(!strcmp(connection->name(), "Connection") && getAttr(connection, "Output", out) && getAttr(connection, "Input", in)) {
+						stack.connections.push_back(std::make_pair(out, in));
+					}
+				}
+			}
+		}
+		else if(!strcmp(child->name(), "Parameter")) {
+			Parameter parameter;
+			if(getAttr(child, "ID", parameter.id) && getAttr(child, "Type", parameter.type)) {
+				parameter.isStatic = false;
+				getAttr(child, "Static", parameter.isStatic);
+
+				// The type decides which values are used:
+				static const char* const kComponents[] = { "x", "y", "z", "w" };
+				for(int i=0; i<4; ++i) {
+					parameter.floats[i] = 0.0f;
+					parameter.ints[i] = 0;
+					getAttr(child, kComponents[i], parameter.floats[i]);
+					getAttr(child, kComponents[i], parameter.ints[i]);
+				}
+				getAttr(child, "str", parameter.str);
+
+				parameters.push_back(parameter);
+			}
+		}
+	}
+
+	return true;
+}
+
+TextureDescription::TextureDescription()
+	: outputId(0)
+{
+}
+
+bool TextureDescription::parse(const char* xml, size_t size, std::string& error)
+{
+	AZ::rapidxml::xml_document<char> doc;
+	std::vector<char> buffer;
+	const XmlNode* root = parseRoot(doc, buffer, xml, size);
+	if(!root) {
+		error = "Invalid XML";
+		return false;
+	}
+
+	if(!getAttr(root, "Material", material)) {
+		error = "No material parameter";
+		return false;
+	}
+
+	if(!getAttr(root, "OutputID", outputId)) {
+		error = "No output ID parameter";
+		return false;
+	}
+
+	return true;
+}
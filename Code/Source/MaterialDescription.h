@@ -0,0 +1,89 @@
+/** @file MaterialDescription.h
+	@brief Header for the parsing of the procedural material and texture files
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_MATERIALDESCRIPTION_H
+#define GEM_SUBSTANCE_MATERIALDESCRIPTION_H
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ Contents of a procedural material (.smtl) file.
+
+ The files are parsed with the rapidxml parser of AzCore instead of the
+ CrySystem one, so that the parsing does not need the engine and is tested on
+ every platform. The attributes are read the way XmlNodeRef::getAttr() reads
+ them, and the missing optional attributes keep their default value.
+*/
+struct MaterialDescription
+{
+	enum Encoding
+	{
+		Encoding_None,
+		Encoding_BC5,
+		Encoding_BC7
+	};
+
+	struct Output
+	{
+		unsigned int id;
+		bool enabled;
+		bool compressed;
+		Encoding encoding;
+	};
+
+	// Graph of another archive fed by the outputs of the source graph:
+	struct Stack
+	{
+		std::string postPath;			// Archive of the post graph
+		int preGraph;					// Index of the pre graph in its archive
+		int postGraph;					// Index of the post graph in its archive
+		bool keepNonConnected;			// Keep the pre graph outputs which are not connected
+		std::vector<std::pair<unsigned int, unsigned int>> connections;	// Pre output UID, post input UID
+	};
+
+	struct Parameter
+	{
+		std::string id;
+		int type;						// GraphInputType of the input
+		bool isStatic;					// Locked to its material value when the inputs are specialized
+		float floats[4];				// x, y, z, w of the float inputs
+		int ints[4];					// x, y, z, w of the integer inputs
+		std::string str;				// Value of the string inputs
+	};
+
+	MaterialDescription();
+
+	/// Parse the contents of a .smtl file, returns false with an error if it is not a material.
+	bool parse(const char* xml, size_t size, std::string& error);
+
+	std::string source;					// Path of the substance archive
+	int streaming;						// Texture load mode, -1 if not set
+	bool stacked;
+	Stack stack;
+	std::vector<Output> outputs;
+	std::vector<Parameter> parameters;
+	std::vector<std::string> warnings;	// Invalid optional attributes
+};
+
+/**
+ Contents of a procedural texture (.sub) file, the output of a material.
+*/
+struct TextureDescription
+{
+	TextureDescription();
+
+	/// Parse the contents of a .sub file, returns false with an error if it is not a texture.
+	bool parse(const char* xml, size_t size, std::string& error);
+
+	std::string material;				// Path of the material
+	unsigned int outputId;
+};
+
+#endif //GEM_SUBSTANCE_MATERIALDESCRIPTION_H
@@ -0,0 +1,281 @@
+/** @file MaterialRegistry.cpp
+	@brief Source File for the registry of live substance materials
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "MaterialRegistry.h"
+#include "SubstanceMaterial.h"
+#include "PackageCache.h"
+#include "GlobalCallbacks.h"
+#include <algorithm>
+
+MaterialRegistry& MaterialRegistry::instance()
+{
+	static MaterialRegistry registry;
+	return registry;
+}
+
+MaterialRegistry::MaterialRegistry() : _lastID(INVALID_PROCEDURALMATERIALID),
+	_hits(0), _misses(0), _evictions(0)
+{
+}
+
+MaterialRegistry::~MaterialRegistry()
+{
+	// Nothing to do here: the idle materials are purged by the gem at shutdown,
+	// before the renderer is destroyed.
+}
+
+GraphInstanceID MaterialRegistry::encodeGraphInstanceID(ProceduralMaterialID materialID, int graphIndex)
+{
+	if(materialID == INVALID_PROCEDURALMATERIALID) {
+		return INVALID_GRAPHINSTANCEID;
+	}
+	return ((GraphInstanceID)materialID << 16) | (GraphInstanceID)(graphIndex & 0xFFFF);
+}
+
+ProceduralMaterialID MaterialRegistry::getMaterialID(GraphInstanceID graphInstanceID)
+{
+	return (ProceduralMaterialID)(graphInstanceID >> 16);
+}
+
+int MaterialRegistry::getGraphIndex(GraphInstanceID graphInstanceID)
+{
+	return (int)(graphInstanceID & 0xFFFF);
+}
+
+ProceduralMaterialID MaterialRegistry::allocateID()
+{
+	// Find the next available ID, skipping the invalid one:
+	do {
+		_lastID++;
+	} while(_lastID == INVALID_PROCEDURALMATERIALID || _entries.count(_lastID)>0);
+
+	return _lastID;
+}
+
+SubstanceMaterial* MaterialRegistry::acquire(const char* smtlPath, bool bForceLoad)
+{
+	AZStd::string key = PackageCache::normalizePath(smtlPath);
+
+	_lock.Lock();
+
+	// Wait until the material is loaded if another thread is loading it:
+	auto pit = _paths.find(key);
+	while(pit != _paths.end() && !_entries[pit->second].material) {
+		_loaded.Wait(_lock);
+		pit = _paths.find(key);
+	}
+
+	if(pit != _paths.end()) {
+		ProceduralMaterialID id = pit->second;
+		Entry& entry = _entries[id];
+
+		if(!bForceLoad) {
+			_hits++;
+			if(entry.refCount++ == 0) {
+				_idle.remove(id);
+			}
+			SubstanceMaterial* material = entry.material;
+			_lock.Unlock();
+			return material;
+		}
+
+		// Detach the current instance: it will be destroyed when released.
+		_paths.erase(pit);
+		entry.detached = true;
+		if(entry.refCount == 0) {
+			_idle.remove(id);
+			delete entry.material;
+			_entries.erase(id);
+		}
+	}
+
+	// Reserve the entry of a new material, the requesters of the same path wait for it:
+	_misses++;
+	ProceduralMaterialID id = allocateID();
+	logDEBUG("MaterialRegistry: loading material "<<smtlPath<<" with ID "<<id);
+
+	Entry& entry = _entries[id];
+	entry.material = nullptr;
+	entry.key = key;
+	entry.refCount = 1;
+	entry.detached = false;
+	_paths[key] = id;
+	_lock.Unlock();
+
+	// Read the smtl file and link its package without blocking the registry:
+	SubstanceMaterial* material;
+	{
+		// The framework objects of the material are attributed to it in the memory pool, its shared packages to their archive:
+		SubstanceGlobalCallbacks::OwnerScope owner(smtlPath);
+		material = new SubstanceMaterial(smtlPath, id);
+	}
+
+	CryAutoCriticalSection lock(_lock);
+	_entries[id].material = material;
+	_loaded.Notify();
+
+	return material;
+}
+
+void MaterialRegistry::addRef(SubstanceMaterial* mat)
+{
+	CryAutoCriticalSection lock(_lock);
+
+	auto it = _entries.find(mat->getMaterialID());
+	if(it == _entries.end()) {
+		logERROR("MaterialRegistry: trying to add a reference on an unregistered material.");
+		return;
+	}
+
+	if(it->second.refCount++ == 0) {
+		_idle.remove(it->first);
+	}
+}
+
+void MaterialRegistry::release(SubstanceMaterial* mat)
+{
+	CryAutoCriticalSection lock(_lock);
+
+	auto it = _entries.find(mat->getMaterialID());
+	if(it == _entries.end() || it->second.refCount <= 0) {
+		logERROR("MaterialRegistry: trying to release an unreferenced material.");
+		return;
+	}
+
+	if(--it->second.refCount > 0) {
+		return;
+	}
+
+	if(it->second.detached) {
+		// This instance was replaced by a forced reload:
+		delete it->second.material;
+		_entries.erase(it);
+		return;
+	}
+
+	// Keep the material around for a while:
+	_idle.push_front(it->first);
+	evictIdleMaterials((unsigned int)std::max(substance_materialCacheSize, 0));
+}
+
+void MaterialRegistry::evictIdleMaterials(unsigned int maxIdle)
+{
+	while(_idle.size() > maxIdle) {
+		ProceduralMaterialID id = _idle.back();
+		_idle.pop_back();
+
+		auto it = _entries.find(id);
+		logDEBUG("MaterialRegistry: evicting idle material "<<it->second.key.c_str());
+		_paths.erase(it->second.key);
+		delete it->second.material;
+		_entries.erase(it);
+		_evictions++;
+	}
+}
+
+IGraphInstance* MaterialRegistry::getGraphInstance(GraphInstanceID graphInstanceID)
+{
+	CryAutoCriticalSection lock(_lock);
+
+	auto it = _entries.find(getMaterialID(graphInstanceID));
+	if(it == _entries.end()) {
+		return nullptr;
+	}
+
+	SubstanceMaterial* mat = it->second.material;
+	int index = getGraphIndex(graphInstanceID);
+	if(!mat || index >= mat->GetGraphInstanceCount()) {
+		return nullptr;
+	}
+
+	return mat->GetGraphInstance(index);
+}
+
+void MaterialRegistry::purge()
+{
+	CryAutoCriticalSection lock(_lock);
+	evictIdleMaterials(0);
+}
+
+void MaterialRegistry::getStats(Stats& stats) const
+{
+	CryAutoCriticalSection lock(_lock);
+
+	stats.hits = _hits;
+	stats.misses = _misses;
+	stats.evictions = _evictions;
+	stats.materials = (unsigned int)_entries.size();
+	stats.idleMaterials = (unsigned int)_idle.size();
+}
+
+void MaterialRegistry::dumpStats() const
+{
+	Stats stats;
+	getStats(stats);
+
+	CryLogAlways("Substance material registry: %u materials (%u idle), %u hits, %u misses, %u evictions",
+		stats.materials, stats.idleMaterials, stats.hits, stats.misses, stats.evictions);
+}
+
+void MaterialRegistry::dumpMaterialStats(bool sortByTime, int maxCount) const
+{
+	struct MaterialStats
+	{
+		AZStd::string path;
+		SubstanceMaterial::Stats stats;
+		int refCount;
+		size_t bytes;
+	};
+
+	std::vector<MaterialStats> materials;
+	{
+		CryAutoCriticalSection lock(_lock);
+		for(auto& it: _entries) {
+			if(!it.second.material) {
+				continue;
+			}
+			MaterialStats mat;
+			mat.path = it.second.material->GetPath();
+			it.second.material->getStats(mat.stats);
+			mat.refCount = it.second.refCount;
+			mat.bytes = mat.stats.packageBytes + mat.stats.instanceBytes + mat.stats.resultBytes;
+			materials.push_back(mat);
+		}
+	}
+
+	std::sort(materials.begin(), materials.end(), [sortByTime](const MaterialStats& a, const MaterialStats& b) {
+		return sortByTime ? a.stats.renderMs > b.stats.renderMs : a.bytes > b.bytes;
+	});
+
+	const float mb = 1024.0f*1024.0f;
+	CryLogAlways("Substance materials by %s: %u materials, the packages are shared by the materials using the same archives",
+		sortByTime ? "render time" : "memory", (unsigned int)materials.size());
+	CryLogAlways("     Total  Package Instance  Results   Render ms  Renders  Outputs Refs Material");
+	for(size_t i=0; i<materials.size() && (maxCount <= 0 || (int)i < maxCount); ++i) {
+		const MaterialStats& mat = materials[i];
+		CryLogAlways("%7.2f MB %8.2f %8.2f %8.2f %11.1f %8u %8u %4d %s",
+			mat.bytes/mb, mat.stats.packageBytes/mb, mat.stats.instanceBytes/mb, mat.stats.resultBytes/mb,
+			mat.stats.renderMs, mat.stats.renders, mat.stats.outputs, mat.refCount, mat.path.c_str());
+	}
+}
+
+void MaterialRegistry::GetMemoryUsage(ICrySizer* s) const
+{
+	CryAutoCriticalSection lock(_lock);
+	s->AddObject(this, sizeof(*this));
+	for(auto& it: _entries) {
+		if(!it.second.material) {
+			continue;
+		}
+		SIZER_COMPONENT_NAME(s, it.second.material->GetPath());
+		it.second.material->GetMemoryUsage(s);
+	}
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,121 @@
+/** @file MaterialRegistry.h
+	@brief Header for the registry of live substance materials
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_MATERIALREGISTRY_H
+#define GEM_SUBSTANCE_MATERIALREGISTRY_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include <CryThread.h>
+#include <list>
+
+#if defined(USE_SUBSTANCE)
+
+class SubstanceMaterial;
+
+/**
+ Registry of the live substance materials.
+
+ Materials are keyed by normalized .smtl path so that the flow nodes, the
+ editor and the texture loader all share a single instance per material.
+ A material is loaded outside the registry lock: its entry is reserved first,
+ and the other requesters of the same path wait until it is loaded.
+ Materials are reference counted: when a material is not referenced anymore
+ it is kept in a LRU list of idle materials, and the least recently used
+ idle materials are destroyed when that list grows above
+ substance_materialCacheSize.
+*/
+class MaterialRegistry
+{
+public:
+	struct Stats
+	{
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int evictions;
+		unsigned int materials;
+		unsigned int idleMaterials;
+	};
+
+	static MaterialRegistry& instance();
+
+	/// Retrieve the material for a given smtl path, loading it if needed.
+	/// If bForceLoad is true a new instance is always loaded from disk and replaces
+	/// the registered one (which stays alive until it is released).
+	/// The returned material has a reference added and must be released by the caller.
+	SubstanceMaterial* acquire(const char* smtlPath, bool bForceLoad);
+
+	/// Add a reference on a registered material.
+	void addRef(SubstanceMaterial* mat);
+
+	/// Release a reference on a registered material.
+	void release(SubstanceMaterial* mat);
+
+	/// Retrieve a graph instance from its encoded ID, or nullptr if the material is not alive anymore.
+	IGraphInstance* getGraphInstance(GraphInstanceID graphInstanceID);
+
+	/// Destroy all the idle materials.
+	void purge();
+
+	/// Retrieve the registry counters.
+	void getStats(Stats& stats) const;
+
+	/// Write the registry counters in the log.
+	void dumpStats() const;
+
+	/// Write the memory and render time accounting of the live materials in the log,
+	/// most expensive first by memory or by render time.
+	void dumpMaterialStats(bool sortByTime, int maxCount) const;
+
+	/// Add the live materials to a sizer.
+	void GetMemoryUsage(ICrySizer* s) const;
+
+	/// Helpers used to encode/decode a material ID and graph index in a GraphInstanceID.
+	static GraphInstanceID encodeGraphInstanceID(ProceduralMaterialID materialID, int graphIndex);
+	static ProceduralMaterialID getMaterialID(GraphInstanceID graphInstanceID);
+	static int getGraphIndex(GraphInstanceID graphInstanceID);
+
+protected:
+	MaterialRegistry();
+	~MaterialRegistry();
+
+	// Destroy the idle materials above the cache size limit:
+	void evictIdleMaterials(unsigned int maxIdle);
+
+	// Allocate a new material ID:
+	ProceduralMaterialID allocateID();
+
+	struct Entry
+	{
+		SubstanceMaterial* material;	// nullptr while loading
+		AZStd::string key;
+		int refCount;
+		bool detached;
+	};
+
+	typedef std::map<ProceduralMaterialID, Entry> EntryMap;
+	EntryMap _entries;
+
+	typedef std::map<AZStd::string, ProceduralMaterialID> PathMap;
+	PathMap _paths;
+
+	// Idle materials, most recently released first:
+	typedef std::list<ProceduralMaterialID> IdleList;
+	IdleList _idle;
+
+	ProceduralMaterialID _lastID;
+
+	unsigned int _hits;
+	unsigned int _misses;
+	unsigned int _evictions;
+
+	mutable CryCriticalSection _lock;
+	CryConditionVariable _loaded;		// Signaled when a material is loaded
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_MATERIALREGISTRY_H
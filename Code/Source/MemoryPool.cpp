@@ -0,0 +1,336 @@
+/** @file MemoryPool.cpp
+	@brief Source File for the size class pool of the substance allocations
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include "MemoryPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Alignment of the blocks returned by new[] on the supported 64 bit platforms:
+static const size_t kArrayAlignment = 16;
+
+// Size of the slabs of the small size classes:
+static const size_t kSlabSize = 64*1024;
+
+// Size class steps per power of two for the large blocks, which bounds their rounding to 25%:
+static const size_t kLargeClassSteps = 4;
+
+MemoryPool::MemoryPool(size_t budget) : _budget(budget)
+{
+	memset(&_stats, 0, sizeof(_stats));
+	_freeChunks.resize(kSmallMaxSize/kArrayAlignment);
+}
+
+MemoryPool::~MemoryPool()
+{
+	trim();
+	for(auto& it: _blocks) {
+		delete [] it.second.memory;
+	}
+	for(auto& it: _slabs) {
+		delete [] it.first;
+	}
+}
+
+size_t MemoryPool::getSizeClass(size_t bytesCount)
+{
+	if(bytesCount <= kSmallMaxSize) {
+		return std::max((bytesCount + kArrayAlignment - 1) & ~(kArrayAlignment - 1), kArrayAlignment);
+	}
+
+	size_t high = 1;
+	while(high <= bytesCount/2) {
+		high <<= 1;
+	}
+	size_t step = high/kLargeClassSteps;
+	return (bytesCount + step - 1)/step*step;
+}
+
+void MemoryPool::setBudget(size_t budget)
+{
+	CryAutoCriticalSection lock(_lock);
+	if(_budget != budget) {
+		_budget = budget;
+		fitBudget(0);
+	}
+}
+
+void* MemoryPool::allocate(size_t bytesCount, size_t alignment, unsigned int owner)
+{
+	CryAutoCriticalSection lock(_lock);
+	_stats.allocations++;
+
+	if(bytesCount <= kSmallMaxSize && alignment <= kArrayAlignment) {
+		return allocateSmall(bytesCount, owner);
+	}
+	return allocateLarge(bytesCount, alignment, owner);
+}
+
+void* MemoryPool::allocateSmall(size_t bytesCount, unsigned int owner)
+{
+	size_t classSize = getSizeClass(bytesCount);
+	std::vector<unsigned char*>& freeChunks = _freeChunks[classSize/kArrayAlignment - 1];
+
+	if(freeChunks.empty()) {
+		// Carve a new slab of this class:
+		unsigned char* slab = new unsigned char[kSlabSize];
+		size_t count = kSlabSize/classSize;
+		Slab& info = _slabs[slab];
+		info.classSize = classSize;
+		info.freeCount = count;
+		_stats.slabs++;
+		_stats.slabBytes += kSlabSize;
+
+		for(size_t i=count; i>0; --i) {
+			freeChunks.push_back(slab + (i - 1)*classSize);
+		}
+		_stats.slabFreeBytes += count*classSize;
+	}
+	else {
+		_stats.reuses++;
+	}
+
+	unsigned char* chunk = freeChunks.back();
+	freeChunks.pop_back();
+	getSlab(chunk).freeCount--;
+	_stats.slabFreeBytes -= classSize;
+
+	Chunk& info = _chunks[chunk];
+	info.bytesCount = bytesCount;
+	info.owner = owner;
+	addLive(classSize, bytesCount, owner);
+	return chunk;
+}
+
+void* MemoryPool::allocateLarge(size_t bytesCount, size_t alignment, unsigned int owner)
+{
+	size_t classSize = getSizeClass(bytesCount);
+	alignment = std::max(alignment, kArrayAlignment);
+
+	Block block;
+	block.classSize = classSize;
+	block.alignment = alignment;
+	block.bytesCount = bytesCount;
+	block.owner = owner;
+
+	unsigned char* buffer = nullptr;
+	auto cit = _cachedBlocks.find(std::make_pair(classSize, alignment));
+	if(cit != _cachedBlocks.end() && !cit->second.empty()) {
+		block.memory = cit->second.back().first;
+		buffer = cit->second.back().second;
+		cit->second.pop_back();
+		_stats.cachedBytes -= classSize;
+		_stats.reuses++;
+	}
+	else {
+		fitBudget(classSize);
+
+		block.memory = new unsigned char[classSize];
+		buffer = block.memory;
+		if(((size_t)buffer & (alignment - 1)) != 0) {
+			// Over allocate, this block cannot be released with delete[] by another owner:
+			delete [] block.memory;
+			block.memory = new unsigned char[classSize + alignment];
+			buffer = (unsigned char*)(((size_t)block.memory + alignment - 1) & ~(alignment - 1));
+		}
+	}
+
+	if(_budget > 0 && _stats.liveBytes + classSize > _budget) {
+		_stats.overruns++;
+	}
+
+	_blocks[buffer] = block;
+	addLive(classSize, bytesCount, owner);
+	return buffer;
+}
+
+bool MemoryPool::release(void* buffer)
+{
+	CryAutoCriticalSection lock(_lock);
+
+	auto cit = _chunks.find(buffer);
+	if(cit != _chunks.end()) {
+		size_t classSize = getSizeClass(cit->second.bytesCount);
+		removeLive(classSize, cit->second.bytesCount, cit->second.owner);
+		_freeChunks[classSize/kArrayAlignment - 1].push_back((unsigned char*)buffer);
+		getSlab((unsigned char*)buffer).freeCount++;
+		_stats.slabFreeBytes += classSize;
+		_chunks.erase(cit);
+		return true;
+	}
+
+	auto bit = _blocks.find(buffer);
+	if(bit == _blocks.end()) {
+		return false;
+	}
+
+	const Block& block = bit->second;
+	removeLive(block.classSize, block.bytesCount, block.owner);
+
+	// Keep the block for the next allocation of its class while the budget allows it:
+	if(_budget > 0 && _stats.liveBytes + _stats.cachedBytes + block.classSize <= _budget) {
+		_cachedBlocks[std::make_pair(block.classSize, block.alignment)].push_back(CachedBlock(block.memory, (unsigned char*)buffer));
+		_stats.cachedBytes += block.classSize;
+	}
+	else {
+		delete [] block.memory;
+	}
+
+	_blocks.erase(bit);
+	return true;
+}
+
+bool MemoryPool::contains(const void* buffer) const
+{
+	CryAutoCriticalSection lock(_lock);
+	return _chunks.count(buffer) > 0 || _blocks.count(buffer) > 0;
+}
+
+bool MemoryPool::isArrayAllocated(const void* buffer) const
+{
+	CryAutoCriticalSection lock(_lock);
+	auto bit = _blocks.find(buffer);
+	return bit != _blocks.end() && bit->second.memory == buffer;
+}
+
+void MemoryPool::detach(const void* buffer)
+{
+	CryAutoCriticalSection lock(_lock);
+	auto bit = _blocks.find(buffer);
+	if(bit != _blocks.end()) {
+		removeLive(bit->second.classSize, bit->second.bytesCount, bit->second.owner);
+		_blocks.erase(bit);
+	}
+}
+
+void MemoryPool::setOwner(const void* buffer, unsigned int owner)
+{
+	CryAutoCriticalSection lock(_lock);
+
+	auto cit = _chunks.find(buffer);
+	if(cit != _chunks.end()) {
+		size_t classSize = getSizeClass(cit->second.bytesCount);
+		_ownerBytes[cit->second.owner] -= classSize;
+		_ownerBytes[owner] += classSize;
+		cit->second.owner = owner;
+		return;
+	}
+
+	auto bit = _blocks.find(buffer);
+	if(bit != _blocks.end()) {
+		_ownerBytes[bit->second.owner] -= bit->second.classSize;
+		_ownerBytes[owner] += bit->second.classSize;
+		bit->second.owner = owner;
+	}
+}
+
+void MemoryPool::trim()
+{
+	CryAutoCriticalSection lock(_lock);
+	for(auto& it: _cachedBlocks) {
+		for(auto& cached: it.second) {
+			delete [] cached.first;
+		}
+	}
+	_cachedBlocks.clear();
+	_stats.cachedBytes = 0;
+
+	releaseFreeSlabs();
+}
+
+MemoryPool::Slab& MemoryPool::getSlab(const unsigned char* chunk)
+{
+	// The slab starts at the highest address below the chunk:
+	auto it = _slabs.upper_bound((unsigned char*)chunk);
+	return std::prev(it)->second;
+}
+
+void MemoryPool::releaseFreeSlabs()
+{
+	std::vector<bool> classes(_freeChunks.size(), false);
+	bool released = false;
+	for(auto& it: _slabs) {
+		if(it.second.freeCount == kSlabSize/it.second.classSize) {
+			classes[it.second.classSize/kArrayAlignment - 1] = true;
+			released = true;
+		}
+	}
+	if(!released) {
+		return;
+	}
+
+	// Drop the chunks of the free slabs from the free lists:
+	for(size_t c=0; c<classes.size(); ++c) {
+		if(classes[c]) {
+			std::vector<unsigned char*>& freeChunks = _freeChunks[c];
+			freeChunks.erase(std::remove_if(freeChunks.begin(), freeChunks.end(), [this](const unsigned char* chunk) {
+				const Slab& slab = getSlab(chunk);
+				return slab.freeCount == kSlabSize/slab.classSize;
+			}), freeChunks.end());
+		}
+	}
+
+	for(auto it = _slabs.begin(); it != _slabs.end();) {
+		size_t count = kSlabSize/it->second.classSize;
+		if(it->second.freeCount == count) {
+			delete [] it->first;
+			_stats.slabs--;
+			_stats.slabBytes -= kSlabSize;
+			_stats.slabFreeBytes -= count*it->second.classSize;
+			_stats.releasedSlabs++;
+			it = _slabs.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void MemoryPool::fitBudget(size_t classSize)
+{
+	if(_budget == 0) {
+		return;
+	}
+
+	// Release the largest cached blocks first:
+	for(auto it = _cachedBlocks.rbegin(); it != _cachedBlocks.rend() && _stats.liveBytes + _stats.cachedBytes + classSize > _budget; ++it) {
+		while(!it->second.empty() && _stats.liveBytes + _stats.cachedBytes + classSize > _budget) {
+			delete [] it->second.back().first;
+			it->second.pop_back();
+			_stats.cachedBytes -= it->first.first;
+			_stats.trims++;
+		}
+	}
+}
+
+void MemoryPool::addLive(size_t classSize, size_t bytesCount, unsigned int owner)
+{
+	_stats.liveBytes += classSize;
+	_stats.requestedBytes += bytesCount;
+	_stats.peakLiveBytes = std::max(_stats.peakLiveBytes, _stats.liveBytes);
+	_ownerBytes[owner] += classSize;
+}
+
+void MemoryPool::removeLive(size_t classSize, size_t bytesCount, unsigned int owner)
+{
+	_stats.liveBytes -= classSize;
+	_stats.requestedBytes -= bytesCount;
+	_ownerBytes[owner] -= classSize;
+}
+
+MemoryPool::Stats MemoryPool::getStats() const
+{
+	CryAutoCriticalSection lock(_lock);
+	return _stats;
+}
+
+std::map<unsigned int, size_t> MemoryPool::getOwnerBytes() const
+{
+	CryAutoCriticalSection lock(_lock);
+	return _ownerBytes;
+}
@@ -0,0 +1,151 @@
+/** @file MemoryPool.h
+	@brief Header for the size class pool of the substance allocations
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_MEMORYPOOL_H
+#define GEM_SUBSTANCE_MEMORYPOOL_H
+#pragma once
+
+#include <CryThread.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+/**
+ Size class pool of the substance framework and engine allocations.
+
+ The small framework objects are carved from slabs dedicated to a size class,
+ and recycled through the free list of their class. The large blocks, mostly
+ pixel buffers of similar sizes, are rounded up to a size class and kept on
+ the free list of their class when they are released, so that the next
+ buffer of this class reuses them instead of going through the heap.
+
+ Each large block is allocated with new[], so that a result buffer can still
+ be handed over to the engine texture loader: it must then be detached from
+ the pool, which stops tracking it.
+
+ trim() releases the cached blocks and the slabs whose chunks are all free,
+ so that the memory of a level goes back to the heap once it is unloaded.
+
+ The live bytes are tracked per owner. The budget caps the live and cached
+ bytes: the cached blocks are released first when it is reached, and the
+ allocations above it are counted as overruns, since the engine cannot
+ handle a failed allocation.
+*/
+class MemoryPool
+{
+public:
+	/// Largest size served by the slabs.
+	static const size_t kSmallMaxSize = 1024;
+
+	struct Stats
+	{
+		size_t liveBytes;				// Bytes of the live blocks, including their size class rounding
+		size_t peakLiveBytes;
+		size_t requestedBytes;			// Bytes requested for the live blocks
+		size_t cachedBytes;				// Bytes of the released large blocks kept for reuse
+		size_t slabBytes;				// Bytes of the slabs
+		size_t slabFreeBytes;			// Bytes of the slab chunks on the free lists
+		unsigned int allocations;
+		unsigned int reuses;			// Allocations served from a free list
+		unsigned int overruns;			// Allocations above the budget
+		unsigned int trims;				// Cached blocks released for the budget
+		unsigned int slabs;
+		unsigned int releasedSlabs;		// Free slabs released by trim()
+	};
+
+	/// Create a pool capping its live and cached bytes to budget (0 = No cap, no cached blocks).
+	explicit MemoryPool(size_t budget = 0);
+
+	/// Release all the blocks, the live blocks must not be used anymore.
+	~MemoryPool();
+
+	/// Set the cap of the live and cached bytes, releasing the cached blocks above it.
+	void setBudget(size_t budget);
+
+	/// Allocate a block for a given owner.
+	void* allocate(size_t bytesCount, size_t alignment, unsigned int owner = 0);
+
+	/// Release a block, returns false if it was not allocated by the pool.
+	bool release(void* buffer);
+
+	/// Check if a block is tracked by the pool.
+	bool contains(const void* buffer) const;
+
+	/// Check if a block can be released with delete[] once detached.
+	bool isArrayAllocated(const void* buffer) const;
+
+	/// Stop tracking a large block released with delete[] by its new owner.
+	void detach(const void* buffer);
+
+	/// Attribute a live block to another owner.
+	void setOwner(const void* buffer, unsigned int owner);
+
+	/// Release all the cached blocks and the free slabs.
+	void trim();
+
+	/// Retrieve the counters.
+	Stats getStats() const;
+
+	/// Retrieve the live bytes of each owner.
+	std::map<unsigned int, size_t> getOwnerBytes() const;
+
+	/// Retrieve the size class of an allocation.
+	static size_t getSizeClass(size_t bytesCount);
+
+protected:
+	struct Block
+	{
+		unsigned char* memory;			// Allocated with new[], differs from the block address when over aligned
+		size_t classSize;
+		size_t alignment;
+		size_t bytesCount;
+		unsigned int owner;
+	};
+
+	struct Chunk
+	{
+		size_t bytesCount;
+		unsigned int owner;
+	};
+
+	struct Slab
+	{
+		size_t classSize;
+		size_t freeCount;				// Chunks on the free list of the class
+	};
+
+	typedef std::pair<unsigned char*, unsigned char*> CachedBlock;	// Allocated memory, block address
+
+	void* allocateSmall(size_t bytesCount, unsigned int owner);
+	void* allocateLarge(size_t bytesCount, size_t alignment, unsigned int owner);
+	void fitBudget(size_t classSize);
+	void addLive(size_t classSize, size_t bytesCount, unsigned int owner);
+	void removeLive(size_t classSize, size_t bytesCount, unsigned int owner);
+
+	// Retrieve the slab of a chunk:
+	Slab& getSlab(const unsigned char* chunk);
+
+	// Release the slabs whose chunks are all free:
+	void releaseFreeSlabs();
+
+	// Slabs indexed by address, live chunks indexed by address, and free chunks of each small size class:
+	std::map<unsigned char*, Slab> _slabs;
+	std::unordered_map<const void*, Chunk> _chunks;
+	std::vector<std::vector<unsigned char*>> _freeChunks;
+
+	// Live large blocks indexed by address, and cached blocks of each size class and alignment:
+	std::unordered_map<const void*, Block> _blocks;
+	std::map<std::pair<size_t, size_t>, std::vector<CachedBlock>> _cachedBlocks;
+
+	std::map<unsigned int, size_t> _ownerBytes;
+
+	size_t _budget;
+	Stats _stats;
+
+	mutable CryCriticalSection _lock;
+};
+
+#endif //GEM_SUBSTANCE_MEMORYPOOL_H
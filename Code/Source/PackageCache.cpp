@@ -0,0 +1,389 @@
+/** @file PackageCache.cpp
+	@brief Source File for the shared substance package cache
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "PackageCache.h"
+#include "GlobalCallbacks.h"
+#include <ICryPak.h>
+#include <algorithm>
+#include <Substance/framework/stacking.h>
+
+PackageCache& PackageCache::instance()
+{
+	static PackageCache cache;
+	return cache;
+}
+
+PackageCache::PackageCache() : _hits(0), _misses(0), _invalidations(0)
+{
+}
+
+AZ::u64 PackageCache::hashData(const void* data, size_t size, AZ::u64 seed)
+{
+	const unsigned char* ptr = (const unsigned char*)data;
+	AZ::u64 hash = seed;
+	for(size_t i=0; i<size; ++i) {
+		hash ^= ptr[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+AZStd::string PackageCache::normalizePath(const char* path)
+{
+	AZStd::string key(path ? path : "");
+	for(auto& c: key) {
+		c = c=='\\' ? '/' : (char)tolower(c);
+	}
+	return key;
+}
+
+PackageDescPtr PackageCache::acquire(const char* sbsarPath, AZ::u64* contentHash)
+{
+	AZStd::string key = normalizePath(sbsarPath);
+
+	CCryFile sbsarFile(sbsarPath, "rb");
+	if (!sbsarFile.GetHandle())
+	{
+		CryLogAlways("ERROR: PackageCache: Unable to open substance archive (%s)", sbsarPath);
+		return PackageDescPtr();
+	}
+
+	size_t dataSize = sbsarFile.GetLength();
+	AZ::u64 modTime = gEnv->pCryPak->GetModificationTime(sbsarFile.GetHandle());
+
+	CryAutoCriticalSection lock(_lock);
+
+	auto it = _entries.find(key);
+	if(it != _entries.end() && it->second.modTime == modTime && it->second.archiveSize == dataSize) {
+		// Archive untouched since we parsed it:
+		_hits++;
+		if(contentHash) {
+			*contentHash = it->second.contentHash;
+		}
+		return it->second.package;
+	}
+
+	//read archive data
+	std::vector<byte> data(dataSize);
+	if(sbsarFile.ReadRaw(data.data(), dataSize) != dataSize) {
+		CryLogAlways("ERROR: PackageCache: Failed to read substance archive (%s)", sbsarPath);
+		return PackageDescPtr();
+	}
+
+	AZ::u64 hash = hashData(data.data(), dataSize);
+	if(contentHash) {
+		*contentHash = hash;
+	}
+
+	if(it != _entries.end()) {
+		if(it->second.contentHash == hash) {
+			// File was touched but the content is the same:
+			_hits++;
+			it->second.modTime = modTime;
+			return it->second.package;
+		}
+
+		// The archive changed on disk: materials still using the previous
+		// package keep it alive until they are released.
+		logDEBUG("PackageCache: archive "<<sbsarPath<<" changed on disk, reloading.");
+		_invalidations++;
+		_entries.erase(it);
+	}
+
+	// parse the package, shared by the materials so attributed to its archive in the memory pool:
+	_misses++;
+	PackageDescPtr package;
+	try {
+		SubstanceGlobalCallbacks::OwnerScope owner(key.c_str());
+		package = PackageDescPtr(new SubstanceAir::PackageDesc(data.data(), dataSize));
+	}
+	catch(...) {
+		CryLogAlways("ERROR: PackageCache: Exception occured when parsing substance archive (%s)", sbsarPath);
+		return PackageDescPtr();
+	}
+
+	if(!package->isValid()) {
+		CryLogAlways("ERROR: PackageCache: Package read from %s is invalid.", sbsarPath);
+		return package;
+	}
+
+	Entry& entry = _entries[key];
+	entry.package = package;
+	entry.contentHash = hash;
+	entry.modTime = modTime;
+	entry.archiveSize = dataSize;
+
+	return package;
+}
+
+PackageDescPtr PackageCache::acquireSelected(const char* sbsarPath, const std::vector<unsigned int>& outputUids, AZ::u64* contentHash)
+{
+	AZ::u64 hash;
+	PackageDescPtr package = acquire(sbsarPath, &hash);
+	if(contentHash) {
+		*contentHash = hash;
+	}
+	if(!package || !package->isValid() || !package->getAssemblyData()) {
+		return package;
+	}
+
+	std::vector<unsigned int> uids(outputUids);
+	std::sort(uids.begin(), uids.end());
+	uids.erase(std::unique(uids.begin(), uids.end()), uids.end());
+	AZStd::string key = normalizePath(sbsarPath) + string_format("#%llx", (unsigned long long)hashData(uids.data(), uids.size()*sizeof(unsigned int))).c_str();
+
+	CryAutoCriticalSection lock(_lock);
+
+	auto it = _selections.find(key);
+	if(it != _selections.end()) {
+		if(it->second.contentHash == hash) {
+			return it->second.package ? it->second.package : package;
+		}
+
+		// Relinked from a previous version of the archive:
+		_selections.erase(it);
+	}
+
+	Selection& selection = _selections[key];
+	selection.contentHash = hash;
+	selection.prunedOutputs = 0;
+
+	AZStd::string xml;
+	unsigned int pruned = selectOutputs(package->getXmlString().c_str(), uids, xml);
+	if(pruned == 0) {
+		// All the outputs are used, the full package is shared:
+		return package;
+	}
+
+	PackageDescPtr selected;
+	try {
+		SubstanceGlobalCallbacks::OwnerScope owner(key.c_str());
+		const SubstanceAir::string* assembly = package->getAssemblyData();
+		selected = PackageDescPtr(new SubstanceAir::PackageDesc(assembly->data(), assembly->size(), xml.c_str()));
+	}
+	catch(...) {
+		selected.reset();
+	}
+
+	if(!selected || !selected->isValid()) {
+		CryLogAlways("ERROR: PackageCache: Cannot relink substance archive (%s) with %d outputs, using all the outputs.", sbsarPath, (int)uids.size());
+		return package;
+	}
+
+	logDEBUG("PackageCache: relinked "<<sbsarPath<<" without "<<pruned<<" unused outputs.");
+	selection.package = selected;
+	selection.prunedOutputs = pruned;
+	return selected;
+}
+
+PackageDescPtr PackageCache::acquireStack(const char* sbsarPath, const StackSettings& stack, AZ::u64* contentHash)
+{
+	AZ::u64 preHash = 0;
+	AZ::u64 postHash = 0;
+	PackageDescPtr pre = acquire(sbsarPath, &preHash);
+	PackageDescPtr post = acquire(stack.postPath.c_str(), &postHash);
+	if(!pre || !pre->isValid() || !post || !post->isValid()) {
+		return PackageDescPtr();
+	}
+
+	if(stack.preGraph < 0 || stack.preGraph >= (int)pre->getGraphs().size() || stack.postGraph < 0 || stack.postGraph >= (int)post->getGraphs().size()) {
+		CryLogAlways("ERROR: PackageCache: Invalid graph indices %d and %d to stack %s with %s", stack.preGraph, stack.postGraph, sbsarPath, stack.postPath.c_str());
+		return PackageDescPtr();
+	}
+
+	// The stack changes with the archives and the settings:
+	int settings[3] = { stack.preGraph, stack.postGraph, stack.keepNonConnected ? 1 : 0 };
+	AZ::u64 hash = hashData(&postHash, sizeof(postHash), preHash);
+	hash = hashData(settings, sizeof(settings), hash);
+	if(!stack.connections.empty()) {
+		hash = hashData(stack.connections.data(), stack.connections.size()*sizeof(stack.connections[0]), hash);
+	}
+	if(contentHash) {
+		*contentHash = hash;
+	}
+
+	AZStd::string key = normalizePath(sbsarPath) + "|" + normalizePath(stack.postPath.c_str()) + string_format("#%llx", (unsigned long long)hash).c_str();
+
+	CryAutoCriticalSection lock(_lock);
+
+	auto it = _stacks.find(key);
+	if(it != _stacks.end()) {
+		return it->second.package;
+	}
+
+	SubstanceAir::ConnectionsOptions options;
+	options.mNonConnected = stack.keepNonConnected ? SubstanceAir::NonConnected_Keep : SubstanceAir::NonConnected_Remove;
+	for(auto& connection: stack.connections) {
+		options.mConnections.push_back(SubstanceAir::ConnectionsOptions::PairInOut(connection.first, connection.second));
+	}
+
+	PackageDescPtr stacked;
+	try {
+		SubstanceGlobalCallbacks::OwnerScope owner(key.c_str());
+		stacked = PackageDescPtr(new SubstanceAir::PackageStackDesc(pre->getGraphs()[stack.preGraph], post->getGraphs()[stack.postGraph], options));
+	}
+	catch(...) {
+		stacked.reset();
+	}
+
+	if(!stacked || !stacked->isValid()) {
+		CryLogAlways("ERROR: PackageCache: Cannot stack %s with %s", sbsarPath, stack.postPath.c_str());
+		return PackageDescPtr();
+	}
+
+	logDEBUG("PackageCache: stacked "<<sbsarPath<<" with "<<stack.postPath.c_str());
+	Stack& entry = _stacks[key];
+	entry.package = stacked;
+	entry.pre = pre;
+	entry.post = post;
+	return stacked;
+}
+
+static void removeOutputs(XmlNodeRef node, const std::vector<unsigned int>& outputUids, unsigned int& pruned)
+{
+	unsigned int uid;
+	for(int i=node->getChildCount()-1; i>=0; --i) {
+		XmlNodeRef child = node->getChild(i);
+		if(!strcmp(child->getTag(), "output") && child->getAttr("uid", uid) && !std::binary_search(outputUids.begin(), outputUids.end(), uid)) {
+			node->removeChild(child);
+			pruned++;
+			continue;
+		}
+
+		// The inputs list the outputs they alter:
+		const char* altered;
+		if(!strcmp(child->getTag(), "input") && child->getAttr("alteroutputs", &altered)) {
+			AZStd::string kept;
+			for(const char* ptr = altered; *ptr; ) {
+				char* end;
+				uid = (unsigned int)strtoul(ptr, &end, 10);
+				if(end == ptr) {
+					break;
+				}
+				if(std::binary_search(outputUids.begin(), outputUids.end(), uid)) {
+					kept += kept.empty() ? "" : ",";
+					kept += string_format("%u", uid).c_str();
+				}
+				ptr = *end == ',' ? end+1 : end;
+			}
+			child->setAttr("alteroutputs", kept.c_str());
+		}
+
+		removeOutputs(child, outputUids, pruned);
+	}
+
+	if(!strcmp(node->getTag(), "outputs") && node->haveAttr("count")) {
+		node->setAttr("count", node->getChildCount());
+	}
+}
+
+unsigned int PackageCache::selectOutputs(const char* xml, const std::vector<unsigned int>& outputUids, AZStd::string& selectedXml)
+{
+	// The output UIDs must be sorted:
+	XmlNodeRef root = GetISystem()->LoadXmlFromBuffer(xml, strlen(xml));
+	if(!root) {
+		return 0;
+	}
+
+	unsigned int pruned = 0;
+	removeOutputs(root, outputUids, pruned);
+	if(pruned > 0) {
+		selectedXml = root->getXML().c_str();
+	}
+
+	return pruned;
+}
+
+void PackageCache::purge()
+{
+	CryAutoCriticalSection lock(_lock);
+
+	// The stacks first, as they hold their source packages:
+	for(auto it = _stacks.begin(); it != _stacks.end(); ) {
+		if(it->second.package.use_count() == 1) {
+			it = _stacks.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	for(auto it = _selections.begin(); it != _selections.end(); ) {
+		if(!it->second.package || it->second.package.use_count() == 1) {
+			it = _selections.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	for(auto it = _entries.begin(); it != _entries.end(); ) {
+		if(it->second.package.use_count() == 1) {
+			logDEBUG("PackageCache: releasing unused package "<<it->first.c_str());
+			it = _entries.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+size_t PackageCache::getArchiveSize(const char* sbsarPath) const
+{
+	AZStd::string key = normalizePath(sbsarPath);
+
+	CryAutoCriticalSection lock(_lock);
+	auto it = _entries.find(key);
+	return it != _entries.end() ? it->second.archiveSize : 0;
+}
+
+void PackageCache::GetMemoryUsage(ICrySizer* s) const
+{
+	CryAutoCriticalSection lock(_lock);
+	s->AddObject(this, sizeof(*this));
+	for(auto& it: _entries) {
+		s->AddObject(it.second.package.get(), it.second.archiveSize);
+	}
+}
+
+void PackageCache::getStats(Stats& stats) const
+{
+	CryAutoCriticalSection lock(_lock);
+
+	stats.hits = _hits;
+	stats.misses = _misses;
+	stats.invalidations = _invalidations;
+	stats.packages = (unsigned int)_entries.size();
+	stats.archiveBytes = 0;
+	for(auto& it: _entries) {
+		stats.archiveBytes += it.second.archiveSize;
+	}
+
+	stats.stacks = (unsigned int)_stacks.size();
+	stats.selections = 0;
+	stats.prunedOutputs = 0;
+	for(auto& it: _selections) {
+		if(it.second.package) {
+			stats.selections++;
+			stats.prunedOutputs += it.second.prunedOutputs;
+		}
+	}
+}
+
+void PackageCache::dumpStats() const
+{
+	Stats stats;
+	getStats(stats);
+
+	CryLogAlways("Substance package cache: %u packages (%.2f MB of archives), %u hits, %u misses, %u invalidations",
+		stats.packages, stats.archiveBytes/(1024.0f*1024.0f), stats.hits, stats.misses, stats.invalidations);
+	CryLogAlways("  %u packages relinked without their unused outputs (%u outputs pruned), %u stacked packages", stats.selections, stats.prunedOutputs, stats.stacks);
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,149 @@
+/** @file PackageCache.h
+	@brief Header for the shared substance package cache
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_PACKAGECACHE_H
+#define GEM_SUBSTANCE_PACKAGECACHE_H
+#pragma once
+
+#include "Substance/framework/package.h"
+#include <AzCore/std/smart_ptr/shared_ptr.h>
+#include <CryThread.h>
+
+#if defined(USE_SUBSTANCE)
+
+typedef AZStd::shared_ptr<SubstanceAir::PackageDesc> PackageDescPtr;
+
+/**
+ Process wide cache of the parsed substance archives.
+
+ Packages are keyed by normalized .sbsar path and validated against the
+ archive modification time, size and content hash, so that a given archive
+ is only parsed once as long as it doesn't change on disk. The returned
+ packages are reference counted: a package replaced after a file change
+ stays alive until the last material using it is released.
+
+ The materials which only use some outputs of an archive get a package
+ rebuilt from the archive assembly with a description limited to these
+ outputs: the framework then links the assembly without them, so that they
+ are never instantiated, pushed nor computed by the engine.
+
+ The materials can also stack a graph with a graph of another archive: the
+ stacked package is linked as a single graph, so that the intermediate images
+ stay in the engine memory instead of being rendered and set as input images.
+*/
+class PackageCache
+{
+public:
+	struct Stats
+	{
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int invalidations;
+		unsigned int packages;
+		size_t archiveBytes;
+		unsigned int selections;		// Packages relinked with a subset of their outputs
+		unsigned int prunedOutputs;		// Outputs left out of these packages
+		unsigned int stacks;			// Packages stacking the graphs of two archives
+	};
+
+	/// Stacking of a graph (pre) with a graph of another archive (post) in a single package.
+	struct StackSettings
+	{
+		AZStd::string postPath;			// Archive of the post graph
+		int preGraph;					// Index of the pre graph in its archive
+		int postGraph;					// Index of the post graph in its archive
+		bool keepNonConnected;			// Keep the pre graph outputs which are not connected
+		std::vector<std::pair<unsigned int, unsigned int>> connections;	// Pre output UID, post input UID (automatic if empty)
+	};
+
+	static PackageCache& instance();
+
+	/// Retrieve the package for a given sbsar path, parsing the archive only if needed.
+	/// The content hash of the archive is written in contentHash if provided.
+	PackageDescPtr acquire(const char* sbsarPath, AZ::u64* contentHash = nullptr);
+
+	/// Retrieve the package for a given sbsar path relinked with only the given outputs,
+	/// or the full package if they are all selected. The relinked packages are cached per
+	/// archive content and output selection.
+	PackageDescPtr acquireSelected(const char* sbsarPath, const std::vector<unsigned int>& outputUids, AZ::u64* contentHash = nullptr);
+
+	/// Retrieve the package stacking a graph of the given archive with a graph of another archive,
+	/// so that the outputs of the pre graph feed the inputs of the post graph inside the engine.
+	/// The stacked packages are cached per archive contents and stack settings, the hash of which
+	/// is written in contentHash if provided.
+	PackageDescPtr acquireStack(const char* sbsarPath, const StackSettings& stack, AZ::u64* contentHash = nullptr);
+
+	/// Release all the cached packages that are not referenced anymore.
+	void purge();
+
+	/// Retrieve the cache counters.
+	void getStats(Stats& stats) const;
+
+	/// Write the cache counters in the log.
+	void dumpStats() const;
+
+	/// Retrieve the size of a cached archive, or 0 if it is not cached.
+	size_t getArchiveSize(const char* sbsarPath) const;
+
+	/// Add the cached packages to a sizer, the packages of each archive being counted with the archive size.
+	void GetMemoryUsage(ICrySizer* s) const;
+
+	/// Helper used to compute the FNV-1a hash of a buffer.
+	static AZ::u64 hashData(const void* data, size_t size, AZ::u64 seed = 14695981039346656037ULL);
+
+	/// Helper used to build the normalized key of a file path.
+	static AZStd::string normalizePath(const char* path);
+
+	/// Helper used to remove the outputs which are not selected from a package XML description,
+	/// returns the number of removed outputs.
+	static unsigned int selectOutputs(const char* xml, const std::vector<unsigned int>& outputUids, AZStd::string& selectedXml);
+
+protected:
+	PackageCache();
+
+	struct Entry
+	{
+		PackageDescPtr package;
+		AZ::u64 contentHash;
+		AZ::u64 modTime;
+		size_t archiveSize;
+	};
+
+	typedef std::map<AZStd::string, Entry> EntryMap;
+	EntryMap _entries;
+
+	struct Selection
+	{
+		PackageDescPtr package;
+		AZ::u64 contentHash;
+		unsigned int prunedOutputs;
+	};
+
+	// Relinked packages, keyed by normalized path and output selection:
+	typedef std::map<AZStd::string, Selection> SelectionMap;
+	SelectionMap _selections;
+
+	struct Stack
+	{
+		PackageDescPtr package;
+		PackageDescPtr pre;		// The stacked graphs must outlive the stack
+		PackageDescPtr post;
+	};
+
+	// Stacked packages, keyed by normalized paths and stack hash:
+	typedef std::map<AZStd::string, Stack> StackMap;
+	StackMap _stacks;
+
+	unsigned int _hits;
+	unsigned int _misses;
+	unsigned int _invalidations;
+
+	mutable CryCriticalSection _lock;
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_PACKAGECACHE_H
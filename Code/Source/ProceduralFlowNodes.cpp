@@ -31,7 +31,7 @@ public:
 	IGraphInstance* GetGraphInstance(GraphInstanceID graphInstanceID) const
 	{
 		IGraphInstance* pGraph = nullptr;
-		// EBUS_EVENT_RESULT(pGraph, SubstanceRequestBus, GetGraphInstance, graphInstanceID);
+		EBUS_EVENT_RESULT(pGraph, SubstanceRequestBus, GetGraphInstance, graphInstanceID);
 		return pGraph;
 	}
 };
@@ -42,9 +42,15 @@ class CProceduralMaterialFlowNodeGetGraphInstanceID : public CProceduralMaterial
 public:
 	CProceduralMaterialFlowNodeGetGraphInstanceID(SActivationInfo* pActInfo)
 		: CProceduralMaterialFlowNodeBase()
+		, m_pMaterial(nullptr)
 	{
 	}
 
+	~CProceduralMaterialFlowNodeGetGraphInstanceID()
+	{
+		SetMaterial(nullptr);
+	}
+
 	void GetConfiguration(SFlowNodeConfig& config) override
 	{
 		static const SInputPortConfig in_config[] = {
@@ -77,14 +83,12 @@ public:
 
 				IProceduralMaterial* pMaterial = nullptr;
 				EBUS_EVENT_RESULT(pMaterial, SubstanceRequestBus, GetMaterialFromPath, szMaterialPath, false);
-				if (pMaterial)
+
+				// Keep the material alive as long as this node may reference it:
+				SetMaterial(pMaterial);
+				if (pMaterial && graphIndex >= 0 && graphIndex < pMaterial->GetGraphInstanceCount())
 				{
-					ISubstanceLibAPI *pSubstanceLibAPI = nullptr;
-					EBUS_EVENT_RESULT(pSubstanceLibAPI, SubstanceRequestBus, GetSubstanceLibAPI);
-					if (pSubstanceLibAPI)
-					{
-						graphInstanceID = pSubstanceLibAPI->EncodeGraphInstanceID(pMaterial, graphIndex);
-					}
+					graphInstanceID = pMaterial->GetGraphInstance(graphIndex)->GetGraphInstanceID();
 				}
 
 				ActivateOutput(pActInfo, eO_Result, graphInstanceID);
@@ -104,6 +108,18 @@ public:
 	}
 
 private:
+	void SetMaterial(IProceduralMaterial* pMaterial)
+	{
+		// pMaterial already holds a reference from GetMaterialFromPath:
+		if (m_pMaterial)
+		{
+			m_pMaterial->Release();
+		}
+		m_pMaterial = pMaterial;
+	}
+
+	IProceduralMaterial* m_pMaterial;
+
 	enum InputPorts
 	{
 		eI_Material = 0,
@@ -597,6 +613,8 @@ public:
 		static const SInputPortConfig in_config[] = {
 			InputPortConfig<GraphInstanceID>("GraphInstanceID", ""),
 			InputPortConfig_Void("Add", _HELP("Add GraphInstanceID to the Queue")),
+			InputPortConfig<int>("Priority", (int)ProceduralMaterialRenderPriority::Streaming, _HELP("Priority class of the render"), 0, _UICONFIG("enum_int:Visible=0,Streaming=1,Background=2,EditorPreview=3")),
+			InputPortConfig<float>("Distance", -1.0f, _HELP("Camera distance hint, the closest graphs of a class are rendered first (< 0 if unknown)")),
 			{ 0 }
 		};
 		static const SOutputPortConfig out_config[] = {
@@ -619,12 +637,12 @@ public:
 			{
 				GraphInstanceID graphInstanceID = GetPortGraphInstanceID(pActInfo, eI_GraphInstanceID);
 
-				// IGraphInstance* pGraph = nullptr;
-				// EBUS_EVENT_RESULT(pGraph, SubstanceRequestBus, GetGraphInstance, graphInstanceID);
-				// if (pGraph)
-				// {
-				// 	EBUS_EVENT(SubstanceRequestBus, QueueRender, pGraph);
-				// }
+				if (IGraphInstance* pGraph = GetGraphInstance(graphInstanceID))
+				{
+					ProceduralMaterialRenderPriority priority = (ProceduralMaterialRenderPriority)GetPortInt(pActInfo, eI_Priority);
+					float distance = GetPortFloat(pActInfo, eI_Distance);
+					EBUS_EVENT(SubstanceRequestBus, QueueRenderWithPriority, pGraph, priority, distance);
+				}
 
 				ActivateOutput(pActInfo, eO_Done, true);
 			}
@@ -647,6 +665,8 @@ private:
 	{
 		eI_GraphInstanceID = 0,
 		eI_Add,
+		eI_Priority,
+		eI_Distance,
 	};
 
 	enum OutputPorts
@@ -738,11 +758,25 @@ protected:
 	virtual void DoRender(SActivationInfo* pActInfo) override
 	{
 		EBUS_EVENT(SubstanceRequestBus,RenderSync);
-		ActivateOutput(pActInfo, eO_RenderComplete, true);
+
+		// Under the frame budget the render completes in a later frame:
+		if (IsRenderPending())
+		{
+			pActInfo->pGraph->SetRegularlyUpdated(pActInfo->myID, true);
+		}
+		else
+		{
+			ActivateOutput(pActInfo, eO_RenderComplete, true);
+		}
 	}
 
 	virtual void DoUpdate(SActivationInfo* pActInfo) override
 	{
+		if (!IsRenderPending())
+		{
+			pActInfo->pGraph->SetRegularlyUpdated(pActInfo->myID, false);
+			ActivateOutput(pActInfo, eO_RenderComplete, true);
+		}
 	}
 
 	virtual const char* GetDescription() const override
@@ -750,6 +784,13 @@ protected:
 		return "Render Queued Graphs Synchronously";
 	}
 
+	bool IsRenderPending() const
+	{
+		bool pending = false;
+		EBUS_EVENT_RESULT(pending, SubstanceRequestBus, IsRenderPending);
+		return pending;
+	}
+
 private:
 	enum OutputPorts
 	{
@@ -0,0 +1,330 @@
+/** @file RenderCacheSpill.cpp
+	@brief Source File for the disk backed spill tier of the substance engine render cache
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "RenderCacheSpill.h"
+#include <AzCore/IO/FileIO.h>
+
+#if !defined(AZ_PLATFORM_WINDOWS)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define RENDERCACHESPILL_FOLDER "@cache@/substance"
+#define RENDERCACHESPILL_FILE RENDERCACHESPILL_FOLDER "/rendercache.tmp"
+
+// Alignment of the items in the scratch file:
+#define RENDERCACHESPILL_ALIGNMENT 16
+
+// Fastest zlib level, the items are written and read back within a few frames:
+#define RENDERCACHESPILL_COMPRESSION_LEVEL 1
+
+RenderCacheSpill& RenderCacheSpill::instance()
+{
+	static RenderCacheSpill spill;
+	return spill;
+}
+
+RenderCacheSpill::RenderCacheSpill() : _view(nullptr), _fileSize(0),
+#if defined(AZ_PLATFORM_WINDOWS)
+	_file(INVALID_HANDLE_VALUE), _mapping(nullptr),
+#else
+	_file(-1),
+#endif
+	_evictions(0), _fetches(0), _removes(0), _misses(0), _overCap(0),
+	_bytesSpilled(0), _bytesCompressed(0), _bytesFetched(0), _fileBytes(0), _memoryBytes(0), _memoryCap(0)
+{
+}
+
+RenderCacheSpill::~RenderCacheSpill()
+{
+	close();
+}
+
+bool RenderCacheSpill::open(size_t fileSize, size_t memoryCap)
+{
+	CryAutoCriticalSection lock(_lock);
+	if(_view) {
+		return true;
+	}
+
+	AZ::IO::FileIOBase* fileIO = gEnv->pFileIO;
+	fileIO->CreatePath(RENDERCACHESPILL_FOLDER);
+
+	char path[AZ_MAX_PATH_LEN] = { 0 };
+	if(!fileIO->ResolvePath(RENDERCACHESPILL_FILE, path, AZ_MAX_PATH_LEN)) {
+		CryLogAlways("ERROR: Substance render cache spill: unable to resolve %s", RENDERCACHESPILL_FILE);
+		return false;
+	}
+
+	// The scratch file is deleted when it is closed, including after a crash where the platform allows it:
+#if defined(AZ_PLATFORM_WINDOWS)
+	_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+	if(_file != INVALID_HANDLE_VALUE) {
+		_mapping = CreateFileMappingA(_file, nullptr, PAGE_READWRITE, (DWORD)((AZ::u64)fileSize >> 32), (DWORD)(fileSize & 0xffffffff), nullptr);
+		if(_mapping) {
+			_view = (uint8*)MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, fileSize);
+		}
+	}
+#else
+	_file = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if(_file >= 0) {
+		unlink(path);
+		if(ftruncate(_file, (off_t)fileSize) == 0) {
+			void* view = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+			_view = view != MAP_FAILED ? (uint8*)view : nullptr;
+		}
+	}
+#endif
+
+	if(!_view) {
+		CryLogAlways("ERROR: Substance render cache spill: unable to map %u MB in %s", (unsigned int)(fileSize/(1024*1024)), path);
+		_fileSize = 0;
+		close();
+		return false;
+	}
+
+	_fileSize = fileSize;
+	_memoryCap = memoryCap;
+	_freeExtents.clear();
+	_freeExtents[0] = fileSize;
+	logDEBUG("Substance render cache spill: "<<(fileSize/(1024*1024))<<" MB mapped in "<<path);
+	return true;
+}
+
+void RenderCacheSpill::close()
+{
+	CryAutoCriticalSection lock(_lock);
+	_items.clear();
+	_freeExtents.clear();
+	_fileBytes = 0;
+	_memoryBytes = 0;
+
+#if defined(AZ_PLATFORM_WINDOWS)
+	if(_view) {
+		UnmapViewOfFile(_view);
+	}
+	if(_mapping) {
+		CloseHandle(_mapping);
+		_mapping = nullptr;
+	}
+	if(_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(_file);
+		_file = INVALID_HANDLE_VALUE;
+	}
+#else
+	if(_view) {
+		munmap(_view, _fileSize);
+	}
+	if(_file >= 0) {
+		::close(_file);
+		_file = -1;
+	}
+#endif
+	_view = nullptr;
+	_fileSize = 0;
+}
+
+bool RenderCacheSpill::isOpen() const
+{
+	CryAutoCriticalSection lock(_lock);
+	return _view != nullptr;
+}
+
+void RenderCacheSpill::evict(SubstanceAir::UInt64 uid, const void* buffer, size_t size)
+{
+	// Compress out of the lock, the evictions of the render threads are independent.
+	// The item is stored as is when the codec doesn't reduce its size:
+	std::vector<uint8> compressed(size);
+	size_t compressedSize = size;
+	bool isCompressed = size > 0 && GetISystem()->CompressDataBlock(buffer, size, compressed.data(), compressedSize, RENDERCACHESPILL_COMPRESSION_LEVEL)
+		&& compressedSize < size;
+
+	const uint8* data = isCompressed ? compressed.data() : (const uint8*)buffer;
+	size_t storedSize = isCompressed ? compressedSize : size;
+
+	CryAutoCriticalSection lock(_lock);
+
+	// An item evicted again replaces its previous version:
+	auto it = _items.find(uid);
+	if(it != _items.end()) {
+		releaseItem(it->second);
+		_items.erase(it);
+	}
+
+	Item& item = _items[uid];
+	item.size = size;
+	item.storedSize = storedSize;
+	item.offset = 0;
+	item.compressed = isCompressed;
+
+	if(_view && allocate(storedSize, item.offset)) {
+		memcpy(_view + item.offset, data, storedSize);
+		_fileBytes += storedSize;
+	}
+	else {
+		// The engine may fetch the item back at any time, so it is kept even past the memory cap:
+		if(_memoryBytes + storedSize > _memoryCap && _overCap++ == 0) {
+			CryLogAlways("WARNING: Substance render cache spill: the scratch file and the %u MB of memory are full, the evicted items are kept in memory past the cap",
+				(unsigned int)(_memoryCap/(1024*1024)));
+		}
+
+		if(isCompressed) {
+			compressed.resize(storedSize);
+			item.memory.swap(compressed);
+		}
+		else {
+			item.memory.assign(data, data + storedSize);
+		}
+		_memoryBytes += storedSize;
+	}
+
+	_evictions++;
+	_bytesSpilled += size;
+	_bytesCompressed += storedSize;
+}
+
+bool RenderCacheSpill::fetch(SubstanceAir::UInt64 uid, void* buffer, size_t size)
+{
+	CryAutoCriticalSection lock(_lock);
+
+	auto it = _items.find(uid);
+	if(it == _items.end() || it->second.size != size) {
+		_misses++;
+		CryLogAlways("ERROR: Substance render cache spill: unable to fetch item %llx (%u bytes)", (unsigned long long)uid, (unsigned int)size);
+		return false;
+	}
+
+	const Item& item = it->second;
+	const uint8* data = item.memory.empty() ? _view + item.offset : item.memory.data();
+	if(item.compressed) {
+		size_t outputSize = size;
+		if(!GetISystem()->DecompressDataBlock(data, item.storedSize, buffer, outputSize) || outputSize != size) {
+			_misses++;
+			CryLogAlways("ERROR: Substance render cache spill: unable to decompress item %llx", (unsigned long long)uid);
+			return false;
+		}
+	}
+	else {
+		memcpy(buffer, data, size);
+	}
+
+	_fetches++;
+	_bytesFetched += size;
+	return true;
+}
+
+void RenderCacheSpill::remove(SubstanceAir::UInt64 uid)
+{
+	CryAutoCriticalSection lock(_lock);
+
+	auto it = _items.find(uid);
+	if(it != _items.end()) {
+		releaseItem(it->second);
+		_items.erase(it);
+		_removes++;
+	}
+}
+
+bool RenderCacheSpill::allocate(size_t size, size_t& offset)
+{
+	size_t alignedSize = (size + RENDERCACHESPILL_ALIGNMENT - 1) & ~(size_t)(RENDERCACHESPILL_ALIGNMENT - 1);
+
+	// First fit, the extents are coalesced on release:
+	for(auto it = _freeExtents.begin(); it != _freeExtents.end(); ++it) {
+		if(it->second >= alignedSize) {
+			offset = it->first;
+			size_t remaining = it->second - alignedSize;
+			_freeExtents.erase(it);
+			if(remaining > 0) {
+				_freeExtents[offset + alignedSize] = remaining;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RenderCacheSpill::release(size_t offset, size_t size)
+{
+	size = (size + RENDERCACHESPILL_ALIGNMENT - 1) & ~(size_t)(RENDERCACHESPILL_ALIGNMENT - 1);
+
+	// Merge with the next free extent:
+	auto next = _freeExtents.find(offset + size);
+	if(next != _freeExtents.end()) {
+		size += next->second;
+		_freeExtents.erase(next);
+	}
+
+	// Merge with the previous free extent:
+	auto it = _freeExtents.lower_bound(offset);
+	if(it != _freeExtents.begin()) {
+		auto prev = std::prev(it);
+		if(prev->first + prev->second == offset) {
+			prev->second += size;
+			return;
+		}
+	}
+
+	_freeExtents[offset] = size;
+}
+
+void RenderCacheSpill::releaseItem(Item& item)
+{
+	if(item.memory.empty()) {
+		release(item.offset, item.storedSize);
+		_fileBytes -= item.storedSize;
+	}
+	else {
+		_memoryBytes -= item.storedSize;
+	}
+}
+
+bool RenderCacheSpill::isIntact() const
+{
+	CryAutoCriticalSection lock(_lock);
+	return _misses == 0;
+}
+
+void RenderCacheSpill::getStats(Stats& stats) const
+{
+	CryAutoCriticalSection lock(_lock);
+	stats.evictions = _evictions;
+	stats.fetches = _fetches;
+	stats.removes = _removes;
+	stats.misses = _misses;
+	stats.overCap = _overCap;
+	stats.items = (unsigned int)_items.size();
+	stats.bytesSpilled = _bytesSpilled;
+	stats.bytesCompressed = _bytesCompressed;
+	stats.bytesFetched = _bytesFetched;
+	stats.fileBytes = _fileBytes;
+	stats.memoryBytes = _memoryBytes;
+	stats.memoryCap = _memoryCap;
+	stats.fileSize = _fileSize;
+}
+
+void RenderCacheSpill::dumpStats() const
+{
+	Stats stats;
+	getStats(stats);
+
+	CryLogAlways("Substance render cache spill: %s, %u items, %.2f / %.2f MB of scratch file, %.2f / %.2f MB in memory",
+		stats.fileSize > 0 ? "open" : "closed", stats.items, stats.fileBytes/(1024.0f*1024.0f),
+		stats.fileSize/(1024.0f*1024.0f), stats.memoryBytes/(1024.0f*1024.0f), stats.memoryCap/(1024.0f*1024.0f));
+	CryLogAlways("Substance render cache spill: %u evictions (%.2f MB spilled, %.2f MB compressed, ratio %.2f), %u fetches (%.2f MB), %u removes, %u misses",
+		stats.evictions, stats.bytesSpilled/(1024.0f*1024.0f), stats.bytesCompressed/(1024.0f*1024.0f),
+		stats.bytesCompressed > 0 ? (float)stats.bytesSpilled/stats.bytesCompressed : 0.0f,
+		stats.fetches, stats.bytesFetched/(1024.0f*1024.0f), stats.removes, stats.misses);
+	CryLogAlways("Substance render cache spill: %u evictions kept in memory past the cap", stats.overCap);
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,140 @@
+/** @file RenderCacheSpill.h
+	@brief Header for the disk backed spill tier of the substance engine render cache
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_RENDERCACHESPILL_H
+#define GEM_SUBSTANCE_RENDERCACHESPILL_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include "Substance/framework/typedefs.h"
+#include <CryThread.h>
+
+#if defined(USE_SUBSTANCE)
+
+/**
+ Spill tier of the intermediate results evicted by the substance engine.
+
+ When its memory budget is exhausted, the engine drops the intermediate
+ results of the graphs and computes them again when they are needed. With
+ the spill tier open, the evicted results are compressed and written to a
+ memory mapped scratch file instead, then decompressed when the engine
+ fetches them back, which is cheaper than recomputing large graphs.
+
+ The engine expects the fetched items to be restored exactly and cannot
+ recompute an item it fetches, so an item is never dropped before the
+ engine removes it: the items which don't fit in the scratch file are kept
+ in memory, past the memory cap if needed. Exceeding the cap is logged and
+ counted in the stats, it means the scratch file is too small.
+
+ A fetch which can't be restored leaves the render wrong, the renders are
+ then not trusted anymore for the texture cache, see isIntact().
+
+ The cache item UIDs are only unique within an engine, and the global
+ callbacks don't tell which renderer evicts an item: the spill tier must
+ only be open while the gem renderer is the only renderer.
+*/
+class RenderCacheSpill
+{
+public:
+	struct Stats
+	{
+		unsigned int evictions;
+		unsigned int fetches;
+		unsigned int removes;
+		unsigned int misses;			// Fetches of unknown items
+		unsigned int overCap;			// Evictions kept in memory past the cap, with the file full
+		unsigned int items;
+		AZ::u64 bytesSpilled;			// Uncompressed size of the evicted items
+		AZ::u64 bytesCompressed;		// Compressed size of the evicted items
+		AZ::u64 bytesFetched;			// Uncompressed size of the fetched items
+		AZ::u64 fileBytes;				// Scratch file space used by the current items
+		AZ::u64 memoryBytes;			// Memory used by the current items which didn't fit in the file
+		AZ::u64 memoryCap;
+		AZ::u64 fileSize;
+	};
+
+	static RenderCacheSpill& instance();
+
+	/// Create the scratch file of the given size and map it, returns false if it failed.
+	/// The items which don't fit in the file are kept in memory, memoryCap is the expected maximum.
+	bool open(size_t fileSize, size_t memoryCap);
+
+	/// Unmap and delete the scratch file, releasing all the items.
+	void close();
+
+	/// Check if the scratch file is mapped.
+	bool isOpen() const;
+
+	/// Store an item evicted by the engine.
+	void evict(SubstanceAir::UInt64 uid, const void* buffer, size_t size);
+
+	/// Restore an item fetched by the engine, returns false if it was never evicted or can't be decompressed.
+	bool fetch(SubstanceAir::UInt64 uid, void* buffer, size_t size);
+
+	/// Release an item deprecated by the engine.
+	void remove(SubstanceAir::UInt64 uid);
+
+	/// Check that every item fetched by the engine was restored, the renders are wrong otherwise.
+	bool isIntact() const;
+
+	/// Retrieve the spill counters.
+	void getStats(Stats& stats) const;
+
+	/// Write the spill counters in the log.
+	void dumpStats() const;
+
+protected:
+	RenderCacheSpill();
+	~RenderCacheSpill();
+
+	struct Item
+	{
+		size_t size;					// Uncompressed size
+		size_t storedSize;				// Size in the file or memory, equal to size if not compressed
+		size_t offset;					// Offset in the scratch file
+		bool compressed;
+		std::vector<uint8> memory;		// Stored data when the file is full
+	};
+
+	// Allocate and release extents of the scratch file, the caller must hold the lock:
+	bool allocate(size_t size, size_t& offset);
+	void release(size_t offset, size_t size);
+	void releaseItem(Item& item);
+
+	typedef std::map<SubstanceAir::UInt64, Item> ItemMap;
+	ItemMap _items;
+
+	// Free extents of the scratch file, indexed by offset:
+	typedef std::map<size_t, size_t> ExtentMap;
+	ExtentMap _freeExtents;
+
+	uint8* _view;
+	size_t _fileSize;
+#if defined(AZ_PLATFORM_WINDOWS)
+	void* _file;
+	void* _mapping;
+#else
+	int _file;
+#endif
+
+	unsigned int _evictions;
+	unsigned int _fetches;
+	unsigned int _removes;
+	unsigned int _misses;
+	unsigned int _overCap;
+	AZ::u64 _bytesSpilled;
+	AZ::u64 _bytesCompressed;
+	AZ::u64 _bytesFetched;
+	AZ::u64 _fileBytes;
+	AZ::u64 _memoryBytes;
+	AZ::u64 _memoryCap;
+
+	mutable CryCriticalSection _lock;
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_RENDERCACHESPILL_H
@@ -0,0 +1,146 @@
+/** @file RenderCallbacks.cpp
+	@brief Source File for the substance renderer callbacks of the gem
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "RenderCallbacks.h"
+#include "TextureLoadHandler.h"
+#include "GraphInstance.h"
+#include "SubstanceMaterial.h"
+#include "RenderProfiler.h"
+#include "Substance/SubstanceBus.h"
+#include "Substance/framework/renderer.h"
+#include <ITimer.h>
+
+static float getCurrentTime()
+{
+	return gEnv->pTimer->GetAsyncTime().GetMilliSeconds();
+}
+
+SubstanceRenderCallbacks::SubstanceRenderCallbacks() : _textureLoadHandler(nullptr)
+{
+}
+
+void SubstanceRenderCallbacks::setTextureLoadHandler(CTextureLoadHandler_Substance* handler)
+{
+	CryAutoCriticalSection lock(_lock);
+	_textureLoadHandler = handler;
+}
+
+void SubstanceRenderCallbacks::jobStarted(SubstanceAir::UInt runUid, float startTime)
+{
+	CryAutoCriticalSection lock(_jobsLock);
+
+	// The first outputs may have been computed before the run returned:
+	Job& job = _jobs[runUid];
+	job.startTime = startTime;
+	job.started = true;
+}
+
+void SubstanceRenderCallbacks::dispatchNotifications(SubstanceAir::Renderer* renderer)
+{
+	std::vector<OutputEvent> outputEvents;
+	std::vector<std::pair<SubstanceAir::UInt, Job>> completedJobs;
+	{
+		CryAutoCriticalSection lock(_jobsLock);
+		if(_jobs.empty() && _outputEvents.empty()) {
+			return;
+		}
+
+		// Make the output times relative to the start of their jobs:
+		outputEvents.swap(_outputEvents);
+		for(auto& ev: outputEvents) {
+			auto jit = _jobs.find(ev.runUid);
+			ev.time = jit != _jobs.end() ? ev.time - jit->second.startTime : 0.0f;
+		}
+
+		for(auto jit = _jobs.begin(); jit != _jobs.end();) {
+			if(jit->second.started && !renderer->isPending(jit->first)) {
+				completedJobs.push_back(*jit);
+				jit = _jobs.erase(jit);
+			}
+			else {
+				++jit;
+			}
+		}
+	}
+
+	// The handlers are called without holding the lock, as they may start new renders:
+	for(auto& ev: outputEvents) {
+		EBUS_EVENT(SubstanceNotificationBus, OnOutputComputed, ev.runUid, ev.graphInstanceID, ev.graphOutputID, ev.time);
+	}
+
+	for(auto& completed: completedJobs) {
+		const Job& job = completed.second;
+		SProceduralMaterialRenderJobStats stats;
+		stats.GraphInstances.insert(stats.GraphInstances.end(), job.graphs.begin(), job.graphs.end());
+		stats.OutputCount = job.outputCount;
+		stats.FirstOutputMs = job.outputCount > 0 ? job.firstOutputTime - job.startTime : 0.0f;
+		stats.TotalMs = job.outputCount > 0 ? job.lastOutputTime - job.startTime : 0.0f;
+		EBUS_EVENT(SubstanceNotificationBus, OnRenderJobCompleted, completed.first, stats);
+	}
+}
+
+void SubstanceRenderCallbacks::outputComputed(SubstanceAir::UInt runUid, size_t userData,
+	const SubstanceAir::GraphInstance* graphInstance,
+	SubstanceAir::OutputInstance* outputInstance)
+{
+	{
+		// Track the output for the notifications, the gem graph instance is set as user data:
+		float now = getCurrentTime();
+		auto graph = (GraphInstance*)graphInstance->mUserData;
+		GraphInstanceID graphID = graph ? graph->GetGraphInstanceID() : INVALID_GRAPHINSTANCEID;
+
+		float elapsed = 0.0f;
+		bool newGraph = false;
+		{
+			CryAutoCriticalSection lock(_jobsLock);
+			Job& job = _jobs[runUid];
+			if(job.outputCount++ == 0) {
+				job.firstOutputTime = now;
+				if(!job.started) {
+					job.startTime = now;
+				}
+				job.lastOutputTime = job.startTime;
+			}
+
+			// The outputs are computed one after the other, each one is charged the time since the previous one:
+			elapsed = std::max(now - job.lastOutputTime, 0.0f);
+			job.lastOutputTime = now;
+			if(std::find(job.graphs.begin(), job.graphs.end(), graphID) == job.graphs.end()) {
+				job.graphs.push_back(graphID);
+				newGraph = true;
+			}
+
+			OutputEvent ev = { runUid, graphID, outputInstance->mDesc.mUid, now };
+			_outputEvents.push_back(ev);
+		}
+
+		if(graph && graph->getMaterial()) {
+			graph->getMaterial()->addRenderTime(elapsed, newGraph ? 1 : 0, 1);
+
+			if(RenderProfiler::instance().isEnabled()) {
+				AZ::u64 end = RenderProfiler::now();
+				AZ::u64 duration = std::min((AZ::u64)(elapsed*1000.0f), end - 1);
+				RenderProfiler::instance().addSpan("Output", "compute", end - duration, end, runUid,
+					graph->getMaterial()->GetPath(), outputInstance->mDesc.mUid);
+			}
+		}
+	}
+
+	// Only the texture loader jobs carry user data:
+	if(userData == 0) {
+		return;
+	}
+
+	CryAutoCriticalSection lock(_lock);
+	if(_textureLoadHandler) {
+		_textureLoadHandler->outputComputed(userData, outputInstance);
+	}
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,90 @@
+/** @file RenderCallbacks.h
+	@brief Header for the substance renderer callbacks of the gem
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_RENDERCALLBACKS_H
+#define GEM_SUBSTANCE_RENDERCALLBACKS_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include "Substance/framework/callbacks.h"
+#include <CryThread.h>
+#include <map>
+#include <vector>
+
+#if defined(USE_SUBSTANCE)
+
+struct CTextureLoadHandler_Substance;
+
+namespace SubstanceAir {
+class Renderer;
+};
+
+/**
+ Callbacks set on the gem renderer.
+
+ The outputs computed by the asynchronous jobs started by the texture loader
+ are forwarded to it from the render thread. Jobs run without user data
+ (ie. from the QueueRender() API) are ignored: their results are grabbed by
+ the caller.
+ The computed outputs and the jobs are also tracked for the
+ SubstanceNotificationBus events, which are sent from the main thread by
+ dispatchNotifications().
+ This object must outlive the renderer.
+*/
+class SubstanceRenderCallbacks : public SubstanceAir::RenderCallbacks
+{
+public:
+	SubstanceRenderCallbacks();
+
+	/// Set the texture loader notified of the computed outputs (can be nullptr).
+	void setTextureLoadHandler(CTextureLoadHandler_Substance* handler);
+
+	/// Register a job, called after each run with the time (in ms) before the run.
+	void jobStarted(SubstanceAir::UInt runUid, float startTime);
+
+	/// Send the notifications of the computed outputs and of the jobs not pending anymore.
+	void dispatchNotifications(SubstanceAir::Renderer* renderer);
+
+	using SubstanceAir::RenderCallbacks::outputComputed;
+
+	virtual void outputComputed(SubstanceAir::UInt runUid, size_t userData,
+		const SubstanceAir::GraphInstance* graphInstance,
+		SubstanceAir::OutputInstance* outputInstance) override;
+
+protected:
+	struct Job
+	{
+		Job() : startTime(0.0f), firstOutputTime(0.0f), lastOutputTime(0.0f), outputCount(0), started(false) {}
+
+		float startTime;
+		float firstOutputTime;
+		float lastOutputTime;
+		int outputCount;
+		bool started;
+		std::vector<GraphInstanceID> graphs;
+	};
+
+	struct OutputEvent
+	{
+		SubstanceAir::UInt runUid;
+		GraphInstanceID graphInstanceID;
+		GraphOutputID graphOutputID;
+		float time;
+	};
+
+	CTextureLoadHandler_Substance* _textureLoadHandler;
+
+	CryCriticalSection _lock;
+
+	// Jobs and output events, filled from the render thread:
+	std::map<SubstanceAir::UInt, Job> _jobs;
+	std::vector<OutputEvent> _outputEvents;
+	CryCriticalSection _jobsLock;
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_RENDERCALLBACKS_H
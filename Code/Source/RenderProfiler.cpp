@@ -0,0 +1,171 @@
+/** @file RenderProfiler.cpp
+	@brief Source File for the span profiler of the procedural texture renders
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "RenderProfiler.h"
+#include <AzCore/IO/FileIO.h>
+#include <algorithm>
+#include <chrono>
+
+RenderProfiler::Scope::Scope(const char* name, const char* category, unsigned int runUid, const char* detail, unsigned int id) :
+	_name(name), _category(category), _detail(detail), _runUid(runUid), _id(id),
+	_start(RenderProfiler::instance().isEnabled() ? RenderProfiler::now() : 0)
+{
+}
+
+RenderProfiler::Scope::~Scope()
+{
+	if(_start != 0) {
+		RenderProfiler::instance().addSpan(_name, _category, _start, RenderProfiler::now(), _runUid, _detail, _id);
+	}
+}
+
+RenderProfiler& RenderProfiler::instance()
+{
+	static RenderProfiler profiler;
+	return profiler;
+}
+
+RenderProfiler::RenderProfiler() : _next(0), _first(0), _enabled(false)
+{
+}
+
+void RenderProfiler::setEnabled(bool enabled)
+{
+	// Called from the main thread, the buffer is never released so that late spans stay safe:
+	if(enabled && !_spans) {
+		_spans.reset(new Span[kCapacity]);
+		for(size_t i=0; i<kCapacity; ++i) {
+			_spans[i].sequence.store(0, std::memory_order_relaxed);
+		}
+	}
+	_enabled.store(enabled, std::memory_order_release);
+}
+
+AZ::u64 RenderProfiler::now()
+{
+	// Never 0, which marks the scopes started while disabled:
+	static const auto origin = std::chrono::steady_clock::now();
+	return (AZ::u64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count() + 1;
+}
+
+void RenderProfiler::addSpan(const char* name, const char* category, AZ::u64 start, AZ::u64 end, unsigned int runUid, const char* detail, unsigned int id)
+{
+	if(!isEnabled()) {
+		return;
+	}
+
+	// Claim a slot, the oldest span is overwritten when the ring is full:
+	AZ::u64 index = _next.fetch_add(1, std::memory_order_relaxed);
+	Span& span = _spans[index & (kCapacity - 1)];
+	// The fence keeps the payload writes after the slot is marked as being written:
+	span.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	span.name = name;
+	span.category = category;
+	span.start = start;
+	span.duration = end > start ? end - start : 0;
+	span.thread = (AZ::u32)CryGetCurrentThreadId();
+	span.runUid = runUid;
+	span.id = id;
+	azstrncpy(span.detail, kDetailSize, detail ? detail : "", kDetailSize - 1);
+	span.detail[kDetailSize - 1] = 0;
+
+	span.sequence.store(index + 1, std::memory_order_release);
+}
+
+void RenderProfiler::clear()
+{
+	_first.store(_next.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+// Append a string to a JSON document, escaped:
+static void appendJsonString(AZStd::string& json, const char* str)
+{
+	json += '"';
+	for(const char* c = str; *c; ++c) {
+		if(*c == '"' || *c == '\\') {
+			json += '\\';
+			json += *c;
+		}
+		else if((unsigned char)*c < 0x20) {
+			json += ' ';
+		}
+		else {
+			json += *c;
+		}
+	}
+	json += '"';
+}
+
+int RenderProfiler::dump(const char* path) const
+{
+	if(!_spans) {
+		return 0;
+	}
+
+	AZ::u64 next = _next.load(std::memory_order_acquire);
+	AZ::u64 first = std::max(_first.load(std::memory_order_acquire), next > kCapacity ? next - kCapacity : 0);
+
+	AZStd::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	int count = 0;
+	for(AZ::u64 index = first; index < next; ++index) {
+		const Span& slot = _spans[index & (kCapacity - 1)];
+		if(slot.sequence.load(std::memory_order_acquire) != index + 1) {
+			continue;
+		}
+
+		// Copy the span, and drop it if a writer reused the slot meanwhile:
+		Span span;
+		span.name = slot.name;
+		span.category = slot.category;
+		span.start = slot.start;
+		span.duration = slot.duration;
+		span.thread = slot.thread;
+		span.runUid = slot.runUid;
+		span.id = slot.id;
+		memcpy(span.detail, slot.detail, kDetailSize);
+		span.detail[kDetailSize - 1] = 0;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(slot.sequence.load(std::memory_order_relaxed) != index + 1) {
+			continue;
+		}
+
+		if(count++ > 0) {
+			json += ",\n";
+		}
+		json += "{\"name\":";
+		appendJsonString(json, span.name);
+		json += ",\"cat\":";
+		appendJsonString(json, span.category);
+		json += string_format(",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%u,\"args\":{\"run\":%u,\"id\":%u,\"detail\":",
+			(unsigned long long)span.start, (unsigned long long)span.duration, span.thread, span.runUid, span.id);
+		appendJsonString(json, span.detail);
+		json += "}}";
+	}
+	json += "\n]}\n";
+
+	AZ::IO::FileIOBase* fileIO = gEnv->pFileIO;
+	AZ::IO::HandleType handle;
+	if(!fileIO->Open(path, AZ::IO::OpenMode::ModeWrite|AZ::IO::OpenMode::ModeBinary, handle)) {
+		logERROR("RenderProfiler: cannot open "<<path<<" for writing.");
+		return -1;
+	}
+
+	bool written = fileIO->Write(handle, json.c_str(), json.size());
+	fileIO->Close(handle);
+	if(!written) {
+		logERROR("RenderProfiler: failed to write "<<path);
+		return -1;
+	}
+
+	return count;
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,93 @@
+/** @file RenderProfiler.h
+	@brief Header for the span profiler of the procedural texture renders
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_RENDERPROFILER_H
+#define GEM_SUBSTANCE_RENDERPROFILER_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include <atomic>
+#include <memory>
+
+#if defined(USE_SUBSTANCE)
+
+/**
+ Span profiler of the procedural texture renders, enabled with substance_profile.
+
+ The spans cover the path of a procedural texture: the wait in the render
+ queue, the engine computation of each output, the result grab and the copy or
+ encoding into the texture load data. They are recorded from any thread into
+ a lock-free ring buffer, which keeps the most recent spans, and written as a
+ Chrome trace_event JSON file by dump(), to be opened in chrome://tracing.
+*/
+class RenderProfiler
+{
+public:
+	/// Span recorded between its construction and its destruction, when the profiler is enabled.
+	/// The detail string must outlive the scope.
+	class Scope
+	{
+	public:
+		Scope(const char* name, const char* category, unsigned int runUid = 0, const char* detail = nullptr, unsigned int id = 0);
+		~Scope();
+
+	protected:
+		const char* _name;
+		const char* _category;
+		const char* _detail;
+		unsigned int _runUid;
+		unsigned int _id;
+		AZ::u64 _start;
+	};
+
+	static RenderProfiler& instance();
+
+	/// Enable or disable the recording, the ring buffer is allocated on the first enable.
+	void setEnabled(bool enabled);
+
+	/// Check if the spans are recorded.
+	bool isEnabled() const { return _enabled.load(std::memory_order_acquire); }
+
+	/// Retrieve the profiler clock, in microseconds.
+	static AZ::u64 now();
+
+	/// Record a span, the detail string is copied (truncated).
+	void addSpan(const char* name, const char* category, AZ::u64 start, AZ::u64 end, unsigned int runUid = 0, const char* detail = nullptr, unsigned int id = 0);
+
+	/// Write the recorded spans as a Chrome trace_event JSON file, returns the number of written spans or -1 on error.
+	int dump(const char* path) const;
+
+	/// Drop the recorded spans.
+	void clear();
+
+protected:
+	RenderProfiler();
+
+	static const size_t kCapacity = 65536;		// Must be a power of two
+	static const size_t kDetailSize = 96;
+
+	struct Span
+	{
+		std::atomic<AZ::u64> sequence;			// Index of the span + 1 once written, 0 while written
+		const char* name;						// Static strings
+		const char* category;
+		AZ::u64 start;
+		AZ::u64 duration;
+		AZ::u32 thread;
+		AZ::u32 runUid;
+		AZ::u32 id;
+		char detail[kDetailSize];
+	};
+
+	std::unique_ptr<Span[]> _spans;
+	std::atomic<AZ::u64> _next;
+	std::atomic<AZ::u64> _first;				// Index of the first span kept after clear()
+	std::atomic<bool> _enabled;
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_RENDERPROFILER_H
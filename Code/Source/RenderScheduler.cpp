@@ -0,0 +1,383 @@
+/** @file RenderScheduler.cpp
+	@brief Source File for the per-frame render budget of the gem renderer
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "RenderScheduler.h"
+#include "RenderSettings.h"
+#include "GraphInstance.h"
+#include "MaterialRegistry.h"
+#include "SubstanceMaterial.h"
+#include "RenderProfiler.h"
+#include <ITimer.h>
+#include <limits>
+
+static float getCurrentTime()
+{
+	return gEnv->pTimer->GetAsyncTime().GetMilliSeconds();
+}
+
+RenderScheduler& RenderScheduler::instance()
+{
+	static RenderScheduler scheduler;
+	return scheduler;
+}
+
+RenderScheduler::RenderScheduler() : _renderer(nullptr), _deferred(false), _held(false), _runCalls(0),
+	_busySince(-1.0f), _lastCompletion(0.0f), _debt(0.0f)
+{
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+void RenderScheduler::setRenderer(SubstanceAir::Renderer* renderer)
+{
+	CryAutoCriticalSection lock(_lock);
+	if(_renderer && _held) {
+		_renderer->resume();
+	}
+
+	_renderer = renderer;
+	_queue.clear();
+	_jobs.clear();
+	_deferred = false;
+	_held = false;
+	_runCalls = 0;
+	_busySince = -1.0f;
+	_debt = 0.0f;
+
+	if(renderer) {
+		SubstanceNotificationBus::Handler::BusConnect();
+	}
+	else {
+		SubstanceNotificationBus::Handler::BusDisconnect();
+	}
+}
+
+SubstanceAir::UInt RenderScheduler::getRunOptions(ProceduralMaterialRenderPriority priority)
+{
+	switch(priority) {
+	case ProceduralMaterialRenderPriority::Visible:
+		return SubstanceAir::Renderer::Run_Asynchronous | SubstanceAir::Renderer::Run_First | SubstanceAir::Renderer::Run_Replace | SubstanceAir::Renderer::Run_PreserveRun;
+	case ProceduralMaterialRenderPriority::Streaming:
+		return SubstanceAir::Renderer::Run_Asynchronous | SubstanceAir::Renderer::Run_First | SubstanceAir::Renderer::Run_PreserveRun;
+	case ProceduralMaterialRenderPriority::EditorPreview:
+		return SubstanceAir::Renderer::Run_Asynchronous | SubstanceAir::Renderer::Run_Replace;
+	default:
+		return SubstanceAir::Renderer::Run_Asynchronous;
+	}
+}
+
+void RenderScheduler::queue(GraphInstanceID graphInstanceID, ProceduralMaterialRenderPriority priority, float distance)
+{
+	CryAutoCriticalSection lock(_lock);
+
+	// A graph queued several times is pushed once, with its most urgent priority:
+	for(auto& queued: _queue) {
+		if(queued.graphInstanceID == graphInstanceID) {
+			queued.priority = std::min(queued.priority, priority);
+			if(distance >= 0.0f && (queued.distance < 0.0f || distance < queued.distance)) {
+				queued.distance = distance;
+			}
+			return;
+		}
+	}
+
+	QueuedGraph queued = { graphInstanceID, priority, distance, RenderProfiler::instance().isEnabled() ? RenderProfiler::now() : 0 };
+	_queue.push_back(queued);
+}
+
+int RenderScheduler::pushGraphs(SubstanceAir::Renderer* renderer, std::vector<QueuedGraph>& graphs, ProceduralMaterialRenderPriority priority,
+	std::vector<CryCriticalSection*>& locks)
+{
+	int count = 0;
+	for(auto& queued: graphs) {
+		if(queued.priority != priority) {
+			continue;
+		}
+
+		// The material may have been unloaded since the graph was queued:
+		auto graph = (GraphInstance*)MaterialRegistry::instance().getGraphInstance(queued.graphInstanceID);
+		if(graph) {
+			// The renderers of the pool may be rendering the same graph:
+			graph->getRenderLock().Lock();
+			locks.push_back(&graph->getRenderLock());
+			renderer->push(*(graph->getInstance()));
+			count++;
+
+			if(queued.queueTime != 0) {
+				RenderProfiler::instance().addSpan("Queue", "queue", queued.queueTime, RenderProfiler::now(), 0,
+					graph->getMaterial()->GetPath(), graph->getGraphIndex());
+			}
+		}
+	}
+
+	return count;
+}
+
+void RenderScheduler::unlockGraphs(std::vector<CryCriticalSection*>& locks)
+{
+	for(auto lock: locks) {
+		lock->Unlock();
+	}
+	locks.clear();
+}
+
+SubstanceAir::UInt RenderScheduler::render(bool synchronous)
+{
+	SubstanceAir::Renderer* renderer;
+	bool budgeted;
+	std::vector<QueuedGraph> graphs;
+	{
+		CryAutoCriticalSection lock(_lock);
+		renderer = _renderer;
+		if(!renderer) {
+			return 0;
+		}
+
+		// Bound the work in flight, the pushed graphs wait for the next run:
+		budgeted = substance_frameBudget > 0.0f;
+		if(synchronous && budgeted && (int)_jobs.size() >= std::max(substance_maxPendingJobs, 1)) {
+			if(!_deferred) {
+				_deferred = true;
+				_stats.DeferredRuns++;
+			}
+			return 0;
+		}
+
+		graphs.swap(_queue);
+	}
+
+	// Closest graphs first, the unknown distances last:
+	std::stable_sort(graphs.begin(), graphs.end(), [](const QueuedGraph& a, const QueuedGraph& b) {
+		float da = a.distance < 0.0f ? std::numeric_limits<float>::max() : a.distance;
+		float db = b.distance < 0.0f ? std::numeric_limits<float>::max() : b.distance;
+		return da < db;
+	});
+
+	// The loader threads push and run on the same renderer:
+	CryAutoCriticalSection renderLock(RenderSettings::instance().getRenderLock());
+
+	// Without budget the synchronous renders are run in a single job, the most urgent classes first:
+	const int count = (int)ProceduralMaterialRenderPriority::Count;
+	std::vector<CryCriticalSection*> locks;
+	if(synchronous && !budgeted) {
+		for(int p=0; p<count; ++p) {
+			pushGraphs(renderer, graphs, (ProceduralMaterialRenderPriority)p, locks);
+		}
+		RenderSettings::instance().run(renderer);
+		unlockGraphs(locks);
+		return 0;
+	}
+
+	// The Run_First jobs go ahead of the queued ones, so they are run from the least urgent class,
+	// and the other ones from the most urgent class:
+	ProceduralMaterialRenderPriority order[count];
+	int n = 0;
+	for(int p=count-1; p>=0; --p) {
+		if(getRunOptions((ProceduralMaterialRenderPriority)p) & SubstanceAir::Renderer::Run_First) {
+			order[n++] = (ProceduralMaterialRenderPriority)p;
+		}
+	}
+	for(int p=0; p<count; ++p) {
+		if(!(getRunOptions((ProceduralMaterialRenderPriority)p) & SubstanceAir::Renderer::Run_First)) {
+			order[n++] = (ProceduralMaterialRenderPriority)p;
+		}
+	}
+
+	std::vector<SubstanceAir::UInt> runs;
+	SubstanceAir::UInt lastRunUid = 0;
+	for(int i=0; i<n; ++i) {
+		if(pushGraphs(renderer, graphs, order[i], locks) == 0) {
+			continue;
+		}
+
+		SubstanceAir::UInt runOptions = getRunOptions(order[i]);
+		SubstanceAir::UInt runUid = RenderSettings::instance().run(renderer, runOptions);
+		unlockGraphs(locks);
+		if(runUid == 0) {
+			continue;
+		}
+
+		// The last queued job is rendered last, or the first Run_First job without queued job:
+		runs.push_back(runUid);
+		if(!(runOptions & SubstanceAir::Renderer::Run_First) || lastRunUid == 0) {
+			lastRunUid = runUid;
+		}
+	}
+
+	CryAutoCriticalSection lock(_lock);
+	for(auto runUid: runs) {
+		auto jit = _jobs.find(runUid);
+		if(jit != _jobs.end()) {
+			jit->second.requested = true;
+		}
+	}
+
+	return lastRunUid;
+}
+
+bool RenderScheduler::isPending()
+{
+	CryAutoCriticalSection lock(_lock);
+	if(_deferred) {
+		return true;
+	}
+
+	for(auto& job: _jobs) {
+		if(job.second.requested) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RenderScheduler::update()
+{
+	SubstanceAir::Renderer* renderer;
+	float now = getCurrentTime();
+	bool runDeferred = false;
+	{
+		CryAutoCriticalSection lock(_lock);
+		renderer = _renderer;
+		if(!renderer) {
+			return;
+		}
+
+		// Render time of the frame, up to the completion of the last job:
+		float work = 0.0f;
+		if(_busySince >= 0.0f) {
+			float end = _jobs.empty() ? std::min(now, std::max(_lastCompletion, _busySince)) : now;
+			work = end - _busySince;
+		}
+
+		float budget = substance_frameBudget;
+		_stats.Frames++;
+		_stats.LastFrameMs = work;
+		if(work > 0.0f) {
+			_stats.BusyFrames++;
+		}
+
+		if(budget > 0.0f) {
+			// Each frame grants the budget, the time above it is paid back by the next frames:
+			_debt = std::max(_debt + work - budget, 0.0f);
+			if(work > budget) {
+				_stats.OverrunFrames++;
+				_stats.OverrunMs += work - budget;
+				_stats.MaxOverrunMs = std::max(_stats.MaxOverrunMs, work - budget);
+			}
+		}
+		else {
+			_debt = 0.0f;
+		}
+
+		// Start the deferred run once a job is completed:
+		if(_deferred && (budget <= 0.0f || (int)_jobs.size() < std::max(substance_maxPendingJobs, 1))) {
+			_deferred = false;
+			runDeferred = true;
+		}
+	}
+
+	if(runDeferred) {
+		render(false);
+	}
+
+	CryAutoCriticalSection lock(_lock);
+	bool hold = _debt > 0.0f && !_jobs.empty();
+	if(_runCalls > 0) {
+		// Hold or resume once the runs in flight have returned:
+		hold = _held;
+	}
+
+	if(hold && !_held) {
+		renderer->hold();
+		_held = true;
+	}
+	else if(!hold && _held) {
+		renderer->resume();
+		_held = false;
+	}
+
+	if(_held) {
+		_stats.HeldFrames++;
+	}
+
+	_busySince = !_held && !_jobs.empty() ? now : -1.0f;
+	_stats.PendingJobs = (unsigned int)_jobs.size();
+}
+
+void RenderScheduler::beforeRun(SubstanceAir::Renderer* renderer, bool synchronous)
+{
+	CryAutoCriticalSection lock(_lock);
+	if(renderer != _renderer) {
+		return;
+	}
+
+	_runCalls++;
+	if(!synchronous || !_held) {
+		return;
+	}
+
+	// The held jobs are rendered along with the synchronous one, and accounted in this frame:
+	renderer->resume();
+	_held = false;
+	_busySince = getCurrentTime();
+}
+
+void RenderScheduler::afterRun(SubstanceAir::Renderer* renderer)
+{
+	CryAutoCriticalSection lock(_lock);
+	if(renderer == _renderer && _runCalls > 0) {
+		_runCalls--;
+	}
+}
+
+void RenderScheduler::jobStarted(SubstanceAir::Renderer* renderer, SubstanceAir::UInt runUid, float startTime)
+{
+	CryAutoCriticalSection lock(_lock);
+	if(renderer != _renderer) {
+		return;
+	}
+
+	if(_busySince < 0.0f && !_held) {
+		_busySince = startTime;
+	}
+
+	Job& job = _jobs[runUid];
+	job.startTime = startTime;
+	job.requested = false;
+}
+
+void RenderScheduler::OnRenderJobCompleted(ProceduralMaterialRenderUID renderUID, const SProceduralMaterialRenderJobStats& stats)
+{
+	CryAutoCriticalSection lock(_lock);
+	auto jit = _jobs.find(renderUID);
+	if(jit == _jobs.end()) {
+		return;
+	}
+
+	_lastCompletion = std::max(_lastCompletion, jit->second.startTime + stats.TotalMs);
+	_jobs.erase(jit);
+}
+
+SProceduralMaterialRenderBudgetStats RenderScheduler::getStats()
+{
+	CryAutoCriticalSection lock(_lock);
+	return _stats;
+}
+
+void RenderScheduler::dumpStats()
+{
+	SProceduralMaterialRenderBudgetStats stats = getStats();
+	CryLogAlways("Substance frame budget: %.2f ms, %d jobs in flight max", substance_frameBudget, substance_maxPendingJobs);
+	CryLogAlways("  %u frames, %u busy, %u held, %u over budget (%.2f ms total, %.2f ms max)",
+		stats.Frames, stats.BusyFrames, stats.HeldFrames, stats.OverrunFrames, stats.OverrunMs, stats.MaxOverrunMs);
+	CryLogAlways("  %u jobs in flight, %u deferred renders, last frame %.2f ms",
+		stats.PendingJobs, stats.DeferredRuns, stats.LastFrameMs);
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,131 @@
+/** @file RenderScheduler.h
+	@brief Header for the per-frame render budget of the gem renderer
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_RENDERSCHEDULER_H
+#define GEM_SUBSTANCE_RENDERSCHEDULER_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include "Substance/SubstanceBus.h"
+#include "Substance/framework/renderer.h"
+#include <CryThread.h>
+#include <map>
+#include <vector>
+
+#if defined(USE_SUBSTANCE)
+
+/**
+ Render queue and per-frame time budget of the gem renderer.
+
+ The graphs are queued with a priority class and a camera distance hint, and
+ pushed by render() with one job per class, the closest graphs first:
+ - Visible: Run_First | Run_Replace | Run_PreserveRun, ahead of all the queued
+   work, discarding the outdated computations but not the running job,
+ - Streaming: Run_First | Run_PreserveRun, ahead of the older jobs,
+ - Background: queued after the other jobs,
+ - EditorPreview: Run_Replace, discarding the outdated previews.
+ So during a fast camera move the graphs on screen are rendered before the
+ off-screen work queued in the previous frames.
+
+ The frame budget is set with substance_frameBudget (ms).
+
+ When the budget is set, RenderSync() doesn't block the frame anymore: the
+ render is run asynchronously, or deferred while substance_maxPendingJobs jobs
+ are in flight (the queued graphs are then rendered by the next run).
+ The render time of each frame is accounted in update(), and the renderer is
+ held with Renderer::hold() during the following frames until the time above
+ the budget is paid back, then resumed. The hold/resume calls are only made
+ once per frame, so a single frame can still go over the budget; the overruns
+ are counted in the stats.
+ Synchronous runs (blocking texture loads) always resume the renderer first.
+ The renderer is neither held nor resumed by update() while a run() call is in
+ flight on another thread, so a synchronous load is not held again before it
+ completes; the change is made by the first update() afterwards.
+*/
+class RenderScheduler : public SubstanceNotificationBus::Handler
+{
+public:
+	static RenderScheduler& instance();
+
+	/// Set the scheduled renderer (can be nullptr).
+	void setRenderer(SubstanceAir::Renderer* renderer);
+
+	/// Retrieve the run options of a priority class.
+	static SubstanceAir::UInt getRunOptions(ProceduralMaterialRenderPriority priority);
+
+	/// Queue a graph instance for the next render, distance < 0 if unknown.
+	void queue(GraphInstanceID graphInstanceID, ProceduralMaterialRenderPriority priority, float distance);
+
+	/// Render the queued graphs, asynchronously or within the frame budget.
+	/// Returns the UID of the run rendered last, or 0 if the render is synchronous or deferred.
+	SubstanceAir::UInt render(bool synchronous);
+
+	/// Check if the renders started with render() under the frame budget are pending.
+	bool isPending();
+
+	/// Account the render time of the frame and hold or resume the renderer, once per frame.
+	void update();
+
+	/// Called by RenderSettings before a run, a synchronous run would never complete with a held renderer.
+	void beforeRun(SubstanceAir::Renderer* renderer, bool synchronous);
+
+	/// Called by RenderSettings once a run returns.
+	void afterRun(SubstanceAir::Renderer* renderer);
+
+	/// Called by RenderSettings after an asynchronous run.
+	void jobStarted(SubstanceAir::Renderer* renderer, SubstanceAir::UInt runUid, float startTime);
+
+	/// Retrieve the budget counters.
+	SProceduralMaterialRenderBudgetStats getStats();
+
+	/// Write the budget counters in the log.
+	void dumpStats();
+
+	// Remove the completed jobs:
+	void OnRenderJobCompleted(ProceduralMaterialRenderUID renderUID, const SProceduralMaterialRenderJobStats& stats) override;
+
+protected:
+	RenderScheduler();
+
+	struct Job
+	{
+		float startTime;
+		bool requested;		// Started by render()
+	};
+
+	struct QueuedGraph
+	{
+		GraphInstanceID graphInstanceID;
+		ProceduralMaterialRenderPriority priority;
+		float distance;
+		AZ::u64 queueTime;	// Profiler time of the queue call, 0 if not profiled
+	};
+
+	// Push the queued graphs of a class, closest first, and lock them until unlockGraphs():
+	static int pushGraphs(SubstanceAir::Renderer* renderer, std::vector<QueuedGraph>& graphs, ProceduralMaterialRenderPriority priority,
+		std::vector<CryCriticalSection*>& locks);
+
+	// Release the render locks of the pushed graphs:
+	static void unlockGraphs(std::vector<CryCriticalSection*>& locks);
+
+	SubstanceAir::Renderer* _renderer;
+	std::vector<QueuedGraph> _queue;
+	std::map<SubstanceAir::UInt, Job> _jobs;
+	bool _deferred;
+	bool _held;
+	int _runCalls;			// run() calls in flight on the renderer
+	float _busySince;		// Start of the render time of the current frame, or < 0 if idle or held
+	float _lastCompletion;	// Time of the last output of the completed jobs
+	float _debt;			// Render time above the budget, to pay back
+
+	SProceduralMaterialRenderBudgetStats _stats;
+
+	CryCriticalSection _lock;
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_RENDERSCHEDULER_H
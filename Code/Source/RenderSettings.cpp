@@ -0,0 +1,151 @@
+/** @file RenderSettings.cpp
+	@brief Source File for the runtime render options of the gem renderer
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "RenderSettings.h"
+#include "RenderCallbacks.h"
+#include "RenderScheduler.h"
+#include "RendererPool.h"
+#include <ITimer.h>
+
+RenderSettings& RenderSettings::instance()
+{
+	static RenderSettings settings;
+	return settings;
+}
+
+RenderSettings::RenderSettings() : _renderer(nullptr), _callbacks(nullptr), _pool(nullptr), _modified(true), _applyCount(0)
+{
+}
+
+SubstanceAir::RenderOptions RenderSettings::readOptions()
+{
+	// Values are clamped to the ranges supported by the engine:
+	SubstanceAir::RenderOptions options;
+	options.mCoresCount = (size_t)std::min(std::max(substance_coreCount, 1), 32);
+	options.mMemoryBudget = (size_t)std::max(substance_memoryBudget, 16)*1024*1024;
+	return options;
+}
+
+void RenderSettings::setRenderer(SubstanceAir::Renderer* renderer, SubstanceRenderCallbacks* callbacks)
+{
+	CryAutoCriticalSection lock(_lock);
+	_renderer = renderer;
+	_callbacks = callbacks;
+}
+
+void RenderSettings::setRendererPool(RendererPool* pool)
+{
+	CryAutoCriticalSection lock(_lock);
+	_pool = pool;
+	if(pool) {
+		apply(pool);
+	}
+}
+
+void RenderSettings::invalidate()
+{
+	CryAutoCriticalSection lock(_lock);
+	_modified = true;
+
+	// The workers apply them between their tasks, so they are not waiting for a run of the gem renderer:
+	if(_pool) {
+		apply(_pool);
+	}
+}
+
+void RenderSettings::apply(SubstanceAir::Renderer* renderer, bool force)
+{
+	if(!_modified && !force) {
+		return;
+	}
+
+	SubstanceAir::RenderOptions options = readOptions();
+	if(force || _applyCount == 0 || options.mCoresCount != _options.mCoresCount || options.mMemoryBudget != _options.mMemoryBudget) {
+		renderer->setOptions(options);
+		_options = options;
+		_applyCount++;
+		CryLog("Substance render options: %u cores, %u MB", (unsigned int)options.mCoresCount, (unsigned int)(options.mMemoryBudget/(1024*1024)));
+	}
+
+	_modified = false;
+}
+
+void RenderSettings::apply(RendererPool* pool)
+{
+	SubstanceAir::RenderOptions options = readOptions();
+	pool->setOptions((int)options.mCoresCount, options.mMemoryBudget);
+}
+
+SubstanceAir::UInt RenderSettings::run(SubstanceAir::Renderer* renderer, SubstanceAir::UInt runOptions, size_t userData)
+{
+	// The options are applied between two runs:
+	SubstanceAir::RenderOptions options;
+	SubstanceRenderCallbacks* callbacks;
+	{
+		CryAutoCriticalSection lock(_lock);
+		apply(renderer, false);
+		options = _options;
+		callbacks = renderer == _renderer ? _callbacks : nullptr;
+	}
+	float startTime = gEnv->pTimer->GetAsyncTime().GetMilliSeconds();
+
+	// A held renderer must be resumed for a synchronous run to complete, and not held again meanwhile:
+	bool synchronous = !(runOptions & SubstanceAir::Renderer::Run_Asynchronous);
+	RenderScheduler::instance().beforeRun(renderer, synchronous);
+
+	// A synchronous run must not hold the lock while rendering:
+	SubstanceAir::UInt runUid = renderer->run(runOptions, userData);
+	RenderScheduler::instance().afterRun(renderer);
+	logDEBUG("Render job UID = "<<runUid<<" ("<<options.mCoresCount<<" cores, "<<options.mMemoryBudget/(1024*1024)<<" MB)");
+
+	if(runUid != 0 && callbacks) {
+		callbacks->jobStarted(runUid, startTime);
+	}
+
+	if(runUid != 0 && !synchronous) {
+		RenderScheduler::instance().jobStarted(renderer, runUid, startTime);
+	}
+
+	return runUid;
+}
+
+void RenderSettings::commit()
+{
+	// Called from the console thread, while the loader threads may be pushing graphs:
+	CryAutoCriticalSection renderLock(_renderLock);
+	SubstanceAir::Renderer* renderer;
+	{
+		CryAutoCriticalSection lock(_lock);
+		renderer = _renderer;
+		if(!renderer) {
+			return;
+		}
+		apply(renderer, true);
+	}
+
+	// The memory budget is only applied by a run:
+	run(renderer, SubstanceAir::Renderer::Run_Asynchronous);
+}
+
+SubstanceAir::RenderOptions RenderSettings::getOptions()
+{
+	CryAutoCriticalSection lock(_lock);
+	return _options;
+}
+
+void RenderSettings::dumpStats()
+{
+	CryAutoCriticalSection lock(_lock);
+	SubstanceAir::RenderOptions pending = readOptions();
+	CryLogAlways("Substance render options: %u cores, %u MB (applied %u times)%s",
+		(unsigned int)_options.mCoresCount, (unsigned int)(_options.mMemoryBudget/(1024*1024)), _applyCount,
+		(pending.mCoresCount != _options.mCoresCount || pending.mMemoryBudget != _options.mMemoryBudget) ? ", changes pending until the next render" : "");
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,92 @@
+/** @file RenderSettings.h
+	@brief Header for the runtime render options of the gem renderer
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_RENDERSETTINGS_H
+#define GEM_SUBSTANCE_RENDERSETTINGS_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include "Substance/framework/renderer.h"
+#include <CryThread.h>
+
+#if defined(USE_SUBSTANCE)
+
+class SubstanceRenderCallbacks;
+class RendererPool;
+
+/**
+ Render options of the gem renderer, read from substance_coreCount and
+ substance_memoryBudget.
+
+ The cvar changes only flag the options as modified: they are applied with
+ Renderer::setOptions() right before the next run, or immediately with
+ substance_commitRenderOptions. The engine applies them to the current and
+ pending jobs as well, not only to the jobs run afterwards.
+ The renderers of the pool share the same options: each worker applies its
+ share of the cores and memory budget before its next task.
+ All the runs of the gem renderer must go through this object, the asynchronous
+ runs are tracked by RenderScheduler for the frame budget.
+ The push and run calls of the gem renderer are not thread safe: a push and the
+ run of its job are made under the render lock, from any thread.
+*/
+class RenderSettings
+{
+public:
+	static RenderSettings& instance();
+
+	/// Set the gem renderer used by commit() and its callbacks notified of the runs (can be nullptr).
+	void setRenderer(SubstanceAir::Renderer* renderer, SubstanceRenderCallbacks* callbacks);
+
+	/// Set the renderer pool of the texture loads (can be nullptr).
+	void setRendererPool(RendererPool* pool);
+
+	/// Flag the options as modified, they are applied before the next run.
+	void invalidate();
+
+	/// Run the renderer, applying the modified options first.
+	SubstanceAir::UInt run(SubstanceAir::Renderer* renderer,
+		SubstanceAir::UInt runOptions = SubstanceAir::Renderer::Run_Default, size_t userData = 0);
+
+	/// Apply the options immediately (an empty asynchronous run applies the memory budget).
+	void commit();
+
+	/// Retrieve the lock of the push and run calls on the gem renderer.
+	CryCriticalSection& getRenderLock() { return _renderLock; }
+
+	/// Retrieve the options in effect.
+	SubstanceAir::RenderOptions getOptions();
+
+	/// Write the options in effect in the log.
+	void dumpStats();
+
+	/// Read the options from the cvars.
+	static SubstanceAir::RenderOptions readOptions();
+
+protected:
+	RenderSettings();
+
+	// Apply the modified options, the lock must be held:
+	void apply(SubstanceAir::Renderer* renderer, bool force);
+
+	// Share the options between the renderers of a pool, the lock must be held:
+	void apply(RendererPool* pool);
+
+	SubstanceAir::Renderer* _renderer;
+	SubstanceRenderCallbacks* _callbacks;
+	RendererPool* _pool;
+	SubstanceAir::RenderOptions _options;
+	bool _modified;
+	unsigned int _applyCount;
+
+	CryCriticalSection _lock;
+
+	// Lock on the gem renderer push/run calls, taken before _lock:
+	CryCriticalSection _renderLock;
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_RENDERSETTINGS_H
@@ -0,0 +1,244 @@
+/** @file RendererPool.cpp
+	@brief Source File for the pool of substance renderers
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include "RendererPool.h"
+
+#if defined(USE_SUBSTANCE) || defined(AZ_TESTS_ENABLED)
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <memory>
+
+// Minimum memory budget of a renderer:
+static const size_t kMinMemoryBudget = 16*1024*1024;
+
+SubstanceAir::RenderOptions RendererPool::getWorkerOptions(int size, int coreCount, size_t memoryBudget)
+{
+	size = std::max(size, 1);
+
+	SubstanceAir::RenderOptions options;
+	options.mCoresCount = (size_t)std::max(coreCount/size, 1);
+	options.mMemoryBudget = std::max(memoryBudget/size, kMinMemoryBudget);
+	return options;
+}
+
+RendererPool::RendererPool(int size, int coreCount, size_t memoryBudget, const RendererFactory& factory)
+	: _next(0), _queued(0), _running(0), _stop(false), _optionsVersion(0)
+{
+	memset(&_stats, 0, sizeof(_stats));
+
+	_options = getWorkerOptions(size, coreCount, memoryBudget);
+	size = std::max(size, 1);
+	for(int i=0; i<size; ++i) {
+		Worker* worker = new Worker();
+		worker->renderer = factory ? factory(_options) : nullptr;
+		worker->optionsVersion = _optionsVersion;
+		_workers.push_back(worker);
+	}
+
+	// The threads are started once all the workers exist, as they steal from each other:
+	for(int i=0; i<size; ++i) {
+		_workers[i]->thread = std::thread(&RendererPool::work, this, i);
+	}
+}
+
+RendererPool::~RendererPool()
+{
+	cancelAll();
+
+	{
+		CryAutoCriticalSection lock(_lock);
+		_stop = true;
+		_wakeup.Notify();
+	}
+
+	for(auto worker: _workers) {
+		worker->thread.join();
+		delete worker->renderer;
+		delete worker;
+	}
+}
+
+void RendererPool::setOptions(int coreCount, size_t memoryBudget)
+{
+	SubstanceAir::RenderOptions options = getWorkerOptions((int)_workers.size(), coreCount, memoryBudget);
+
+	CryAutoCriticalSection lock(_lock);
+	if(options.mCoresCount != _options.mCoresCount || options.mMemoryBudget != _options.mMemoryBudget) {
+		_options = options;
+		_optionsVersion++;
+	}
+}
+
+void RendererPool::updateOptions(Worker* worker)
+{
+	SubstanceAir::RenderOptions options;
+	{
+		CryAutoCriticalSection lock(_lock);
+		if(worker->optionsVersion == _optionsVersion) {
+			return;
+		}
+		options = _options;
+		worker->optionsVersion = _optionsVersion;
+	}
+
+	// The renderer is only used by its worker thread, between two tasks:
+	if(worker->renderer) {
+		worker->renderer->setOptions(options);
+	}
+}
+
+void RendererPool::submit(const Task& task)
+{
+	Worker* worker = _workers[_next++ % _workers.size()];
+	{
+		// The task is queued and counted at once, so that wait() never misses it:
+		CryAutoCriticalSection lock(_lock);
+		{
+			CryAutoCriticalSection workerLock(worker->lock);
+			worker->tasks.push_back(task);
+		}
+		_queued++;
+		_wakeup.NotifySingle();
+	}
+}
+
+bool RendererPool::run(const Task& task)
+{
+	// A cancelled task is destroyed without running, which breaks the promise and releases the caller:
+	auto done = std::make_shared<std::promise<void>>();
+	auto ran = std::make_shared<bool>(false);
+	std::future<void> future = done->get_future();
+	submit([task, done, ran](SubstanceAir::Renderer* renderer) {
+		task(renderer);
+		*ran = true;
+		done->set_value();
+	});
+	done.reset();
+
+	future.wait();
+	return *ran;
+}
+
+void RendererPool::wait()
+{
+	CryAutoCriticalSection lock(_lock);
+	while(_queued != 0 || _running != 0) {
+		_idle.Wait(_lock);
+	}
+}
+
+void RendererPool::cancelAll()
+{
+	std::vector<Task> dropped;
+	{
+		CryAutoCriticalSection lock(_lock);
+		for(auto worker: _workers) {
+			CryAutoCriticalSection workerLock(worker->lock);
+			dropped.insert(dropped.end(), worker->tasks.begin(), worker->tasks.end());
+			worker->tasks.clear();
+		}
+		_queued -= (int)dropped.size();
+		_stats.cancelled += (unsigned int)dropped.size();
+		_idle.Notify();
+	}
+
+	// Release the waiting callers before waiting for the running tasks:
+	dropped.clear();
+
+	CryAutoCriticalSection lock(_lock);
+	while(_running != 0) {
+		_idle.Wait(_lock);
+	}
+}
+
+RendererPool::Stats RendererPool::getStats()
+{
+	CryAutoCriticalSection lock(_lock);
+	Stats stats = _stats;
+	stats.queued = (unsigned int)_queued;
+	return stats;
+}
+
+bool RendererPool::takeTask(int index, Task& task)
+{
+	bool stolen = false;
+	{
+		Worker* worker = _workers[index];
+		CryAutoCriticalSection workerLock(worker->lock);
+		if(!worker->tasks.empty()) {
+			task = std::move(worker->tasks.front());
+			worker->tasks.pop_front();
+		}
+	}
+
+	// Steal the oldest task of the most loaded worker:
+	while(!task) {
+		Worker* victim = nullptr;
+		size_t count = 0;
+		for(auto worker: _workers) {
+			CryAutoCriticalSection workerLock(worker->lock);
+			if(worker->tasks.size() > count) {
+				victim = worker;
+				count = worker->tasks.size();
+			}
+		}
+
+		if(!victim) {
+			return false;
+		}
+
+		// The victim may have been emptied meanwhile, look again:
+		CryAutoCriticalSection workerLock(victim->lock);
+		if(!victim->tasks.empty()) {
+			task = std::move(victim->tasks.front());
+			victim->tasks.pop_front();
+			stolen = true;
+		}
+	}
+
+	CryAutoCriticalSection lock(_lock);
+	_queued--;
+	_running++;
+	if(stolen) {
+		_stats.steals++;
+	}
+
+	return true;
+}
+
+void RendererPool::work(int index)
+{
+	Worker* worker = _workers[index];
+	Task task;
+	for(;;) {
+		if(takeTask(index, task)) {
+			updateOptions(worker);
+			task(worker->renderer);
+			task = nullptr;
+
+			CryAutoCriticalSection lock(_lock);
+			_running--;
+			_stats.tasks++;
+			if(_running == 0) {
+				_idle.Notify();
+			}
+			continue;
+		}
+
+		CryAutoCriticalSection lock(_lock);
+		while(!_stop && _queued == 0) {
+			_wakeup.Wait(_lock);
+		}
+		if(_stop) {
+			return;
+		}
+	}
+}
+
+#endif // USE_SUBSTANCE || AZ_TESTS_ENABLED
@@ -0,0 +1,119 @@
+/** @file RendererPool.h
+	@brief Header for the pool of substance renderers
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_RENDERERPOOL_H
+#define GEM_SUBSTANCE_RENDERERPOOL_H
+#pragma once
+
+#include "Substance/framework/renderer.h"
+#include <CryThread.h>
+
+// The test builds link the stand-in engine of Tests/StandInRenderer.cpp on the other platforms:
+#if defined(USE_SUBSTANCE) || defined(AZ_TESTS_ENABLED)
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/**
+ Pool of renderers rendering independent graph instances in parallel.
+
+ Each worker thread owns a renderer with its share of the cores and of the
+ memory budget, and runs its tasks synchronously on it. The tasks are spread
+ across the worker queues, and an idle worker steals the oldest task of the
+ most loaded worker, so that a level with dozens of small materials keeps all
+ the workers busy even when the tasks have very different costs.
+ A graph instance must not be rendered by two tasks at the same time.
+*/
+class RendererPool
+{
+public:
+	/// Task run on a worker, with the renderer of the worker.
+	typedef std::function<void(SubstanceAir::Renderer* renderer)> Task;
+
+	/// Create the renderer of a worker (can return nullptr for tasks which don't render).
+	typedef std::function<SubstanceAir::Renderer*(const SubstanceAir::RenderOptions& options)> RendererFactory;
+
+	struct Stats
+	{
+		unsigned int tasks;		// Completed tasks
+		unsigned int steals;	// Tasks run by another worker than the one they were queued on
+		unsigned int cancelled;	// Tasks dropped by cancelAll()
+		unsigned int queued;	// Tasks waiting for a worker
+	};
+
+	/// Start size workers sharing coreCount cores and memoryBudget bytes.
+	RendererPool(int size, int coreCount, size_t memoryBudget, const RendererFactory& factory);
+
+	/// Cancel the queued tasks, wait for the running ones and delete the renderers.
+	~RendererPool();
+
+	/// Retrieve the number of workers.
+	int getSize() const { return (int)_workers.size(); }
+
+	/// Retrieve the render options of each worker.
+	static SubstanceAir::RenderOptions getWorkerOptions(int size, int coreCount, size_t memoryBudget);
+
+	/// Share coreCount cores and memoryBudget bytes between the workers, each one applies its share before its next task.
+	void setOptions(int coreCount, size_t memoryBudget);
+
+	/// Queue a task on the next worker.
+	void submit(const Task& task);
+
+	/// Queue a task and wait for its completion, returns false if it was cancelled.
+	bool run(const Task& task);
+
+	/// Wait until all the queued tasks are completed.
+	void wait();
+
+	/// Drop the queued tasks and wait for the running ones (not from a task).
+	void cancelAll();
+
+	/// Retrieve the counters.
+	Stats getStats();
+
+protected:
+	struct Worker
+	{
+		SubstanceAir::Renderer* renderer;
+		unsigned int optionsVersion;	// Version of the options applied to the renderer
+		std::deque<Task> tasks;
+		CryCriticalSection lock;
+		std::thread thread;
+	};
+
+	// Worker thread loop:
+	void work(int index);
+
+	// Take the next task of a worker, or steal one from the most loaded worker:
+	bool takeTask(int index, Task& task);
+
+	// Apply the options set since the last task of a worker:
+	void updateOptions(Worker* worker);
+
+	std::vector<Worker*> _workers;
+	std::atomic<unsigned int> _next;
+
+	// Number of queued and running tasks, and the wakeup of the idle workers:
+	CryCriticalSection _lock;
+	CryConditionVariable _wakeup;
+	CryConditionVariable _idle;
+	int _queued;
+	int _running;
+	bool _stop;
+
+	// Options of the workers, set from any thread and applied by the worker threads:
+	SubstanceAir::RenderOptions _options;
+	unsigned int _optionsVersion;
+
+	Stats _stats;
+};
+
+#endif // USE_SUBSTANCE || AZ_TESTS_ENABLED
+
+#endif //GEM_SUBSTANCE_RENDERERPOOL_H
@@ -17,6 +17,7 @@
 */
 #include "StdAfx.h"
 #include <AzCore/IO/SystemFile.h>
+#include <CryFile.h>
 #include <AzToolsFramework/API/EditorAssetSystemAPI.h>
 
 AZStd::string getAbsoluteAssetPath(const AZStd::string& src)
@@ -43,4 +44,15 @@ AZStd::string getAbsoluteAssetPath(const AZStd::string& src)
 	}
 
 	return resolvedPath;
+}
+
+bool readAssetFile(const AZStd::string& path, std::vector<char>& data)
+{
+	CCryFile file(path.c_str(), "rb");
+	if(!file.GetHandle()) {
+		return false;
+	}
+
+	data.resize(file.GetLength());
+	return file.ReadRaw(data.data(), data.size()) == data.size();
 }
\ No newline at end of file
@@ -71,8 +71,25 @@ AZStd::string string_format( const AZStd::string& format, Args ... args )
 //CVars
 extern int substance_coreCount;
 extern int substance_memoryBudget;
+extern int substance_materialCacheSize;
+extern int substance_resultLifetime;
+extern int substance_textureCache;
+extern int substance_textureCacheSize;
+extern int substance_textureStreaming;
+extern int substance_zeroCopyOutputs;
+extern int substance_encodeThreads;
+extern float substance_frameBudget;
+extern int substance_maxPendingJobs;
+extern float substance_visibleDistance;
+extern int substance_rendererPoolSize;
+extern int substance_pruneOutputs;
+extern int substance_specializeInputs;
+extern int substance_renderCacheSpill;
+extern int substance_renderCacheSpillMemory;
+extern int substance_profile;
 
 AZStd::string getAbsoluteAssetPath(const AZStd::string& path);
+bool readAssetFile(const AZStd::string& path, std::vector<char>& data);
 
 #define DIMOF(x) (sizeof(x)/sizeof(x[0]))
 #endif
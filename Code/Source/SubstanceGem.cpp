@@ -30,6 +30,17 @@
 
 #include <Substance/framework/package.h>
 #include <SubstanceMaterial.h>
+#include <PackageCache.h>
+#include <MaterialRegistry.h>
+#include <TextureLoadHandler.h>
+#include <TextureCache.h>
+#include <RenderCallbacks.h>
+#include <RenderSettings.h>
+#include <RenderScheduler.h>
+#include <RendererPool.h>
+#include <GlobalCallbacks.h>
+#include <RenderCacheSpill.h>
+#include <RenderProfiler.h>
 #include <GraphInstance.h>
 #include <GraphOutput.h>
 #include <Substance/framework/renderer.h>
@@ -37,137 +48,26 @@
 //Cvars
 int substance_coreCount;
 int substance_memoryBudget;
+int substance_materialCacheSize;
+int substance_resultLifetime;
+int substance_textureCache;
+int substance_textureCacheSize;
+int substance_textureStreaming;
+int substance_zeroCopyOutputs;
+int substance_encodeThreads;
+float substance_frameBudget;
+int substance_maxPendingJobs;
+float substance_visibleDistance;
+int substance_rendererPoolSize;
+int substance_pruneOutputs;
+int substance_specializeInputs;
+int substance_renderCacheSpill;
+int substance_renderCacheSpillMemory;
+int substance_profile;
 ICVar* substance_engineLibrary;
 
 static const char* kSubstance_EngineLibrary_Default = "sse2";
 
-//////////////////////////////////////////////////////////////////////////
-struct CTextureLoadHandler_Substance : public ITextureLoadHandler
-{
-	CTextureLoadHandler_Substance(SubstanceAir::Renderer* renderer) : _renderer(renderer)
-	{
-	}
-
-	virtual bool SupportsExtension(const char* ext) const override
-	{
-		if (!strcmp(ext, PROCEDURALTEXTURE_EXTENSION))
-		{
-			return true;
-		}
-
-		return false;
-	}
-
-	virtual bool LoadTextureData(const char* path, STextureLoadData& loadData) override
-	{
-		logDEBUG("in LoadTextureData with path: "<<path);
-
-		// Read the XML file:
-
-		logDEBUG("Loading XML sub texture: "<<path);
-		auto resolvedPath = getAbsoluteAssetPath(path);
-
-		XmlNodeRef texNode = GetISystem()->LoadXmlFromFile(resolvedPath.c_str());
-		if(!texNode) {
-			logERROR("Cannot load XML texture from file "<< resolvedPath.c_str());
-			return false;
-		}
-		
-		// read the smtl filename:
-		const char* smtl;
-		if (!texNode->getAttr("Material", &smtl))
-		{
-			logERROR("No material parameter for texture "<< resolvedPath.c_str());
-			return false;
-		}
-		
-		// Now load the substance material:
-		logDEBUG("Loading substance material from file: "<<smtl);
-		SubstanceMaterial smat(smtl);
-
-		// read the output id:
-		unsigned int id = 0;
-		if (!texNode->getAttr("OutputID", id))
-		{
-			logERROR("No output ID parameter for texture "<< resolvedPath.c_str());
-			return false;
-		}
-
-		logDEBUG("Generating output with ID: "<<id);
-		auto graph = (GraphInstance*)smat.GetGraphInstance(0);
-		auto out = (GraphOutput*)graph->GetOutputByID(id);
-
-		logDEBUG("Retrieved graph output with label: "<<out->GetLabel());
-
-		// Mark this output as dirty:
-		out->SetDirty(); 
-
-		// Okay, so now we retrieve the actual output instance:
-		auto inst = out->getInstance();
-
-		{
-			logDEBUG("Pushing graph instance");
-			_renderer->push(*(graph->getInstance()));
-
-			logDEBUG("Render the output...");
-			unsigned int res = _renderer->run();
-			logDEBUG("Render job UID = "<<res);
-
-			//  So now we should be able to grab our result:
-			auto result = inst->grabResult();
-			if(!result) {
-				logERROR("Invalid result!")
-			}
-			else {
-				auto stex = result->getTexture();
-				logDEBUG("MipmapCount="<< (int)stex.mipmapCount);
-				logDEBUG("Width="<< (int)stex.level0Width);
-				logDEBUG("Height="<< (int)stex.level0Height);
-				logDEBUG("PixelFormat="<< (int)stex.pixelFormat);
-				logDEBUG("ChannelsOrder="<< (int)stex.channelsOrder);
-
-				loadData.m_DataSize = 0;
-				int num = (int)stex.mipmapCount;
-				int div = 1;
-				for(int i=0;i<num;++i) {
-					int ww = (int)stex.level0Width/div;
-					int hh = (int)stex.level0Height/div;
-					div *= 2;
-					loadData.m_DataSize += ww*hh;
-				}
-
-				// Retrieve the pixel size:
-				loadData.m_DataSize *= out->GetBytesPerPixel((int)stex.pixelFormat);
-
-				loadData.m_Width = (int)stex.level0Width;
-				loadData.m_Height = (int)stex.level0Height;
-				loadData.m_NumMips = (int)stex.mipmapCount;
-				loadData.m_nFlags = out->GetChannel()==GraphOutputChannel::Normal ? FT_TEX_NORMAL_MAP : 0;
-				loadData.m_Format = out->GetEngineFormat((int)stex.pixelFormat);
-
-				if((int)stex.channelsOrder != 0) {
-					logERROR("Unexpected channel order: "<<(int)stex.channelsOrder);
-				}
-
-				loadData.m_pData = new char[loadData.m_DataSize];
-				memcpy(loadData.m_pData, stex.buffer, loadData.m_DataSize);
-
-				return true;
-			}
-		}
-
-		return false;
-	}
-
-	virtual void Update() override
-	{
-		// No op.
-	}
-
-private:
-	SubstanceAir::Renderer* _renderer;
-};
-
 //////////////////////////////////////////////////////////////////////////
 void OnSubstanceRuntimeBudgetChangled(bool budgetChanged)
 {
@@ -182,27 +82,117 @@ void OnSubstanceRuntimeBudgetChangled(bool budgetChanged)
 void OnCVarCoreCountChange(ICVar *pArgs)
 {
 	substance_coreCount = pArgs->GetIVal();
+	RenderSettings::instance().invalidate();
 	OnSubstanceRuntimeBudgetChangled(false);
 }
 
 void OnCVarMemoryBudgetChange(ICVar* pArgs)
 {
 	substance_memoryBudget = pArgs->GetIVal();
+	SubstanceGlobalCallbacks::instance().setBudget((size_t)std::max(substance_memoryBudget, 0)*1024*1024);
+	RenderSettings::instance().invalidate();
 	OnSubstanceRuntimeBudgetChangled(false);
 }
 
+void OnCVarProfileChange(ICVar* pArgs)
+{
+	substance_profile = pArgs->GetIVal();
+	RenderProfiler::instance().setEnabled(substance_profile != 0);
+}
+
 void CommitRenderOptions(IConsoleCmdArgs* pArgs)
 {
+	RenderSettings::instance().commit();
 	OnSubstanceRuntimeBudgetChangled(true);
 }
 
+void RenderOptionsStats(IConsoleCmdArgs* pArgs)
+{
+	RenderSettings::instance().dumpStats();
+}
+
+void RenderBudgetStats(IConsoleCmdArgs* pArgs)
+{
+	RenderScheduler::instance().dumpStats();
+}
+
+void PackageCacheStats(IConsoleCmdArgs* pArgs)
+{
+	PackageCache::instance().dumpStats();
+}
+
+void MaterialRegistryStats(IConsoleCmdArgs* pArgs)
+{
+	MaterialRegistry::instance().dumpStats();
+}
+
+void TextureCacheStats(IConsoleCmdArgs* pArgs)
+{
+	TextureCache::instance().dumpStats();
+}
+
+void TextureCacheClear(IConsoleCmdArgs* pArgs)
+{
+	TextureCache::instance().clear();
+}
+
+void RenderCacheSpillStats(IConsoleCmdArgs* pArgs)
+{
+	RenderCacheSpill::instance().dumpStats();
+}
+
+void MemoryPoolStats(IConsoleCmdArgs* pArgs)
+{
+	SubstanceGlobalCallbacks::instance().dumpStats();
+}
+
+void MaterialStats(IConsoleCmdArgs* pArgs)
+{
+	bool sortByTime = pArgs->GetArgCount() > 1 && !strcmp(pArgs->GetArg(1), "time");
+	int count = pArgs->GetArgCount() > 2 ? atoi(pArgs->GetArg(2)) : 20;
+	MaterialRegistry::instance().dumpMaterialStats(sortByTime, count);
+
+	// Total of the sizer tree reported to the engine memory statistics:
+	if (ICrySizer* pSizer = GetISystem()->CreateSizer())
+	{
+		EBUS_EVENT(SubstanceRequestBus, GetMemoryUsage, pSizer);
+		CryLogAlways("Substance memory: %.2f MB in total", pSizer->GetTotalSize()/(1024.0f*1024.0f));
+		pSizer->Release();
+	}
+}
+
+void ProfileDump(IConsoleCmdArgs* pArgs)
+{
+	const char* path = pArgs->GetArgCount() > 1 ? pArgs->GetArg(1) : "@log@/substance_trace.json";
+	int count = RenderProfiler::instance().dump(path);
+	if(count >= 0) {
+		CryLogAlways("Substance profiler: %d spans written to %s", count, path);
+	}
+}
+
+void ProfileClear(IConsoleCmdArgs* pArgs)
+{
+	RenderProfiler::instance().clear();
+}
+
 //////////////////////////////////////////////////////////////////////////
-SubstanceGem::SubstanceGem() : CryHooksModule(), m_SubstanceLib(nullptr), m_SubstanceLibAPI(nullptr), m_TextureLoadHandler(nullptr) 
+SubstanceGem::SubstanceGem() : CryHooksModule(), m_SubstanceLib(nullptr), m_SubstanceLibAPI(nullptr), m_TextureLoadHandler(nullptr), m_RendererPool(nullptr) 
 { 
 	// Create the renderer:
 	logDEBUG("Creating SubstanceGem renderer.");
+
+	// The global callbacks must be set before any render:
+	SubstanceAir::GlobalCallbacks::setInstance(&SubstanceGlobalCallbacks::instance());
+
 	_renderer = new SubstanceAir::Renderer();
 
+	// The callbacks must outlive the renderer:
+	_renderCallbacks = new SubstanceRenderCallbacks();
+	_renderer->setRenderCallbacks(_renderCallbacks);
+
+	// The cvar render options are applied before the runs, which are notified to the callbacks:
+	RenderSettings::instance().setRenderer(_renderer, _renderCallbacks);
+
 	auto ver = _renderer->getCurrentVersion();
 	logDEBUG("Substance engine version: "<<ver.versionMajor<<"."
 		<<ver.versionMinor<<"."<< ver.versionPatch);
@@ -211,7 +201,9 @@ SubstanceGem::SubstanceGem() : CryHooksModule(), m_SubstanceLib(nullptr), m_Subs
 SubstanceGem::~SubstanceGem() 
 { 
 	logDEBUG("Destroying SubstanceAir renderer.");
+	RenderSettings::instance().setRenderer(nullptr, nullptr);
 	delete _renderer;
+	delete _renderCallbacks;
 }
 
 void SubstanceGem::PostGameInitialize()
@@ -221,6 +213,8 @@ void SubstanceGem::PostGameInitialize()
 	if (LoadEngineLibrary())
 	{
 		RegisterTextureHandler();
+		RenderScheduler::instance().setRenderer(_renderer);
+		AZ::TickBus::Handler::BusConnect();
 		CryLogAlways("Substance Initialized");
 	}
 	else
@@ -270,19 +264,77 @@ void SubstanceGem::RegisterConsole()
 {
 	REGISTER_CVAR_CB(substance_coreCount, 32, 0, "Set how many CPU Cores are used for Substance (32 = All). Only relevant when using CPU based engines.", OnCVarCoreCountChange);
 	REGISTER_CVAR_CB(substance_memoryBudget, 512, 0, "Set how much memory is used for Substance in MB", OnCVarMemoryBudgetChange);
+	SubstanceGlobalCallbacks::instance().setBudget((size_t)std::max(substance_memoryBudget, 0)*1024*1024);
+	REGISTER_CVAR(substance_materialCacheSize, 16, 0, "Set how many unreferenced procedural materials are kept loaded");
+	REGISTER_CVAR(substance_resultLifetime, 10000, 0, "Set how long (in ms) the outputs rendered along with a requested procedural texture are kept for the next texture requests");
+	REGISTER_CVAR(substance_textureCache, 1, 0, "Enable the persistent cache of rendered procedural textures");
+	REGISTER_CVAR(substance_textureCacheSize, 1024, 0, "Set the maximum size of the persistent procedural texture cache in MB");
+	REGISTER_CVAR(substance_textureStreaming, 0, 0, "Default load mode of the procedural textures when not specified in the material: 0 = blocking, 1 = streaming with placeholder textures");
+	REGISTER_CVAR(substance_zeroCopyOutputs, 1, 0, "Hand the rendered texture buffers over to the engine without copying them when possible");
+	REGISTER_CVAR(substance_encodeThreads, 0, 0, "Set in how many jobs the outputs with an Encode setting are block compressed (0 = One per job worker)");
+	REGISTER_CVAR(substance_frameBudget, 0.0f, 0, "Set how much time (in ms) per frame the substance renderer can work on the RenderSync renders, which are then run asynchronously (0 = No budget, RenderSync blocks the frame)");
+	REGISTER_CVAR(substance_maxPendingJobs, 4, 0, "Set how many render jobs can be in flight under the frame budget before the RenderSync renders are deferred");
+	REGISTER_CVAR(substance_rendererPoolSize, 0, 0, "Set how many renderers share the cores and the memory budget to render the procedural textures of different materials in parallel (0 = Gem renderer only). Read at startup");
+	REGISTER_CVAR(substance_pruneOutputs, 1, 0, "Relink the procedural materials without the outputs they disable (Enabled=0), so that the engine never computes the other ones (game only). Applied to the materials loaded afterwards");
+	REGISTER_CVAR(substance_specializeInputs, 1, 0, "Ignore the runtime changes of the inputs marked Static in the materials, and cache the intermediate results of the graphs around the inputs changed at runtime (game only)");
+	REGISTER_CVAR(substance_renderCacheSpill, 0, 0, "Set the size in MB of the scratch file where the intermediate results evicted by the substance engine are compressed, instead of being recomputed (0 = Disabled). Read at startup, ignored in the editor and with a renderer pool");
+	REGISTER_CVAR(substance_renderCacheSpillMemory, 64, 0, "Set the maximum size in MB of the evicted intermediate results kept in memory once the render cache spill file is full, the next ones are still kept and a warning is logged. Read at startup");
+	REGISTER_CVAR_CB(substance_profile, 0, 0, "Record the spans of the procedural texture renders (queue wait, output computation, result grab and copy) for substance_profileDump", OnCVarProfileChange);
+	REGISTER_CVAR(substance_visibleDistance, 50.0f, 0, "Set the camera distance (in m) under which the graphs queued with a distance hint are rendered with the Visible priority, rather than Background");
 
 	substance_engineLibrary = REGISTER_STRING("substance_engineLibrary", kSubstance_EngineLibrary_Default, VF_NULL, "Set engine to load for substance plugin (PC: sse2/d3d10/d3d11)");
 
 	REGISTER_COMMAND("substance_commitRenderOptions", CommitRenderOptions, VF_NULL, "Apply cpu and memory changes immediately, rather than wait for next render call");
+	REGISTER_COMMAND("substance_renderOptionsStats", RenderOptionsStats, VF_NULL, "Display the render options in effect for the substance renderer");
+	REGISTER_COMMAND("substance_renderBudgetStats", RenderBudgetStats, VF_NULL, "Display the frame budget counters of the substance renderer");
+	REGISTER_COMMAND("substance_packageCacheStats", PackageCacheStats, VF_NULL, "Display the substance package cache counters");
+	REGISTER_COMMAND("substance_materialRegistryStats", MaterialRegistryStats, VF_NULL, "Display the procedural material registry counters");
+	REGISTER_COMMAND("substance_textureCacheStats", TextureCacheStats, VF_NULL, "Display the procedural texture cache hit rate and size");
+	REGISTER_COMMAND("substance_textureCacheClear", TextureCacheClear, VF_NULL, "Remove all the textures from the procedural texture cache");
+	REGISTER_COMMAND("substance_renderCacheSpillStats", RenderCacheSpillStats, VF_NULL, "Display the evictions, fetches and sizes of the substance render cache spill tier");
+	REGISTER_COMMAND("substance_memoryPoolStats", MemoryPoolStats, VF_NULL, "Display the live, peak and cached bytes of the substance memory pool, its fragmentation and the live bytes of each material");
+	REGISTER_COMMAND("substance_stats", MaterialStats, VF_NULL, "Display the memory and render time of the procedural materials, most expensive first. Usage: substance_stats [memory|time] [count]");
+	REGISTER_COMMAND("substance_profileDump", ProfileDump, VF_NULL, "Write the recorded render spans as a Chrome trace_event JSON file (chrome://tracing). Usage: substance_profileDump [path], @log@/substance_trace.json by default");
+	REGISTER_COMMAND("substance_profileClear", ProfileClear, VF_NULL, "Drop the recorded render spans");
 }
 
 void SubstanceGem::RegisterTextureHandler()
 {
 	if (I3DEngine* p3DEngine = gEnv->p3DEngine)
 	{
+		// The texture loads can be spread across a pool of renderers:
+		if (substance_rendererPoolSize > 1)
+		{
+			SubstanceAir::RenderOptions total = RenderSettings::readOptions();
+			m_RendererPool = new RendererPool(substance_rendererPoolSize, (int)total.mCoresCount, total.mMemoryBudget,
+				[](const SubstanceAir::RenderOptions& options) { return new SubstanceAir::Renderer(options); });
+			SubstanceAir::RenderOptions options = RendererPool::getWorkerOptions(substance_rendererPoolSize, (int)total.mCoresCount, total.mMemoryBudget);
+			CryLog("Substance renderer pool: %d renderers, %u cores and %u MB each", m_RendererPool->getSize(),
+				(unsigned int)options.mCoresCount, (unsigned int)(options.mMemoryBudget/(1024*1024)));
+			RenderSettings::instance().setRendererPool(m_RendererPool);
+		}
+
+		// The spill tier must be open before the first render, where the engine reads the callbacks mask.
+		// The cache item UIDs are only unique within an engine, and the global callbacks don't tell which
+		// renderer evicts an item: the spill is only open when the Gem renderer is the only renderer, which
+		// excludes the renderer pool and the output previews of the editor.
+		if (substance_renderCacheSpill > 0)
+		{
+			if (m_RendererPool || gEnv->IsEditor())
+			{
+				CryLog("Substance render cache spill: disabled with a renderer pool or in the editor");
+			}
+			else
+			{
+				RenderCacheSpill::instance().open((size_t)substance_renderCacheSpill*1024*1024,
+					(size_t)std::max(substance_renderCacheSpillMemory, 0)*1024*1024);
+			}
+		}
+
 		logDEBUG("Registering Substance texture loader.");
-		m_TextureLoadHandler = new CTextureLoadHandler_Substance(_renderer);
+		m_TextureLoadHandler = new CTextureLoadHandler_Substance(_renderer, m_RendererPool);
 		p3DEngine->AddTextureLoadHandler(m_TextureLoadHandler);
+		_renderCallbacks->setTextureLoadHandler(m_TextureLoadHandler);
 	}
 }
 
@@ -293,9 +345,16 @@ void SubstanceGem::UnregisterTextureHandler()
 		if (m_TextureLoadHandler)
 		{
 			p3DEngine->RemoveTextureLoadHandler(m_TextureLoadHandler);
+			m_TextureLoadHandler->cancelJobs();
+			_renderCallbacks->setTextureLoadHandler(nullptr);
 			delete m_TextureLoadHandler;
 			m_TextureLoadHandler = nullptr;
 		}
+
+		// The parked results of the pool renderers are released with the texture loader:
+		RenderSettings::instance().setRendererPool(nullptr);
+		delete m_RendererPool;
+		m_RendererPool = nullptr;
 	}
 }
 
@@ -326,12 +385,35 @@ void SubstanceGem::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_PTR l
 		}
 	}
 	break;
+	case ESYSTEM_EVENT_LEVEL_POST_UNLOAD:
+		// Release the render results, materials and packages not used anymore:
+		if (m_TextureLoadHandler)
+		{
+			m_TextureLoadHandler->clearResults();
+		}
+		MaterialRegistry::instance().purge();
+		PackageCache::instance().purge();
+		SubstanceGlobalCallbacks::instance().trim();
+		break;
 	case ESYSTEM_EVENT_FAST_SHUTDOWN:
 	case ESYSTEM_EVENT_FULL_SHUTDOWN:
 		if (I3DEngine* p3DEngine = gEnv->p3DEngine)
 		{
+			AZ::TickBus::Handler::BusDisconnect();
+			RenderScheduler::instance().setRenderer(nullptr);
 			UnregisterTextureHandler();
 
+			// The scratch file is released while the engine can't fetch from it anymore:
+			{
+				CryAutoCriticalSection renderLock(RenderSettings::instance().getRenderLock());
+				_renderer->cancelAll();
+				_renderer->flush();
+			}
+			RenderCacheSpill::instance().close();
+
+			MaterialRegistry::instance().purge();
+			PackageCache::instance().purge();
+
 			if (m_SubstanceLibAPI)
 			{
 				SubstanceRequestBus::Handler::BusDisconnect();
@@ -383,36 +465,69 @@ IProceduralMaterial* SubstanceGem::GetMaterialFromPath(const char* path, bool bF
 		resolvedPath = string(resultValue)+"/"+string(path);
     }
 
-	if(!AZ::IO::SystemFile::Exists(resolvedPath.c_str())) {
-		AZ_TracePrintf("SubstanceGem", "Material file %s doesn't exist yet'", resolvedPath.c_str());
+	// Outside of the editor the material is read from the game assets:
+	bool exists = gEnv->IsEditor() ? AZ::IO::SystemFile::Exists(resolvedPath.c_str()) : gEnv->pCryPak->IsFileExist(path);
+	if(!exists) {
+		AZ_TracePrintf("SubstanceGem", "Material file %s doesn't exist yet'", gEnv->IsEditor() ? resolvedPath.c_str() : path);
 		return nullptr;
 	}
 
-	// Create a new substance material and return it:
+	// Retrieve the shared substance material:
 	AZ_TracePrintf("SubstanceGem", "Loading procedural material from path: %s", path);
-	SubstanceMaterial* mat = new SubstanceMaterial(path);
-	return mat;
+	return MaterialRegistry::instance().acquire(path, bForceLoad);
+}
+
+IGraphInstance* SubstanceGem::GetGraphInstance(GraphInstanceID graphInstanceID) const
+{
+	return MaterialRegistry::instance().getGraphInstance(graphInstanceID);
 }
 
 void SubstanceGem::QueueRender(IGraphInstance* pGraphInstance)
 {
-	if(!pGraphInstance) {
+	QueueRenderWithPriority(pGraphInstance, ProceduralMaterialRenderPriority::Streaming, -1.0f);
+}
+
+void SubstanceGem::QueueRenderWithPriority(IGraphInstance* pGraphInstance, ProceduralMaterialRenderPriority priority, float distance)
+{
+	if(!pGraphInstance || priority < ProceduralMaterialRenderPriority::Visible || priority >= ProceduralMaterialRenderPriority::Count) {
 		logERROR("Invalid graph instance to queue.");
 		return;
 	}
 
-	auto graph = (GraphInstance*)pGraphInstance;
-	_renderer->push(*(graph->getInstance()));
+	// Results rendered ahead for the texture loader are outdated now:
+	if (m_TextureLoadHandler)
+	{
+		m_TextureLoadHandler->discardResults(pGraphInstance->GetProceduralMaterial()->GetPath());
+	}
+
+	// The graphs are pushed by the next render, from the most urgent class:
+	RenderScheduler::instance().queue(pGraphInstance->GetGraphInstanceID(), priority, distance);
+}
+
+void SubstanceGem::QueueRenderAtDistance(IGraphInstance* pGraphInstance, float distance)
+{
+	bool visible = distance >= 0.0f && distance <= substance_visibleDistance;
+	QueueRenderWithPriority(pGraphInstance, visible ? ProceduralMaterialRenderPriority::Visible : ProceduralMaterialRenderPriority::Background, distance);
 }
 
 ProceduralMaterialRenderUID SubstanceGem::RenderASync()
 {
-	return _renderer->run(SubstanceAir::Renderer::Run_Asynchronous);
+	return RenderScheduler::instance().render(false);
 }
 
 void SubstanceGem::RenderSync()
 {
-	_renderer->run();
+	RenderScheduler::instance().render(true);
+}
+
+bool SubstanceGem::IsRenderPending() const
+{
+	return RenderScheduler::instance().isPending();
+}
+
+SProceduralMaterialRenderBudgetStats SubstanceGem::GetRenderBudgetStats() const
+{
+	return RenderScheduler::instance().getStats();
 }
 
 bool SubstanceGem::CreateProceduralMaterial(const char* basePath, const char* sbsarPath, const char* smtlPath)
@@ -425,46 +540,13 @@ bool SubstanceGem::CreateProceduralMaterial(const char* basePath, const char* sb
 	// AZStd::string fullPath = sbsarPath;
 	AZ_TracePrintf("SubstanceGem", "using full sbsar path: %s", fullPath.c_str());
 
-	// load the content of the sbsar file:
-	AZ::IO::SystemFile file;
-
-	bool res = file.Open(fullPath.c_str(),AZ::IO::SystemFile::SF_OPEN_READ_ONLY);
-	if(!res) {
-		AZ_TracePrintf("SubstanceGem", "ERROR: Cannot open file %s.", fullPath.c_str());
-		return false;
-	}
-
-	// Get the length of the file:
-	auto len = file.Length();
-	AZ_TracePrintf("SubstanceGem", "file size is: %d bytes.", len);
-
-	// Prepare our buffer:
-	char* data = new char[len];
-	memset(data, 0, len);
-
-	// Read the content of the file:
-	auto rlen = file.Read(len, data);
-	if(rlen != len) {
-		AZ_TracePrintf("SubstanceGem", "ERROR: did not read expected number of bytes: %d != %d.", rlen, len);
-		return false;	
-	}
-
-	// We may close the file:
-	file.Close();
-
-	// So here we try to load our package:
-	SubstanceAir::PackageDesc* pdesc = nullptr;
-	try {
-		pdesc = new SubstanceAir::PackageDesc(data,len);
-	}
-	catch(...) {
-		AZ_TracePrintf("SubstanceGem", "Exception occured when trying to create substance package.");
+	// Retrieve the package from the shared cache, with the Source path of the material so that they share it:
+	PackageDescPtr pdesc = PackageCache::instance().acquire(sbsarPath);
+	if(!pdesc) {
+		AZ_TracePrintf("SubstanceGem", "ERROR: Cannot load substance package from %s.", sbsarPath);
 		return false;
 	}
 
-	// We can delete our buffer:
-	delete [] data;
-
 	// This package should not be valid:
 	AZ_TracePrintf("SubstanceGem", "Substance package is: %s", pdesc->isValid() ? "VALID" : "INVALID");
 
@@ -522,14 +604,15 @@ bool SubstanceGem::CreateProceduralMaterial(const char* basePath, const char* sb
 	AZ_TracePrintf("SubstanceGem", "Should write smtl content: %s", content.c_str());
 	
 	// Write this file:
+	AZ::IO::SystemFile file;
 	fullPath = basePath+AZStd::string("/")+AZStd::string(smtlPath);
-	res = file.Open(fullPath.c_str(),AZ::IO::SystemFile::SF_OPEN_WRITE_ONLY|AZ::IO::SystemFile::SF_OPEN_CREATE);
+	bool res = file.Open(fullPath.c_str(),AZ::IO::SystemFile::SF_OPEN_WRITE_ONLY|AZ::IO::SystemFile::SF_OPEN_CREATE);
 	if(!res) {
 		AZ_TracePrintf("SubstanceGem", "ERROR: Cannot open file %s for writing.", fullPath.c_str());
 		return false;
 	}
 
-	rlen = file.Write(content.c_str(), content.size());
+	auto rlen = file.Write(content.c_str(), content.size());
 	if(rlen != content.size()) {
 		AZ_TracePrintf("SubstanceGem", "ERROR: did not write expected number of bytes: %d != %d.", rlen, content.size());
 		return false;	
@@ -584,6 +667,32 @@ ISubstanceLibAPI* SubstanceGem::GetSubstanceLibAPI() const
 {
 	return m_SubstanceLibAPI;
 }
+
+void SubstanceGem::GetMemoryUsage(ICrySizer* pSizer) const
+{
+	SIZER_COMPONENT_NAME(pSizer, "Substance");
+	{
+		SIZER_COMPONENT_NAME(pSizer, "Materials");
+		MaterialRegistry::instance().GetMemoryUsage(pSizer);
+	}
+	{
+		SIZER_COMPONENT_NAME(pSizer, "Packages");
+		PackageCache::instance().GetMemoryUsage(pSizer);
+	}
+	{
+		SIZER_COMPONENT_NAME(pSizer, "Allocations");
+		SubstanceGlobalCallbacks::instance().GetMemoryUsage(pSizer);
+	}
+}
+
+void SubstanceGem::OnTick(float deltaTime, AZ::ScriptTimePoint time)
+{
+	// The computed outputs and completed jobs are notified from the main thread:
+	_renderCallbacks->dispatchNotifications(_renderer);
+
+	// The completed jobs are known, account the render time of the frame:
+	RenderScheduler::instance().update();
+}
 #else
 SubstanceGem::SubstanceGem() : CryHooksModule() { }
 SubstanceGem::~SubstanceGem() { }
@@ -23,8 +23,11 @@
 #include "Substance/SubstanceBus.h"
 #if defined(USE_SUBSTANCE)
 #include "SubstanceAPI.h"
+#include <AzCore/Component/TickBus.h>
 
 struct CTextureLoadHandler_Substance;
+class RendererPool;
+class SubstanceRenderCallbacks;
 #endif // USE_SUBSTANCE
 
 // declare the renderer class:
@@ -35,6 +38,9 @@ class Renderer;
 class SubstanceGem
 	: public CryHooksModule
 	, public SubstanceRequestBus::Handler
+#if defined(USE_SUBSTANCE)
+	, public AZ::TickBus::Handler
+#endif // USE_SUBSTANCE
 {
 public:
 	AZ_RTTI(SubstanceGem, "{4BCD80A7-A8C7-47A1-96A8-A6474D898E7B}", CryHooksModule);
@@ -52,10 +58,15 @@ public:
 	virtual int GetMaximumOutputSize() const override;
 
 	virtual IProceduralMaterial* GetMaterialFromPath(const char* path, bool bForceLoad) const override;
+	virtual IGraphInstance* GetGraphInstance(GraphInstanceID graphInstanceID) const override;
 	
 	virtual void QueueRender(IGraphInstance* pGraphInstance) override;
+	virtual void QueueRenderWithPriority(IGraphInstance* pGraphInstance, ProceduralMaterialRenderPriority priority, float distance) override;
+	virtual void QueueRenderAtDistance(IGraphInstance* pGraphInstance, float distance) override;
 	virtual ProceduralMaterialRenderUID RenderASync() override;
 	virtual void RenderSync() override;
+	virtual bool IsRenderPending() const override;
+	virtual SProceduralMaterialRenderBudgetStats GetRenderBudgetStats() const override;
 
 	virtual bool CreateProceduralMaterial(const char* basePath, const char* sbsarPath, const char* smtlPath) override;
 	virtual bool SaveProceduralMaterial(IProceduralMaterial* pMaterial, const char* basePath, const char* path) override;
@@ -63,6 +74,11 @@ public:
 
 	virtual ISubstanceLibAPI* GetSubstanceLibAPI() const override;
 
+	virtual void GetMemoryUsage(ICrySizer* pSizer) const override;
+
+	// Send the render notifications and apply the frame budget:
+	virtual void OnTick(float deltaTime, AZ::ScriptTimePoint time) override;
+
 private:
 	void RegisterTextureHandler();
 	void UnregisterTextureHandler();
@@ -73,11 +89,13 @@ private:
 
 	// renderer instance:
 	SubstanceAir::Renderer* _renderer;
+	SubstanceRenderCallbacks* _renderCallbacks;
 
 	void*             m_SubstanceLib;
 	ISubstanceLibAPI* m_SubstanceLibAPI;
 	CSubstanceAPI     m_SubstanceAPI;
 	CTextureLoadHandler_Substance* m_TextureLoadHandler;
+	RendererPool*     m_RendererPool;
 #endif // USE_SUBSTANCE
 };
 
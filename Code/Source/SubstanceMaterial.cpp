@@ -9,14 +9,18 @@
 
 #if defined(USE_SUBSTANCE)
 #include "SubstanceMaterial.h"
+#include "MaterialRegistry.h"
 #include "GraphInstance.h"
 #include "GraphOutput.h"
 #include "GraphInput.h"
+#include "GlobalCallbacks.h"
+#include "MaterialDescription.h"
 #include <AzCore/IO/SystemFile.h>
 #include <AzToolsFramework/API/EditorAssetSystemAPI.h>
+#include <algorithm>
 
-SubstanceMaterial::SubstanceMaterial(const char* path) : _smtlPath(path),
-	_package(nullptr)
+SubstanceMaterial::SubstanceMaterial(const char* path, ProceduralMaterialID id) : _id(id), _smtlPath(path),
+	_packageHash(0), _streaming(-1), _stacked(false), _renders(0), _renderedOutputs(0), _renderMs(0.0f)
 {
 	AZ_TracePrintf("SubstanceGem", "Creating SubstanceMaterial object.");
 	LoadMaterialFromXML();
@@ -31,134 +35,158 @@ SubstanceMaterial::~SubstanceMaterial()
 	}
 	_graphInstances.clear();
 
-	// Destroy the package:
-	if(_package) {
-		delete _package;
-		_package = nullptr;
-	}
+	// Release the package (must outlive the graph instances):
+	_package.reset();
 }
 
 void SubstanceMaterial::LoadMaterialFromXML()
 {
 	auto resolvedPath = getAbsoluteAssetPath(_smtlPath);
 
-	XmlNodeRef mtlNode = GetISystem()->LoadXmlFromFile(resolvedPath.c_str());
-	if(!mtlNode) {
+	std::vector<char> xml;
+	if(!readAssetFile(resolvedPath, xml)) {
 		AZ_TracePrintf("SubstanceGem", "ERROR: Cannot load material XML from file %s.", resolvedPath.c_str());
 		return;
 	}
 
 	// Read the content of the XML file:
-	const char* source;
-	
-	//get sbsar path
-	if (!mtlNode->getAttr("Source", &source))
+	MaterialDescription desc;
+	std::string error;
+	if (!desc.parse(xml.data(), xml.size(), error))
 	{
-		CryLogAlways("ERROR: ProceduralMaterial: No Source parameter for material (%s)", resolvedPath.c_str());
+		CryLogAlways("ERROR: ProceduralMaterial: %s for material (%s)", error.c_str(), resolvedPath.c_str());
 		return;
 	}
-	
-	_sbsarPath = source;
+	for (const auto& warning : desc.warnings)
+	{
+		CryLogAlways("ERROR: ProceduralMaterial: %s in material (%s)", warning.c_str(), resolvedPath.c_str());
+	}
+
+	_sbsarPath = desc.source.c_str();
 
-	// Open the sbsar file:
-	CCryFile sbsarFile(source, "rb");
-	if (!sbsarFile.GetHandle())
+	// Optional texture load mode:
+	if (desc.streaming >= 0)
 	{
-		CryLogAlways("ERROR: ProceduralMaterial: Unable to load substance (%s) in material (%s)", source, resolvedPath.c_str());
-		return;
+		_streaming = desc.streaming;
+	}
+
+	for (const auto& output : desc.outputs)
+	{
+		OutputSettings settings;
+		settings.enabled = output.enabled;
+		settings.compressed = output.compressed;
+		settings.encoding = output.encoding == MaterialDescription::Encoding_BC5 ? OutputEncoding_BC5 :
+			output.encoding == MaterialDescription::Encoding_BC7 ? OutputEncoding_BC7 : OutputEncoding_None;
+		_outputSettings[output.id] = settings;
 	}
-	
-	//read archive data
-	size_t dataSize = sbsarFile.GetLength();
-	byte* data = new byte[dataSize];
-	sbsarFile.ReadRaw(data, dataSize);
 
-	// parse the package:
-	_package = new SubstanceAir::PackageDesc(data, dataSize);
-	delete [] data;
+	// The outputs of the source graph feed the inputs of a graph of another archive:
+	if (desc.stacked)
+	{
+		_stacked = true;
+		_stack.postPath = desc.stack.postPath.c_str();
+		_stack.preGraph = desc.stack.preGraph;
+		_stack.postGraph = desc.stack.postGraph;
+		_stack.keepNonConnected = desc.stack.keepNonConnected;
+		_stack.connections = desc.stack.connections;
+	}
 
-	// Check the package is valid:
-	if(!_package->isValid()) {
-		CryLogAlways("ERROR: ProceduralMaterial: Package read from %s is invalid.", source);
-		return;
+	for (const auto& parameter : desc.parameters)
+	{
+		logDEBUG("Setting up parameter with ID="<<parameter.id.c_str()<<" of type "<<parameter.type);
+		const float* f = parameter.floats;
+		const int* i = parameter.ints;
+		AZStd::string key(parameter.id.c_str());
+
+		// Inputs locked to their material value when the inputs are specialized:
+		if (parameter.isStatic)
+		{
+			_staticInputs.insert(key);
+		}
+
+		switch(parameter.type) {
+		case GraphInputType::Float1:
+			_defValues[key] = GraphValueVariant(f[0]);
+			break;
+		case GraphInputType::Float2:
+			_defValues[key] = GraphValueVariant(f[0], f[1]);
+			break;
+		case GraphInputType::Float3:
+			_defValues[key] = GraphValueVariant(f[0], f[1], f[2]);
+			break;
+		case GraphInputType::Float4:
+			_defValues[key] = GraphValueVariant(f[0], f[1], f[2], f[3]);
+			break;
+		case GraphInputType::Integer1:
+			_defValues[key] = GraphValueVariant(i[0]);
+			break;
+		case GraphInputType::Integer2:
+			_defValues[key] = GraphValueVariant(i[0], i[1]);
+			break;
+		case GraphInputType::Integer3:
+			_defValues[key] = GraphValueVariant(i[0], i[1], i[2]);
+			break;
+		case GraphInputType::Integer4:
+			_defValues[key] = GraphValueVariant(i[0], i[1], i[2], i[3]);
+			break;
+		case GraphInputType::String:
+			_defValues[key] = GraphValueVariant(parameter.str.c_str());
+			break;
+		default:
+			logERROR("Unsupported input type: "<<parameter.type);
+			break;
+		}
 	}
 
-	//process child nodes
-	for (int i = 0; i < mtlNode->getChildCount(); i++)
+	// In game, the package is relinked without the outputs the material disables. The outputs it doesn't
+	// list are enabled, as in the editor which keeps all the outputs to edit the material:
+	std::vector<unsigned int> disabledUids;
+	if (!gEnv->IsEditor() && substance_pruneOutputs && !_stacked)
 	{
-		XmlNodeRef child = mtlNode->getChild(i);
+		for (auto& it : _outputSettings)
+		{
+			if (!it.second.enabled)
+			{
+				disabledUids.push_back(it.first);
+			}
+		}
+	}
 
-		if (!strcmp(child->getTag(), "Parameter"))
+	// Retrieve the parsed package from the cache:
+	if (_stacked)
+	{
+		_package = PackageCache::instance().acquireStack(_sbsarPath.c_str(), _stack, &_packageHash);
+	}
+	else
+	{
+		_package = PackageCache::instance().acquire(_sbsarPath.c_str(), &_packageHash);
+		if (_package && _package->isValid() && !disabledUids.empty())
 		{
-			const char* id;
-			int type;
+			std::vector<unsigned int> outputUids;
+			for (const auto& graph : _package->getGraphs())
+			{
+				for (const auto& output : graph.mOutputs)
+				{
+					if (std::find(disabledUids.begin(), disabledUids.end(), output.mUid) == disabledUids.end())
+					{
+						outputUids.push_back(output.mUid);
+					}
+				}
+			}
 
-			if (child->getAttr("ID", &id) &&
-				child->getAttr("Type", type))
+			// A package without any enabled output is kept whole:
+			if (!outputUids.empty())
 			{
-				// Retrieve the graph:
-				logDEBUG("Setting up parameter with ID="<<id<<" of type "<<type);
-				float xf, yf, zf, wf;
-				int xi, yi, zi, wi;
-				const char* str;
-				AZStd::string key(id);
-
-				switch(type) {
-				case GraphInputType::Float1:
-					child->getAttr("x", xf);
-					_defValues[key] = GraphValueVariant(xf);
-					break;
-				case GraphInputType::Float2:
-					child->getAttr("x", xf);
-					child->getAttr("y", yf);
-					_defValues[key] = GraphValueVariant(xf, yf);
-					break;
-				case GraphInputType::Float3:
-					child->getAttr("x", xf);
-					child->getAttr("y", yf);
-					child->getAttr("z", zf);
-					_defValues[key] = GraphValueVariant(xf, yf, zf);
-					break;
-				case GraphInputType::Float4:
-					child->getAttr("x", xf);
-					child->getAttr("y", yf);
-					child->getAttr("z", zf);
-					child->getAttr("w", wf);
-					_defValues[key] = GraphValueVariant(xf, yf, zf, wf);
-					break;
-				case GraphInputType::Integer1:
-					child->getAttr("x", xi);
-					_defValues[key] = GraphValueVariant(xi);
-					break;
-				case GraphInputType::Integer2:
-					child->getAttr("x", xi);
-					child->getAttr("y", yi);
-					_defValues[key] = GraphValueVariant(xi, yi);
-					break;
-				case GraphInputType::Integer3:
-					child->getAttr("x", xi);
-					child->getAttr("y", yi);
-					child->getAttr("z", zi);
-					_defValues[key] = GraphValueVariant(xi, yi, zi);
-					break;
-				case GraphInputType::Integer4:
-					child->getAttr("x", xi);
-					child->getAttr("y", yi);
-					child->getAttr("z", zi);
-					child->getAttr("w", wi);
-					_defValues[key] = GraphValueVariant(xi, yi, zi, wi);
-					break;
-				case GraphInputType::String:
-					child->getAttr("str", &str);
-					_defValues[key] = GraphValueVariant(str);
-					break;
-				default:
-					logERROR("Unsupported input type: "<<type);
-					break;
-				}			
+				_package = PackageCache::instance().acquireSelected(_sbsarPath.c_str(), outputUids, &_packageHash);
 			}
 		}
 	}
+
+	// Check the package is valid:
+	if(!_package || !_package->isValid()) {
+		CryLogAlways("ERROR: ProceduralMaterial: Unable to load substance (%s) in material (%s)", _sbsarPath.c_str(), resolvedPath.c_str());
+		return;
+	}
 }
 
 void SubstanceMaterial::writeSubstanceTexture(const AZStd::string& basePath, const AZStd::string& fbase, const AZStd::string& otype, unsigned int id)
@@ -189,7 +217,26 @@ void SubstanceMaterial::writeSubstanceTexture(const AZStd::string& basePath, con
 bool SubstanceMaterial::save(const char* basePath, const char* path)
 {
 	// Prepare the content to save:
-	AZStd::string content = string_format("<ProceduralMaterial Source=\"%s\">\n", GetSourcePath());
+	AZStd::string content = string_format("<ProceduralMaterial Source=\"%s\"", GetSourcePath());
+	if(_streaming >= 0) {
+		content += string_format(" Streaming=\"%d\"", _streaming);
+	}
+	content += ">\n";
+
+	if(_stacked) {
+		content += string_format("  <Stack Source=\"%s\" PreGraph=\"%d\" PostGraph=\"%d\" KeepNonConnected=\"%d\"", _stack.postPath.c_str(),
+			_stack.preGraph, _stack.postGraph, _stack.keepNonConnected ? 1 : 0);
+		if(_stack.connections.empty()) {
+			content += " />\n";
+		}
+		else {
+			content += ">\n";
+			for(auto& connection: _stack.connections) {
+				content += string_format("    <Connection Output=\"%u\" Input=\"%u\" />\n", connection.first, connection.second);
+			}
+			content += "  </Stack>\n";
+		}
+	}
 	
 	// List the output IDs and usage:
 	AZStd::string smtlPath = GetPath();
@@ -224,8 +271,27 @@ bool SubstanceMaterial::save(const char* basePath, const char* path)
 				break;
 			}
 			if(!otype.empty()) {
+				// Keep the current output settings:
+				OutputSettings settings;
+				if(!getOutputSettings(out->GetGraphOutputID(), settings)) {
+					settings.compressed = true;
+					settings.encoding = OutputEncoding_None;
+				}
+
+				// The output can be enabled or disabled from the editor:
+				settings.enabled = out->IsEnabled();
+
+				AZStd::string encode = "";
+				if(settings.encoding == OutputEncoding_BC5) {
+					encode = " Encode=\"BC5\"";
+				}
+				else if(settings.encoding == OutputEncoding_BC7) {
+					encode = " Encode=\"BC7\"";
+				}
+
 				// Add a line in the output content:
-				content += string_format("  <Output ID=\"%d\" Enabled=\"1\" Compressed=\"1\" File=\"%s_%s.sub\" />\n", (unsigned int)out->GetGraphOutputID(),fbase.c_str(),otype.c_str());
+				content += string_format("  <Output ID=\"%d\" Enabled=\"%d\" Compressed=\"%d\"%s File=\"%s_%s.sub\" />\n", (unsigned int)out->GetGraphOutputID(),
+					settings.enabled ? 1 : 0, settings.compressed ? 1 : 0, encode.c_str(), fbase.c_str(),otype.c_str());
 
 				writeSubstanceTexture(basePath, fbase, otype, out->GetGraphOutputID());
 			}
@@ -235,7 +301,7 @@ bool SubstanceMaterial::save(const char* basePath, const char* path)
 		int nin = graph->GetInputCount();
 		for(int j=0; j<nin; ++j) {
 			GraphInput* in = (GraphInput*)graph->GetInput(j);
-			AZStd::string key = string_format("%d_%d",(int)graph->GetGraphInstanceID(), (int)in->GetGraphInputID());
+			AZStd::string key = string_format("%d_%d",i, (int)in->GetGraphInputID());
 
 			AZStd::string data = "";
 			const float* fval;
@@ -285,7 +351,7 @@ bool SubstanceMaterial::save(const char* basePath, const char* path)
 				break; 
 			}
 
-			content += string_format("  <Parameter ID=\"%s\" Type=\"%d\" %s />\n", key.c_str(),type,data.c_str());
+			content += string_format("  <Parameter ID=\"%s\" Type=\"%d\" %s%s />\n", key.c_str(),type,data.c_str(), isStaticInput(key) ? " Static=\"1\"" : "");
 		}
 	}
 
@@ -326,6 +392,71 @@ bool SubstanceMaterial::getDefaultInputValue(const AZStd::string& key, GraphValu
 	return false;
 }
 
+bool SubstanceMaterial::isStaticInput(const AZStd::string& key) const
+{
+	return _staticInputs.count(key) != 0;
+}
+
+bool SubstanceMaterial::getOutputSettings(GraphOutputID id, OutputSettings& settings) const
+{
+	auto it = _outputSettings.find(id);
+	if(it == _outputSettings.end()) {
+		return false;
+	}
+
+	settings = it->second;
+	return true;
+}
+
+void SubstanceMaterial::getStats(Stats& stats) const
+{
+	stats.packageBytes = PackageCache::instance().getArchiveSize(_sbsarPath.c_str());
+	if(_stacked) {
+		stats.packageBytes += PackageCache::instance().getArchiveSize(_stack.postPath.c_str());
+	}
+	stats.instanceBytes = SubstanceGlobalCallbacks::instance().getOwnerBytes(_smtlPath.c_str(), false);
+	stats.resultBytes = SubstanceGlobalCallbacks::instance().getOwnerBytes(_smtlPath.c_str(), true);
+
+	CryAutoCriticalSection lock(_statsLock);
+	stats.renders = _renders;
+	stats.outputs = _renderedOutputs;
+	stats.renderMs = _renderMs;
+}
+
+void SubstanceMaterial::addRenderTime(float ms, unsigned int renders, unsigned int outputs)
+{
+	CryAutoCriticalSection lock(_statsLock);
+	_renders += renders;
+	_renderedOutputs += outputs;
+	_renderMs += ms;
+}
+
+void SubstanceMaterial::GetMemoryUsage(ICrySizer* s) const
+{
+	s->AddObject(this, sizeof(*this));
+	s->AddObject(_smtlPath.c_str(), _smtlPath.capacity());
+	s->AddObject(_sbsarPath.c_str(), _sbsarPath.capacity());
+	for(auto& inst: _graphInstances) {
+		inst.second->GetMemoryUsage(s);
+	}
+
+	// The package is shared, the sizer counts it once:
+	if(_package) {
+		SIZER_COMPONENT_NAME(s, "Packages");
+		s->AddObject(_package.get(), PackageCache::instance().getArchiveSize(_sbsarPath.c_str()));
+	}
+}
+
+bool SubstanceMaterial::isStreaming() const
+{
+	// Use the default mode if not specified in the smtl file:
+	if(_streaming < 0) {
+		return substance_textureStreaming != 0;
+	}
+
+	return _streaming != 0;
+}
+
 const char* SubstanceMaterial::GetPath() const
 {
 	return _smtlPath.c_str();
@@ -350,6 +481,7 @@ IGraphInstance* SubstanceMaterial::GetGraphInstance(int index)
 	if(_graphInstances.count(index)==0) {
 		// create the graph instance if needed:
 		AZ_TracePrintf("SubstanceGem", "Creating graph instance at index %d.", index);
+		SubstanceGlobalCallbacks::OwnerScope owner(_smtlPath.c_str());
 		_graphInstances[index] = new GraphInstance(this, index);
 	}
 
@@ -361,6 +493,16 @@ void SubstanceMaterial::ReimportSubstance()
 	AZ_TracePrintf("SubstanceGem", "SubstanceMaterial::ReimportSubstance() not doing anything.");
 }
 
+void SubstanceMaterial::AddRef()
+{
+	MaterialRegistry::instance().addRef(this);
+}
+
+void SubstanceMaterial::Release()
+{
+	MaterialRegistry::instance().release(this);
+}
+
 void SubstanceMaterial::removeFiles()
 {
 	logERROR("SubstanceMaterial::removeFiles not implemented yet.");
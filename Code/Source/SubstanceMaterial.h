@@ -10,6 +10,8 @@
 
 #include "Substance/IProceduralMaterial.h"
 #include "Substance/framework/package.h"
+#include "PackageCache.h"
+#include <set>
 
 #if defined(USE_SUBSTANCE)
 
@@ -19,7 +21,7 @@ class GraphInstance;
 class SubstanceMaterial : public IProceduralMaterial
 {
 public:
-	SubstanceMaterial(const char* path);
+	SubstanceMaterial(const char* path, ProceduralMaterialID id);
 	virtual ~SubstanceMaterial();
 
 	/// Get the smtl file path for this material.
@@ -37,12 +39,69 @@ public:
 	/// Reimport Substance SBSAR from Disk
 	virtual void ReimportSubstance();
 
+	/// Add a reference on this material.
+	virtual void AddRef();
+
+	/// Release a reference on this material.
+	virtual void Release();
+
+	// Retrieve the ID of this material in the registry:
+	ProceduralMaterialID getMaterialID() const { return _id; }
+
+	// Memory and render time accounting of this material:
+	struct Stats
+	{
+		size_t packageBytes;		// Substance archives, shared with the other materials using them
+		size_t instanceBytes;		// Framework objects of the graph instances
+		size_t resultBytes;			// Render results grabbed and not yet loaded
+		unsigned int renders;		// Graph renders
+		unsigned int outputs;		// Computed outputs
+		float renderMs;				// Cumulative render time of the outputs
+	};
+
+	// Retrieve the accounting of this material:
+	void getStats(Stats& stats) const;
+
+	// Account the render time of outputs of this material (called from the render threads):
+	void addRenderTime(float ms, unsigned int renders, unsigned int outputs);
+
+	// Add the gem objects and the package of this material to a sizer:
+	void GetMemoryUsage(ICrySizer* s) const;
+
 	// Retrieve the package from this material:
-	SubstanceAir::PackageDesc* getPackage() const { return _package; }
+	SubstanceAir::PackageDesc* getPackage() const { return _package.get(); }
+
+	// Retrieve the content hash of the substance archive used by this material:
+	AZ::u64 getPackageHash() const { return _packageHash; }
 
 	// Retrieve a default input value:
 	bool getDefaultInputValue(const AZStd::string& key, GraphValueVariant& val);
 
+	// Check if an input is marked as static (never changed at runtime) in the smtl file:
+	bool isStaticInput(const AZStd::string& key) const;
+
+	// Block compression applied by the gem after the render:
+	enum OutputEncoding
+	{
+		OutputEncoding_None,
+		OutputEncoding_BC5,
+		OutputEncoding_BC7
+	};
+
+	// Settings of the outputs exported as procedural textures in the smtl file:
+	struct OutputSettings
+	{
+		bool enabled;
+		bool compressed;
+		OutputEncoding encoding;
+	};
+
+	// Retrieve the settings of a texture output, returns false if the output is not exported:
+	bool getOutputSettings(GraphOutputID id, OutputSettings& settings) const;
+
+	// Check if the textures of this material are streamed instead of rendered in a blocking way:
+	bool isStreaming() const;
+
 	// Save this material to file:
 	bool save(const char* basePath, const char* path);
 
@@ -56,14 +115,20 @@ protected:
 	// Helper method used to load the data from XML:
 	void LoadMaterialFromXML();
 
+	// Material ID in the registry:
+	ProceduralMaterialID _id;
+
 	// smtl path:
 	AZStd::string _smtlPath;
 
 	// sbsar path:
 	AZStd::string _sbsarPath;
 
-	// Package desc:
-	SubstanceAir::PackageDesc* _package;
+	// Package desc, shared with the other materials using the same archive:
+	PackageDescPtr _package;
+
+	// Content hash of the substance archive:
+	AZ::u64 _packageHash;
 
 	// map of graph instances:
 	typedef std::map<int, GraphInstance*> GraphInstanceMap;
@@ -71,6 +136,25 @@ protected:
 
 	typedef std::map<AZStd::string, GraphValueVariant> ValueMap;
 	ValueMap _defValues;
+
+	// Keys of the static inputs:
+	std::set<AZStd::string> _staticInputs;
+
+	typedef std::map<GraphOutputID, OutputSettings> OutputSettingsMap;
+	OutputSettingsMap _outputSettings;
+
+	// Texture load mode from the smtl file (-1 if not specified):
+	int _streaming;
+
+	// Graph of another archive stacked after the graph of the source archive:
+	bool _stacked;
+	PackageCache::StackSettings _stack;
+
+	// Render accounting:
+	unsigned int _renders;
+	unsigned int _renderedOutputs;
+	float _renderMs;
+	mutable CryCriticalSection _statsLock;
 };
 
 #endif // USE_SUBSTANCE
@@ -0,0 +1,408 @@
+/** @file TextureCache.cpp
+	@brief Source File for the persistent procedural texture cache
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "TextureCache.h"
+#include "PackageCache.h"
+#include "GraphInstance.h"
+#include "GraphOutput.h"
+#include "SubstanceMaterial.h"
+#include <AzCore/IO/FileIO.h>
+#include <AzCore/Math/Crc.h>
+
+#define TEXTURECACHE_FOLDER "@cache@/substance"
+#define TEXTURECACHE_EXTENSION ".stc"
+#define TEXTURECACHE_MAGIC 0x43545353 // "SSTC"
+#define TEXTURECACHE_VERSION 1
+
+// Header written in front of each cached mip chain:
+struct TextureCacheHeader
+{
+	AZ::u32 magic;
+	AZ::u32 version;
+	AZ::u64 key;
+	AZ::u32 width;
+	AZ::u32 height;
+	AZ::u32 numMips;
+	AZ::u32 format;
+	AZ::u32 flags;
+	AZ::u32 crc;
+	AZ::u64 dataSize;
+};
+
+template<typename T>
+static AZ::u64 hashValue(const T& val, AZ::u64 hash)
+{
+	return PackageCache::hashData(&val, sizeof(T), hash);
+}
+
+TextureCache& TextureCache::instance()
+{
+	static TextureCache cache;
+	return cache;
+}
+
+TextureCache::TextureCache() : _initialized(false), _useCounter(0), _totalBytes(0),
+	_hits(0), _misses(0), _stores(0), _evictions(0), _corrupted(0), _savedBytes(0)
+{
+}
+
+bool TextureCache::computeKey(AZ::u64 packageHash, GraphInstance* graph, GraphOutput* out, AZ::u64& key)
+{
+	AZ::u64 hash = PackageCache::hashData(&packageHash, sizeof(packageHash));
+	hash = hashValue((AZ::u32)graph->getGraphIndex(), hash);
+	hash = hashValue((AZ::u32)out->GetGraphOutputID(), hash);
+
+	// Hash the current value of all the inputs in UID order:
+	for(auto in: graph->getInstance()->getInputs()) {
+		hash = hashValue((AZ::u32)in->mDesc.mUid, hash);
+		if(in->mDesc.isNumerical()) {
+			auto num = (SubstanceAir::InputInstanceNumericalBase*)in;
+			hash = PackageCache::hashData(num->getRawData(), num->getRawSize(), hash);
+		}
+		else if(in->mDesc.isString()) {
+			auto& str = ((SubstanceAir::InputInstanceString*)in)->getString();
+			hash = PackageCache::hashData(str.c_str(), str.size(), hash);
+		}
+		else if(in->isNonDefault()) {
+			// The content of image inputs is not tracked:
+			return false;
+		}
+	}
+
+	// Hash the output format:
+	auto inst = out->getInstance();
+	const SubstanceAir::OutputFormat& fmt = inst->getFormatOverride();
+	hash = hashValue((AZ::u32)inst->mDesc.mFormat, hash);
+	hash = hashValue((AZ::u32)inst->mDesc.mMipmaps, hash);
+	hash = hashValue((AZ::u32)fmt.format, hash);
+	hash = hashValue((AZ::u32)fmt.mipmapLevelsCount, hash);
+	hash = hashValue((AZ::u32)fmt.hvFlip, hash);
+	hash = hashValue((AZ::u32)fmt.forceWidth, hash);
+	hash = hashValue((AZ::u32)fmt.forceHeight, hash);
+	for(auto& comp: fmt.perComponent) {
+		hash = hashValue((AZ::u32)comp.outputUid, hash);
+		hash = hashValue((AZ::u32)comp.shuffleIndex, hash);
+		hash = hashValue(comp.levelMin, hash);
+		hash = hashValue(comp.levelMax, hash);
+	}
+
+	// Hash the block compression applied by the gem:
+	SubstanceMaterial::OutputSettings settings;
+	SubstanceMaterial* smat = (SubstanceMaterial*)graph->GetProceduralMaterial();
+	if(smat->getOutputSettings(out->GetGraphOutputID(), settings)) {
+		hash = hashValue((AZ::u32)settings.encoding, hash);
+	}
+
+	key = hash;
+	return true;
+}
+
+AZStd::string TextureCache::getEntryPath(AZ::u64 key)
+{
+	return string_format("%s/%016llx%s", TEXTURECACHE_FOLDER, (unsigned long long)key, TEXTURECACHE_EXTENSION);
+}
+
+void TextureCache::init()
+{
+	if(_initialized) {
+		return;
+	}
+	_initialized = true;
+
+	AZ::IO::FileIOBase* fileIO = gEnv->pFileIO;
+	fileIO->CreatePath(TEXTURECACHE_FOLDER);
+
+	// List the existing blobs, oldest first:
+	std::vector<std::pair<AZ::u64, AZ::u64> > files;
+	fileIO->FindFiles(TEXTURECACHE_FOLDER, "*" TEXTURECACHE_EXTENSION, [&](const char* path) -> bool
+	{
+		AZStd::string fname = PathUtil::GetFileName(path).c_str();
+		unsigned long long key = 0;
+		AZ::u64 size = 0;
+		if(sscanf(fname.c_str(), "%llx", &key) == 1 && fileIO->Size(path, size)) {
+			files.push_back(std::make_pair(fileIO->ModificationTime(path), (AZ::u64)key));
+			_entries[key].size = size;
+			_totalBytes += size;
+		}
+		return true;
+	});
+
+	std::sort(files.begin(), files.end());
+	for(auto& file: files) {
+		_entries[file.second].lastUse = ++_useCounter;
+	}
+
+	logDEBUG("TextureCache: found "<<_entries.size()<<" cached textures ("<<_totalBytes<<" bytes).");
+}
+
+bool TextureCache::contains(AZ::u64 key)
+{
+	CryAutoCriticalSection lock(_lock);
+	init();
+	return _entries.count(key)>0;
+}
+
+bool TextureCache::load(AZ::u64 key, STextureLoadData& loadData)
+{
+	AZ::u64 size;
+	{
+		CryAutoCriticalSection lock(_lock);
+		init();
+
+		// A blob being written is read once complete:
+		beginFileAccess(key);
+		auto it = _entries.find(key);
+		if(it == _entries.end()) {
+			endFileAccess(key);
+			_misses++;
+			return false;
+		}
+		size = it->second.size;
+	}
+
+	AZ::IO::FileIOBase* fileIO = gEnv->pFileIO;
+	AZStd::string path = getEntryPath(key);
+
+	AZ::IO::HandleType handle;
+	if(!fileIO->Open(path.c_str(), AZ::IO::OpenMode::ModeRead|AZ::IO::OpenMode::ModeBinary, handle)) {
+		logERROR("TextureCache: cannot open cached texture "<<path.c_str());
+		CryAutoCriticalSection lock(_lock);
+		removeEntry(key);
+		endFileAccess(key);
+		_misses++;
+		return false;
+	}
+
+	// Read and check the blob:
+	TextureCacheHeader header;
+	char* data = nullptr;
+	bool valid = fileIO->Read(handle, &header, sizeof(header), true)
+		&& header.magic == TEXTURECACHE_MAGIC
+		&& header.version == TEXTURECACHE_VERSION
+		&& header.key == key
+		&& header.dataSize + sizeof(header) == size;
+
+	if(valid) {
+		data = new char[header.dataSize];
+		valid = fileIO->Read(handle, data, header.dataSize, true)
+			&& AZ::Crc32(data, header.dataSize) == header.crc;
+	}
+	fileIO->Close(handle);
+
+	if(!valid) {
+		logERROR("TextureCache: removing corrupted cached texture "<<path.c_str());
+		delete [] data;
+		fileIO->Remove(path.c_str());
+
+		CryAutoCriticalSection lock(_lock);
+		removeEntry(key);
+		endFileAccess(key);
+		_corrupted++;
+		_misses++;
+		return false;
+	}
+
+	loadData.m_pData = data;
+	loadData.m_DataSize = (size_t)header.dataSize;
+	loadData.m_Width = (int)header.width;
+	loadData.m_Height = (int)header.height;
+	loadData.m_NumMips = (int)header.numMips;
+	loadData.m_Format = (ETEX_Format)header.format;
+	loadData.m_nFlags = (int)header.flags;
+
+	CryAutoCriticalSection lock(_lock);
+	auto it = _entries.find(key);
+	if(it != _entries.end()) {
+		it->second.lastUse = ++_useCounter;
+	}
+	endFileAccess(key);
+	_hits++;
+	_savedBytes += header.dataSize;
+
+	return true;
+}
+
+void TextureCache::store(AZ::u64 key, const STextureLoadData& loadData)
+{
+	TextureCacheHeader header;
+	header.magic = TEXTURECACHE_MAGIC;
+	header.version = TEXTURECACHE_VERSION;
+	header.key = key;
+	header.width = (AZ::u32)loadData.m_Width;
+	header.height = (AZ::u32)loadData.m_Height;
+	header.numMips = (AZ::u32)loadData.m_NumMips;
+	header.format = (AZ::u32)loadData.m_Format;
+	header.flags = (AZ::u32)loadData.m_nFlags;
+	header.crc = AZ::Crc32(loadData.m_pData, loadData.m_DataSize);
+	header.dataSize = loadData.m_DataSize;
+
+	{
+		CryAutoCriticalSection lock(_lock);
+		init();
+		beginFileAccess(key);
+	}
+
+	AZ::IO::FileIOBase* fileIO = gEnv->pFileIO;
+	AZStd::string path = getEntryPath(key);
+
+	AZ::IO::HandleType handle;
+	bool written = false;
+	if(!fileIO->Open(path.c_str(), AZ::IO::OpenMode::ModeWrite|AZ::IO::OpenMode::ModeBinary, handle)) {
+		logERROR("TextureCache: cannot open "<<path.c_str()<<" for writing.");
+	}
+	else {
+		written = fileIO->Write(handle, &header, sizeof(header))
+			&& fileIO->Write(handle, loadData.m_pData, loadData.m_DataSize);
+		fileIO->Close(handle);
+
+		if(!written) {
+			logERROR("TextureCache: failed to write cached texture "<<path.c_str());
+			fileIO->Remove(path.c_str());
+		}
+	}
+
+	std::vector<AZ::u64> evicted;
+	{
+		CryAutoCriticalSection lock(_lock);
+		if(written) {
+			Entry& entry = _entries[key];
+			_totalBytes -= entry.size;
+			entry.size = sizeof(header) + loadData.m_DataSize;
+			entry.lastUse = ++_useCounter;
+			_totalBytes += entry.size;
+			_stores++;
+		}
+		else {
+			// The previous blob of this key, if any, was overwritten:
+			removeEntry(key);
+		}
+		endFileAccess(key);
+
+		evicted = evict();
+	}
+	removeFiles(evicted);
+}
+
+void TextureCache::beginFileAccess(AZ::u64 key)
+{
+	while(_busyKeys.count(key) > 0) {
+		_fileDone.Wait(_lock);
+	}
+	_busyKeys.insert(key);
+}
+
+void TextureCache::endFileAccess(AZ::u64 key)
+{
+	_busyKeys.erase(key);
+	_fileDone.Notify();
+}
+
+void TextureCache::removeEntry(AZ::u64 key)
+{
+	auto it = _entries.find(key);
+	if(it != _entries.end()) {
+		_totalBytes -= it->second.size;
+		_entries.erase(it);
+	}
+}
+
+void TextureCache::removeFiles(const std::vector<AZ::u64>& keys)
+{
+	if(keys.empty()) {
+		return;
+	}
+
+	for(AZ::u64 key: keys) {
+		gEnv->pFileIO->Remove(getEntryPath(key).c_str());
+	}
+
+	CryAutoCriticalSection lock(_lock);
+	for(AZ::u64 key: keys) {
+		endFileAccess(key);
+	}
+}
+
+std::vector<AZ::u64> TextureCache::evict()
+{
+	// The blobs being accessed are not evicted:
+	std::vector<AZ::u64> evicted;
+	AZ::u64 maxBytes = (AZ::u64)std::max(substance_textureCacheSize, 0)*1024*1024;
+	while(_totalBytes > maxBytes) {
+		auto oldest = _entries.end();
+		for(auto it = _entries.begin(); it != _entries.end(); ++it) {
+			if(_busyKeys.count(it->first) == 0 && (oldest == _entries.end() || it->second.lastUse < oldest->second.lastUse)) {
+				oldest = it;
+			}
+		}
+		if(oldest == _entries.end()) {
+			break;
+		}
+
+		logDEBUG("TextureCache: evicting cached texture "<<getEntryPath(oldest->first).c_str());
+		_busyKeys.insert(oldest->first);
+		evicted.push_back(oldest->first);
+		removeEntry(oldest->first);
+		_evictions++;
+	}
+
+	return evicted;
+}
+
+void TextureCache::clear()
+{
+	std::vector<AZ::u64> removed;
+	{
+		CryAutoCriticalSection lock(_lock);
+		init();
+
+		// The blobs being accessed are removed by the next eviction:
+		for(auto it = _entries.begin(); it != _entries.end();) {
+			if(_busyKeys.count(it->first) == 0) {
+				_busyKeys.insert(it->first);
+				removed.push_back(it->first);
+				_totalBytes -= it->second.size;
+				it = _entries.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+	}
+	removeFiles(removed);
+}
+
+void TextureCache::getStats(Stats& stats)
+{
+	CryAutoCriticalSection lock(_lock);
+	init();
+
+	stats.hits = _hits;
+	stats.misses = _misses;
+	stats.stores = _stores;
+	stats.evictions = _evictions;
+	stats.corrupted = _corrupted;
+	stats.entries = (unsigned int)_entries.size();
+	stats.totalBytes = _totalBytes;
+	stats.savedBytes = _savedBytes;
+}
+
+void TextureCache::dumpStats()
+{
+	Stats stats;
+	getStats(stats);
+
+	unsigned int lookups = stats.hits + stats.misses;
+	CryLogAlways("Substance texture cache: %u textures (%.2f MB), hit rate %.1f%% (%u hits, %u misses), %.2f MB served from cache",
+		stats.entries, stats.totalBytes/(1024.0f*1024.0f), lookups>0 ? 100.0f*stats.hits/lookups : 0.0f,
+		stats.hits, stats.misses, stats.savedBytes/(1024.0f*1024.0f));
+	CryLogAlways("Substance texture cache: %u stores, %u evictions, %u corrupted entries",
+		stats.stores, stats.evictions, stats.corrupted);
+}
+
+#endif // USE_SUBSTANCE
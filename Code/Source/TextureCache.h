@@ -0,0 +1,127 @@
+/** @file TextureCache.h
+	@brief Header for the persistent procedural texture cache
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_TEXTURECACHE_H
+#define GEM_SUBSTANCE_TEXTURECACHE_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include <I3DEngine.h>
+#include <CryThread.h>
+#include <set>
+#include <vector>
+
+#if defined(USE_SUBSTANCE)
+
+class GraphInstance;
+class GraphOutput;
+
+/**
+ Persistent on-disk cache of the rendered procedural textures.
+
+ Entries are content addressed: the key covers the substance archive hash,
+ the graph index, the values of all the graph inputs, the output format
+ and the output UID, so that a warm boot can load the final mip chains
+ without running the substance engine. Each blob stores a CRC of its data
+ checked on load, and the least recently used blobs are removed when the
+ cache grows above substance_textureCacheSize.
+ The lock only protects the index: the blobs are read, written and removed
+ outside of it, and a key is reserved meanwhile so that the accesses to the
+ same blob are serialized.
+*/
+class TextureCache
+{
+public:
+	struct Stats
+	{
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int stores;
+		unsigned int evictions;
+		unsigned int corrupted;
+		unsigned int entries;
+		AZ::u64 totalBytes;
+		AZ::u64 savedBytes;
+	};
+
+	static TextureCache& instance();
+
+	/// Compute the cache key of a graph output, returns false if the output cannot be cached
+	/// (ie. when it depends on a non default image input).
+	static bool computeKey(AZ::u64 packageHash, GraphInstance* graph, GraphOutput* out, AZ::u64& key);
+
+	/// Check if an entry is available for a given key.
+	bool contains(AZ::u64 key);
+
+	/// Load a cached texture, returns false on cache miss.
+	bool load(AZ::u64 key, STextureLoadData& loadData);
+
+	/// Store a texture in the cache.
+	void store(AZ::u64 key, const STextureLoadData& loadData);
+
+	/// Remove all the cached textures.
+	void clear();
+
+	/// Retrieve the cache counters.
+	void getStats(Stats& stats);
+
+	/// Write the cache counters in the log.
+	void dumpStats();
+
+protected:
+	TextureCache();
+
+	// Build the cache index from the files on disk:
+	void init();
+
+	// Wait until the blob of a key is not accessed anymore and reserve it, with the lock held:
+	void beginFileAccess(AZ::u64 key);
+
+	// Release a blob reserved by beginFileAccess(), with the lock held:
+	void endFileAccess(AZ::u64 key);
+
+	// Remove an entry from the index, with the lock held:
+	void removeEntry(AZ::u64 key);
+
+	// Remove the files of reserved entries, then release them, without the lock:
+	void removeFiles(const std::vector<AZ::u64>& keys);
+
+	// Remove and reserve the least recently used entries above the cache size, with the lock held:
+	std::vector<AZ::u64> evict();
+
+	// Retrieve the file path of an entry:
+	static AZStd::string getEntryPath(AZ::u64 key);
+
+	struct Entry
+	{
+		AZ::u64 size;
+		AZ::u64 lastUse;
+	};
+
+	typedef std::map<AZ::u64, Entry> EntryMap;
+	EntryMap _entries;
+
+	// Blobs being read, written or removed:
+	std::set<AZ::u64> _busyKeys;
+
+	bool _initialized;
+	AZ::u64 _useCounter;
+	AZ::u64 _totalBytes;
+
+	unsigned int _hits;
+	unsigned int _misses;
+	unsigned int _stores;
+	unsigned int _evictions;
+	unsigned int _corrupted;
+	AZ::u64 _savedBytes;
+
+	CryCriticalSection _lock;
+	CryConditionVariable _fileDone;		// Signaled when a blob is released
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_TEXTURECACHE_H
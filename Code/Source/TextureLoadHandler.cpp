@@ -0,0 +1,651 @@
+/** @file TextureLoadHandler.cpp
+	@brief Source File for the procedural texture load handler
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#if defined(USE_SUBSTANCE)
+#include "TextureLoadHandler.h"
+#include "MaterialRegistry.h"
+#include "PackageCache.h"
+#include "SubstanceMaterial.h"
+#include "GraphInstance.h"
+#include "GraphOutput.h"
+#include "TextureCache.h"
+#include "GlobalCallbacks.h"
+#include "MaterialDescription.h"
+#include "BlockCompression.h"
+#include "RenderSettings.h"
+#include "RenderScheduler.h"
+#include "RendererPool.h"
+#include "RenderProfiler.h"
+#include "RenderCacheSpill.h"
+#include <ITimer.h>
+#include <IRenderer.h>
+
+// Size of the placeholder textures returned while streaming:
+#define PLACEHOLDER_SIZE 4
+
+static int64 getCurrentTimeMs()
+{
+	return gEnv->pTimer->GetAsyncTime().GetMilliSecondsAsInt64();
+}
+
+CTextureLoadHandler_Substance::CTextureLoadHandler_Substance(SubstanceAir::Renderer* renderer, RendererPool* pool) : _renderer(renderer), _pool(pool), _lastJobId(0)
+{
+}
+
+CTextureLoadHandler_Substance::~CTextureLoadHandler_Substance()
+{
+	cancelJobs();
+	clearResults();
+}
+
+bool CTextureLoadHandler_Substance::SupportsExtension(const char* ext) const
+{
+	if (!strcmp(ext, PROCEDURALTEXTURE_EXTENSION))
+	{
+		return true;
+	}
+
+	return false;
+}
+
+AZStd::string CTextureLoadHandler_Substance::getResultKey(const char* smtlPath, GraphOutputID id)
+{
+	return string_format("%s|%u", PackageCache::normalizePath(smtlPath).c_str(), (unsigned int)id);
+}
+
+bool CTextureLoadHandler_Substance::LoadTextureData(const char* path, STextureLoadData& loadData)
+{
+	logDEBUG("in LoadTextureData with path: "<<path);
+
+	// Read the XML file:
+
+	logDEBUG("Loading XML sub texture: "<<path);
+	auto resolvedPath = getAbsoluteAssetPath(path);
+
+	std::vector<char> xml;
+	if(!readAssetFile(resolvedPath, xml)) {
+		logERROR("Cannot load XML texture from file "<< resolvedPath.c_str());
+		return false;
+	}
+
+	// read the smtl filename and the output id:
+	TextureDescription desc;
+	std::string error;
+	if (!desc.parse(xml.data(), xml.size(), error))
+	{
+		logERROR(error.c_str()<<" for texture "<< resolvedPath.c_str());
+		return false;
+	}
+	const char* smtl = desc.material.c_str();
+	unsigned int id = desc.outputId;
+
+	// Retrieve the shared substance material:
+	logDEBUG("Loading substance material from file: "<<smtl);
+	SubstanceMaterial* smat = MaterialRegistry::instance().acquire(smtl, false);
+
+	// Find the graph containing the requested output:
+	GraphInstance* graph = nullptr;
+	GraphOutput* out = nullptr;
+	for(int i=0; i<smat->GetGraphInstanceCount() && !out; ++i) {
+		graph = (GraphInstance*)smat->GetGraphInstance(i);
+		out = (GraphOutput*)graph->GetOutputByID(id);
+	}
+
+	bool loaded = false;
+	if(!out) {
+		logERROR("Invalid output ID "<<id<<" in material "<<smtl);
+	}
+	else {
+		logDEBUG("Retrieved graph output with label: "<<out->GetLabel());
+
+		AZStd::string resultKey = getResultKey(smat->GetPath(), id);
+		RenderResultPtr result;
+		bool pending = false;
+		{
+			CryAutoCriticalSection lock(_lock);
+
+			// Release the outdated results:
+			expireResults();
+
+			// Check if this output was already rendered with the other outputs of its graph:
+			auto it = _results.find(resultKey);
+			if(it != _results.end()) {
+				logDEBUG("Using parked render result for output "<<id);
+				result = std::move(it->second.result);
+				_results.erase(it);
+			}
+			else {
+				// Or if it is being rendered by a streaming job:
+				auto pit = _pendingOutputs.find(resultKey);
+				if(pit != _pendingOutputs.end()) {
+					pit->second.textures.push_back(path);
+					pending = true;
+				}
+			}
+		}
+
+		// Otherwise check the texture cache:
+		AZ::u64 cacheKey = 0;
+		bool cacheable = !pending && substance_textureCache && TextureCache::computeKey(smat->getPackageHash(), graph, out, cacheKey);
+		if(pending) {
+			logDEBUG("Output "<<id<<" is being rendered, using a placeholder texture");
+			loaded = fillPlaceholder(out, loadData);
+		}
+		else if(!result && cacheable && TextureCache::instance().load(cacheKey, loadData)) {
+			logDEBUG("Loaded output "<<id<<" from the texture cache");
+			loaded = true;
+		}
+		else if(!result && smat->isStreaming()) {
+			startJob(smat, graph, out, path);
+			loaded = fillPlaceholder(out, loadData);
+		}
+		else {
+			if(!result) {
+				result = renderOutputs(smat, graph, out);
+			}
+
+			if(!result) {
+				logERROR("Invalid result!");
+			}
+			else {
+				// The renders are not stored once a render cache item was restored blank, they may be wrong:
+				loaded = fillLoadData(out, *result, loadData);
+				if(loaded && cacheable && RenderCacheSpill::instance().isIntact()) {
+					TextureCache::instance().store(cacheKey, loadData);
+				}
+			}
+		}
+	}
+
+	smat->Release();
+	return loaded;
+}
+
+void CTextureLoadHandler_Substance::collectOutputs(SubstanceMaterial* smat, GraphInstance* graph, GraphOutput* out, std::vector<GraphOutput*>& outputs)
+{
+	// Mark the requested output and all the other exported outputs of this graph as dirty,
+	// so that they are all computed in the same job:
+	SubstanceMaterial::OutputSettings settings;
+	AZ::u64 cacheKey;
+	int nout = graph->GetOutputCount();
+	for(int i=0; i<nout; ++i) {
+		GraphOutput* gout = (GraphOutput*)graph->GetOutput(i);
+		if(gout != out) {
+			if(!smat->getOutputSettings(gout->GetGraphOutputID(), settings) || !settings.enabled || !gout->IsEnabled()) {
+				continue;
+			}
+
+			// No need to render the outputs already available in the texture cache:
+			if(substance_textureCache && TextureCache::computeKey(smat->getPackageHash(), graph, gout, cacheKey) && TextureCache::instance().contains(cacheKey)) {
+				continue;
+			}
+
+			// Nor the outputs already being rendered by a streaming job:
+			CryAutoCriticalSection lock(_lock);
+			if(_pendingOutputs.count(getResultKey(smat->GetPath(), gout->GetGraphOutputID()))) {
+				continue;
+			}
+		}
+
+		gout->SetDirty();
+		outputs.push_back(gout);
+	}
+}
+
+CTextureLoadHandler_Substance::RenderResultPtr CTextureLoadHandler_Substance::renderOutputs(SubstanceMaterial* smat, GraphInstance* graph, GraphOutput* out)
+{
+	std::vector<GraphOutput*> outputs;
+	if(_pool) {
+		// The loads of other graphs from other threads are rendered in parallel by the pool:
+		RenderResultPtr result;
+		AZ::u64 queueTime = RenderProfiler::instance().isEnabled() ? RenderProfiler::now() : 0;
+		_pool->run([&](SubstanceAir::Renderer* renderer) {
+			if(queueTime != 0) {
+				RenderProfiler::instance().addSpan("Queue", "queue", queueTime, RenderProfiler::now(), 0, smat->GetPath(), graph->getGraphIndex());
+			}
+
+			// The outputs are collected, rendered and parked in one step under the graph lock, as the load
+			// of a sibling output from another thread may have rendered and parked this output meanwhile:
+			CryAutoCriticalSection graphLock(graph->getRenderLock());
+			{
+				CryAutoCriticalSection lock(_lock);
+				auto it = _results.find(getResultKey(smat->GetPath(), out->GetGraphOutputID()));
+				if(it != _results.end()) {
+					logDEBUG("Using render result parked meanwhile for output "<<out->GetGraphOutputID());
+					result = std::move(it->second.result);
+					_results.erase(it);
+					return;
+				}
+			}
+
+			collectOutputs(smat, graph, out, outputs);
+			logDEBUG("Rendering graph instance with "<<outputs.size()<<" outputs on the renderer pool");
+			renderer->push(*(graph->getInstance()));
+			// The pool renderers have no callbacks, their renders are accounted here:
+			float start = gEnv->pTimer->GetAsyncTime().GetMilliSeconds();
+			{
+				RenderProfiler::Scope scope("Render", "compute", 0, smat->GetPath(), graph->getGraphIndex());
+				renderer->run();
+			}
+			smat->addRenderTime(gEnv->pTimer->GetAsyncTime().GetMilliSeconds() - start, 1, (unsigned int)outputs.size());
+			result = parkResults(smat, outputs, out);
+		});
+
+		return result;
+	}
+
+	// The loads from other threads wait for the gem renderer:
+	AZ::u64 queueTime = RenderProfiler::instance().isEnabled() ? RenderProfiler::now() : 0;
+	CryAutoCriticalSection renderLock(RenderSettings::instance().getRenderLock());
+	if(queueTime != 0) {
+		RenderProfiler::instance().addSpan("Queue", "queue", queueTime, RenderProfiler::now(), 0, smat->GetPath(), graph->getGraphIndex());
+	}
+	collectOutputs(smat, graph, out, outputs);
+
+	logDEBUG("Pushing graph instance with "<<outputs.size()<<" outputs");
+	{
+		CryAutoCriticalSection graphLock(graph->getRenderLock());
+		_renderer->push(*(graph->getInstance()));
+
+		logDEBUG("Render the outputs...");
+		RenderProfiler::Scope scope("Render", "compute", 0, smat->GetPath(), graph->getGraphIndex());
+		RenderSettings::instance().run(_renderer);
+	}
+
+	return parkResults(smat, outputs, out);
+}
+
+CTextureLoadHandler_Substance::RenderResultPtr CTextureLoadHandler_Substance::parkResults(SubstanceMaterial* smat, const std::vector<GraphOutput*>& outputs, GraphOutput* out)
+{
+	// Grab our result and park the other ones:
+	RenderProfiler::Scope scope("Grab", "load", 0, smat->GetPath(), (unsigned int)outputs.size());
+	RenderResultPtr result;
+	int64 now = getCurrentTimeMs();
+	CryAutoCriticalSection lock(_lock);
+	for(auto gout: outputs) {
+		RenderResultPtr gres = gout->getInstance()->grabResult();
+		if(gres) {
+			SubstanceGlobalCallbacks::instance().setOwner(gres->getTexture().buffer, smat->GetPath(), true);
+		}
+		if(gout == out) {
+			result = std::move(gres);
+		}
+		else if(gres) {
+			ParkedResult& parked = _results[getResultKey(smat->GetPath(), gout->GetGraphOutputID())];
+			parked.result = std::move(gres);
+			parked.timestamp = now;
+		}
+	}
+
+	return result;
+}
+
+void CTextureLoadHandler_Substance::startJob(SubstanceMaterial* smat, GraphInstance* graph, GraphOutput* out, const char* texturePath)
+{
+	CryAutoCriticalSection renderLock(RenderSettings::instance().getRenderLock());
+
+	std::vector<GraphOutput*> outputs;
+	collectOutputs(smat, graph, out, outputs);
+
+	size_t jobId;
+	{
+		CryAutoCriticalSection lock(_lock);
+
+		// The requested output may have been queued by another thread meanwhile:
+		auto pit = _pendingOutputs.find(getResultKey(smat->GetPath(), out->GetGraphOutputID()));
+		if(pit != _pendingOutputs.end()) {
+			pit->second.textures.push_back(texturePath);
+			return;
+		}
+
+		// Register the job before running it, so that its outputs are found by the render callbacks.
+		// The material is kept alive until the job is completed:
+		jobId = ++_lastJobId;
+		PendingJob& job = _jobs[jobId];
+		job.material = smat;
+		job.graph = graph;
+		job.runUid = 0;
+		job.completed = false;
+		smat->AddRef();
+
+		for(auto gout: outputs) {
+			PendingOutput& pending = _pendingOutputs[getResultKey(smat->GetPath(), gout->GetGraphOutputID())];
+			pending.jobId = jobId;
+			if(gout == out) {
+				pending.textures.push_back(texturePath);
+			}
+		}
+	}
+
+	// The streaming jobs of the materials loaded together are spread across the renderer pool:
+	if(_pool) {
+		logDEBUG("Queuing graph instance with "<<outputs.size()<<" outputs for streaming on the renderer pool");
+		AZ::u64 queueTime = RenderProfiler::instance().isEnabled() ? RenderProfiler::now() : 0;
+		_pool->submit([this, jobId, graph, outputs, queueTime](SubstanceAir::Renderer* renderer) {
+			if(queueTime != 0) {
+				RenderProfiler::instance().addSpan("Queue", "queue", queueTime, RenderProfiler::now(), 0, graph->getMaterial()->GetPath(), graph->getGraphIndex());
+			}
+
+			{
+				CryAutoCriticalSection graphLock(graph->getRenderLock());
+				renderer->push(*(graph->getInstance()));
+				float start = gEnv->pTimer->GetAsyncTime().GetMilliSeconds();
+				{
+					RenderProfiler::Scope scope("Render", "compute", 0, graph->getMaterial()->GetPath(), graph->getGraphIndex());
+					renderer->run();
+				}
+				graph->getMaterial()->addRenderTime(gEnv->pTimer->GetAsyncTime().GetMilliSeconds() - start, 1, (unsigned int)outputs.size());
+				for(auto gout: outputs) {
+					outputComputed(jobId, gout->getInstance());
+				}
+			}
+
+			CryAutoCriticalSection lock(_lock);
+			auto jit = _jobs.find(jobId);
+			if(jit != _jobs.end()) {
+				jit->second.completed = true;
+			}
+		});
+		return;
+	}
+
+	logDEBUG("Pushing graph instance with "<<outputs.size()<<" outputs for streaming");
+	unsigned int res;
+	{
+		CryAutoCriticalSection graphLock(graph->getRenderLock());
+		_renderer->push(*(graph->getInstance()));
+		res = RenderSettings::instance().run(_renderer, RenderScheduler::getRunOptions(ProceduralMaterialRenderPriority::Streaming), jobId);
+	}
+
+	// The jobs may have been cancelled meanwhile, and nothing is rendered when the run returns 0:
+	CryAutoCriticalSection lock(_lock);
+	auto jit = _jobs.find(jobId);
+	if(jit != _jobs.end()) {
+		jit->second.runUid = res;
+		jit->second.completed = res == 0;
+	}
+}
+
+void CTextureLoadHandler_Substance::outputComputed(size_t jobId, SubstanceAir::OutputInstance* outputInstance)
+{
+	// Always grab the result, so that it doesn't pile up in the output instance:
+	RenderResultPtr result = outputInstance->grabResult();
+
+	CryAutoCriticalSection lock(_lock);
+	auto jit = _jobs.find(jobId);
+	if(!result || jit == _jobs.end()) {
+		return;
+	}
+
+	SubstanceMaterial* smat = jit->second.material;
+	AZStd::string key = getResultKey(smat->GetPath(), outputInstance->mDesc.mUid);
+
+	// The output may have been discarded while it was being rendered:
+	auto pit = _pendingOutputs.find(key);
+	if(pit == _pendingOutputs.end() || pit->second.jobId != jobId) {
+		logDEBUG("Dropping outdated streaming result "<<key.c_str());
+		return;
+	}
+
+	logDEBUG("Streaming result available for "<<key.c_str());
+	SubstanceGlobalCallbacks::instance().setOwner(result->getTexture().buffer, smat->GetPath(), true);
+	ParkedResult& parked = _results[key];
+	parked.result = std::move(result);
+	parked.timestamp = getCurrentTimeMs();
+
+	// The waiting textures are reloaded on the main thread:
+	_reloads.insert(_reloads.end(), pit->second.textures.begin(), pit->second.textures.end());
+	_pendingOutputs.erase(pit);
+}
+
+void CTextureLoadHandler_Substance::cancelJobs()
+{
+	std::vector<SubstanceMaterial*> releases;
+	{
+		CryAutoCriticalSection lock(_lock);
+		for(auto& job: _jobs) {
+			if(job.second.runUid != 0) {
+				_renderer->cancel(job.second.runUid);
+			}
+			releases.push_back(job.second.material);
+		}
+		_jobs.clear();
+		_pendingOutputs.clear();
+		_reloads.clear();
+	}
+
+	if(releases.empty()) {
+		return;
+	}
+
+	// Don't release the materials while the render threads use them:
+	if(_pool) {
+		_pool->cancelAll();
+	}
+	_renderer->flush();
+	for(auto smat: releases) {
+		smat->Release();
+	}
+}
+
+bool CTextureLoadHandler_Substance::fillPlaceholder(GraphOutput* out, STextureLoadData& loadData)
+{
+	// Flat normal for the normal maps, mid grey otherwise:
+	bool normal = out->GetChannel()==GraphOutputChannel::Normal;
+
+	loadData.m_Width = PLACEHOLDER_SIZE;
+	loadData.m_Height = PLACEHOLDER_SIZE;
+	loadData.m_NumMips = 1;
+	loadData.m_Format = eTF_R8G8B8A8;
+	loadData.m_nFlags = normal ? FT_TEX_NORMAL_MAP : 0;
+	loadData.m_DataSize = PLACEHOLDER_SIZE*PLACEHOLDER_SIZE*4;
+
+	unsigned char* data = new unsigned char[loadData.m_DataSize];
+	for(int i=0; i<PLACEHOLDER_SIZE*PLACEHOLDER_SIZE; ++i) {
+		data[4*i+0] = 128;
+		data[4*i+1] = 128;
+		data[4*i+2] = normal ? 255 : 128;
+		data[4*i+3] = 255;
+	}
+	loadData.m_pData = data;
+
+	return true;
+}
+
+bool CTextureLoadHandler_Substance::fillLoadData(GraphOutput* out, SubstanceAir::RenderResult& result, STextureLoadData& loadData)
+{
+	RenderProfiler::Scope scope("Copy", "load", 0, out->GetGraphInstance()->GetProceduralMaterial()->GetPath(), out->GetGraphOutputID());
+	auto stex = result.getTexture();
+	logDEBUG("MipmapCount="<< (int)stex.mipmapCount);
+	logDEBUG("Width="<< (int)stex.level0Width);
+	logDEBUG("Height="<< (int)stex.level0Height);
+	logDEBUG("PixelFormat="<< (int)stex.pixelFormat);
+	logDEBUG("ChannelsOrder="<< (int)stex.channelsOrder);
+
+	// Check if this output is block compressed by the gem:
+	SubstanceMaterial::OutputSettings settings;
+	SubstanceMaterial* smat = (SubstanceMaterial*)out->GetGraphInstance()->GetProceduralMaterial();
+	if(smat->getOutputSettings(out->GetGraphOutputID(), settings) && settings.encoding != SubstanceMaterial::OutputEncoding_None) {
+		if(((int)stex.pixelFormat & ~Substance_PF_sRGB) == Substance_PF_RGBA) {
+			return encodeLoadData(out, result, settings.encoding, loadData);
+		}
+
+		logERROR("Cannot encode output "<<out->GetGraphOutputID()<<" with pixel format "<<(int)stex.pixelFormat);
+	}
+
+	// Compute the size of the mip chain, with 4x4 blocks for the compressed formats:
+	loadData.m_DataSize = 0;
+	int num = (int)stex.mipmapCount;
+	for(int i=0;i<num;++i) {
+		int ww = std::max((int)stex.level0Width>>i, 1);
+		int hh = std::max((int)stex.level0Height>>i, 1);
+		loadData.m_DataSize += out->GetLevelSize((int)stex.pixelFormat, ww, hh);
+	}
+
+	loadData.m_Width = (int)stex.level0Width;
+	loadData.m_Height = (int)stex.level0Height;
+	loadData.m_NumMips = (int)stex.mipmapCount;
+	loadData.m_nFlags = out->GetChannel()==GraphOutputChannel::Normal ? FT_TEX_NORMAL_MAP : 0;
+	loadData.m_Format = out->GetEngineFormat((int)stex.pixelFormat);
+
+	if((int)stex.channelsOrder != 0) {
+		logERROR("Unexpected channel order: "<<(int)stex.channelsOrder);
+	}
+
+	// Hand the result buffer over to the engine when it was allocated with new[], instead of copying it:
+	if(substance_zeroCopyOutputs && SubstanceGlobalCallbacks::instance().isArrayAllocated(stex.buffer)) {
+		SubstanceGlobalCallbacks::instance().detach(stex.buffer);
+		loadData.m_pData = result.releaseBuffer();
+	}
+	else {
+		loadData.m_pData = new char[loadData.m_DataSize];
+		memcpy(loadData.m_pData, stex.buffer, loadData.m_DataSize);
+	}
+
+	return true;
+}
+
+bool CTextureLoadHandler_Substance::encodeLoadData(GraphOutput* out, SubstanceAir::RenderResult& result, int encoding, STextureLoadData& loadData)
+{
+	RenderProfiler::Scope scope("Encode", "load", 0, out->GetGraphInstance()->GetProceduralMaterial()->GetPath(), out->GetGraphOutputID());
+	auto stex = result.getTexture();
+	BlockCompression::Format format = encoding == SubstanceMaterial::OutputEncoding_BC5 ? BlockCompression::Format_BC5 : BlockCompression::Format_BC7;
+
+	int width = (int)stex.level0Width;
+	int height = (int)stex.level0Height;
+	int num = (int)stex.mipmapCount;
+
+	loadData.m_DataSize = 0;
+	for(int i=0;i<num;++i) {
+		loadData.m_DataSize += BlockCompression::getEncodedSize(std::max(width>>i, 1), std::max(height>>i, 1));
+	}
+
+	loadData.m_Width = width;
+	loadData.m_Height = height;
+	loadData.m_NumMips = num;
+	loadData.m_nFlags = out->GetChannel()==GraphOutputChannel::Normal ? FT_TEX_NORMAL_MAP : 0;
+	loadData.m_Format = format == BlockCompression::Format_BC5 ? eTF_BC5U : eTF_BC7;
+
+	// Encode the mip levels one after the other, the blocks of each level are split across the encoder threads:
+	CTimeValue start = gEnv->pTimer->GetAsyncTime();
+	char* data = new char[loadData.m_DataSize];
+	const uint8_t* src = (const uint8_t*)stex.buffer;
+	uint8_t* dst = (uint8_t*)data;
+	for(int i=0;i<num;++i) {
+		int ww = std::max(width>>i, 1);
+		int hh = std::max(height>>i, 1);
+		BlockCompression::encodeImage(format, src, ww, hh, dst, BlockCompression::Kernel_Best, substance_encodeThreads);
+		src += (size_t)ww*hh*4;
+		dst += BlockCompression::getEncodedSize(ww, hh);
+	}
+	loadData.m_pData = data;
+
+	logDEBUG("Encoded output "<<out->GetGraphOutputID()<<" to "<<(format == BlockCompression::Format_BC5 ? "BC5" : "BC7")
+		<<" with "<<BlockCompression::getKernelName(BlockCompression::getBestKernel())<<" kernels in "
+		<<(gEnv->pTimer->GetAsyncTime() - start).GetMilliSeconds()<<" ms");
+
+	return true;
+}
+
+void CTextureLoadHandler_Substance::expireResults()
+{
+	int64 limit = getCurrentTimeMs() - substance_resultLifetime;
+	for(auto it = _results.begin(); it != _results.end(); ) {
+		if(it->second.timestamp < limit) {
+			logDEBUG("Releasing unused render result "<<it->first.c_str());
+			it = _results.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void CTextureLoadHandler_Substance::clearResults()
+{
+	CryAutoCriticalSection lock(_lock);
+	_results.clear();
+}
+
+void CTextureLoadHandler_Substance::discardResults(const char* smtlPath)
+{
+	AZStd::string prefix = PackageCache::normalizePath(smtlPath)+"|";
+
+	CryAutoCriticalSection lock(_lock);
+	for(auto it = _results.begin(); it != _results.end(); ) {
+		if(it->first.compare(0, prefix.size(), prefix) == 0) {
+			it = _results.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	// The outputs being streamed are outdated too, their textures are requested again:
+	for(auto it = _pendingOutputs.begin(); it != _pendingOutputs.end(); ) {
+		if(it->first.compare(0, prefix.size(), prefix) == 0) {
+			_reloads.insert(_reloads.end(), it->second.textures.begin(), it->second.textures.end());
+			it = _pendingOutputs.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void CTextureLoadHandler_Substance::Update()
+{
+	std::vector<AZStd::string> reloads;
+	std::vector<SubstanceMaterial*> releases;
+
+	// Don't stall the caller while the tables are used:
+	if(_lock.TryLock()) {
+		expireResults();
+		reloads.swap(_reloads);
+
+		// Complete the finished streaming jobs:
+		for(auto jit = _jobs.begin(); jit != _jobs.end(); ) {
+			bool pending = jit->second.runUid != 0 ? _renderer->isPending(jit->second.runUid) : !jit->second.completed;
+			if(pending) {
+				++jit;
+				continue;
+			}
+
+			// The outputs which were not computed are requested again:
+			for(auto it = _pendingOutputs.begin(); it != _pendingOutputs.end(); ) {
+				if(it->second.jobId == jit->first) {
+					reloads.insert(reloads.end(), it->second.textures.begin(), it->second.textures.end());
+					it = _pendingOutputs.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+
+			releases.push_back(jit->second.material);
+			jit = _jobs.erase(jit);
+		}
+
+		_lock.Unlock();
+	}
+
+	// Upload the final textures:
+	for(auto& path: reloads) {
+		ITexture* pTexture = gEnv->pRenderer->EF_GetTextureByName(path.c_str());
+		if(pTexture) {
+			logDEBUG("Reloading streamed texture "<<path.c_str());
+			pTexture->Reload();
+		}
+	}
+
+	for(auto smat: releases) {
+		smat->Release();
+	}
+}
+
+#endif // USE_SUBSTANCE
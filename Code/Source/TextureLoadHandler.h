@@ -0,0 +1,135 @@
+/** @file TextureLoadHandler.h
+	@brief Header for the procedural texture load handler
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_TEXTURELOADHANDLER_H
+#define GEM_SUBSTANCE_TEXTURELOADHANDLER_H
+#pragma once
+
+#include "Substance/IProceduralMaterial.h"
+#include "Substance/framework/renderer.h"
+#include <I3DEngine.h>
+#include <CryThread.h>
+
+#if defined(USE_SUBSTANCE)
+
+class SubstanceMaterial;
+class GraphInstance;
+class GraphOutput;
+class RendererPool;
+
+/**
+ Texture load handler for the .sub procedural textures.
+
+ All the exported outputs of a graph are rendered in a single job when the
+ first of its textures is requested: the results of the other outputs are
+ parked in a short lived result table, from which the next LoadTextureData()
+ calls for the same material are served.
+
+ Materials in streaming mode don't block the caller: a small placeholder is
+ returned at once and the job is run asynchronously. When an output is
+ computed its result is parked and the textures waiting for it are reloaded
+ from Update(), which serves them the final mip chain.
+
+ When a renderer pool is set (substance_rendererPoolSize), the jobs are run
+ by its workers instead of the gem renderer, so that the graphs of different
+ materials are rendered in parallel.
+*/
+struct CTextureLoadHandler_Substance : public ITextureLoadHandler
+{
+	CTextureLoadHandler_Substance(SubstanceAir::Renderer* renderer, RendererPool* pool);
+	virtual ~CTextureLoadHandler_Substance();
+
+	virtual bool SupportsExtension(const char* ext) const override;
+	virtual bool LoadTextureData(const char* path, STextureLoadData& loadData) override;
+	virtual void Update() override;
+
+	/// Release all the parked render results.
+	void clearResults();
+
+	/// Release the parked render results of a material, which are outdated once its inputs change.
+	void discardResults(const char* smtlPath);
+
+	/// Park the result of an output computed by a streaming job (called from the render thread).
+	void outputComputed(size_t jobId, SubstanceAir::OutputInstance* outputInstance);
+
+	/// Cancel the pending streaming jobs and wait for the renderer.
+	void cancelJobs();
+
+protected:
+	typedef std::unique_ptr<SubstanceAir::RenderResult> RenderResultPtr;
+
+	// Collect the outputs to render along with a requested output:
+	void collectOutputs(SubstanceMaterial* smat, GraphInstance* graph, GraphOutput* out, std::vector<GraphOutput*>& outputs);
+
+	// Render all the exported outputs of a graph together:
+	RenderResultPtr renderOutputs(SubstanceMaterial* smat, GraphInstance* graph, GraphOutput* out);
+
+	// Grab the results of the rendered outputs, park them and return the result of the requested output:
+	RenderResultPtr parkResults(SubstanceMaterial* smat, const std::vector<GraphOutput*>& outputs, GraphOutput* out);
+
+	// Start a streaming job for all the exported outputs of a graph:
+	void startJob(SubstanceMaterial* smat, GraphInstance* graph, GraphOutput* out, const char* texturePath);
+
+	// Fill the texture load data with a placeholder texture:
+	bool fillPlaceholder(GraphOutput* out, STextureLoadData& loadData);
+
+	// Fill the texture load data from a render result:
+	bool fillLoadData(GraphOutput* out, SubstanceAir::RenderResult& result, STextureLoadData& loadData);
+
+	// Fill the texture load data with the block compressed mip chain of a RGBA8 render result:
+	bool encodeLoadData(GraphOutput* out, SubstanceAir::RenderResult& result, int encoding, STextureLoadData& loadData);
+
+	// Release the parked results older than the result lifetime:
+	void expireResults();
+
+	// Build the key of a parked result:
+	static AZStd::string getResultKey(const char* smtlPath, GraphOutputID id);
+
+	SubstanceAir::Renderer* _renderer;
+	RendererPool* _pool;
+
+	struct ParkedResult
+	{
+		RenderResultPtr result;
+		int64 timestamp;
+	};
+
+	typedef std::map<AZStd::string, ParkedResult> ResultMap;
+	ResultMap _results;
+
+	// Streaming jobs in flight, the material is referenced until the job is completed:
+	struct PendingJob
+	{
+		SubstanceMaterial* material;
+		GraphInstance* graph;
+		unsigned int runUid;
+		bool completed;		// Set when a job run by the pool is completed
+	};
+
+	typedef std::map<size_t, PendingJob> JobMap;
+	JobMap _jobs;
+	size_t _lastJobId;
+
+	// Outputs being computed by a streaming job, with the textures waiting for them:
+	struct PendingOutput
+	{
+		size_t jobId;
+		std::vector<AZStd::string> textures;
+	};
+
+	typedef std::map<AZStd::string, PendingOutput> PendingOutputMap;
+	PendingOutputMap _pendingOutputs;
+
+	// Textures to reload from the main thread:
+	std::vector<AZStd::string> _reloads;
+
+	// Lock on the tables above, taken after the render lock of RenderSettings:
+	CryCriticalSection _lock;
+};
+
+#endif // USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_TEXTURELOADHANDLER_H
@@ -0,0 +1,226 @@
+/** @file BlockCompressionBenchmark.cpp
+	@brief Benchmark of the BC5/BC7 block compression kernels
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include <AzTest/AzTest.h>
+#include "BlockCompression.h"
+#include <AzCore/Jobs/JobContext.h>
+#include <AzCore/Jobs/JobManager.h>
+#include <AzCore/Memory/PoolAllocator.h>
+#include <AzCore/Memory/SystemAllocator.h>
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace BlockCompression;
+
+class BlockCompressionBenchmark
+    : public ::testing::Test
+{
+protected:
+    static const int kSize = 1024;
+
+    void SetUp() override
+    {
+        // The images are encoded on the jobs of a job manager with a worker per core:
+        m_OwnsAllocators = !AZ::AllocatorInstance<AZ::SystemAllocator>::IsReady();
+        if(m_OwnsAllocators) {
+            AZ::AllocatorInstance<AZ::SystemAllocator>::Create();
+            AZ::AllocatorInstance<AZ::PoolAllocator>::Create();
+            AZ::AllocatorInstance<AZ::ThreadPoolAllocator>::Create();
+        }
+        AZ::JobManagerDesc desc;
+        AZ::JobManagerThreadDesc threadDesc;
+        for(unsigned int i=0; i<std::max(std::thread::hardware_concurrency(), 1u); ++i) {
+            desc.m_workerThreads.push_back(threadDesc);
+        }
+        m_JobManager = aznew AZ::JobManager(desc);
+        m_JobContext = aznew AZ::JobContext(*m_JobManager);
+        AZ::JobContext::SetGlobalContext(m_JobContext);
+
+        // Normal map computed from a bumpy height field:
+        m_Normals.resize(kSize*kSize*4);
+        for(int y=0; y<kSize; ++y) {
+            for(int x=0; x<kSize; ++x) {
+                float dx = 0.5f*cosf(x*0.05f)*cosf(y*0.021f);
+                float dy = -0.5f*sinf(x*0.05f)*sinf(y*0.021f);
+                float len = sqrtf(dx*dx + dy*dy + 1.0f);
+                uint8_t* p = &m_Normals[4*(y*kSize + x)];
+                p[0] = (uint8_t)(127.5f + 127.5f*dx/len);
+                p[1] = (uint8_t)(127.5f + 127.5f*dy/len);
+                p[2] = (uint8_t)(127.5f + 127.5f/len);
+                p[3] = 255;
+            }
+        }
+
+        // Color gradients with some noise and a varying alpha:
+        m_Colors.resize(kSize*kSize*4);
+        unsigned int seed = 1;
+        for(int y=0; y<kSize; ++y) {
+            for(int x=0; x<kSize; ++x) {
+                seed = seed*1103515245u + 12345u;
+                uint8_t* p = &m_Colors[4*(y*kSize + x)];
+                p[0] = (uint8_t)((x*255/kSize) ^ ((seed>>16)&7));
+                p[1] = (uint8_t)(y*255/kSize);
+                p[2] = (uint8_t)((x+y)/8);
+                p[3] = (uint8_t)(255 - (x&63));
+            }
+        }
+    }
+
+    void TearDown() override
+    {
+        AZ::JobContext::SetGlobalContext(nullptr);
+        delete m_JobContext;
+        delete m_JobManager;
+        if(m_OwnsAllocators) {
+            AZ::AllocatorInstance<AZ::ThreadPoolAllocator>::Destroy();
+            AZ::AllocatorInstance<AZ::PoolAllocator>::Destroy();
+            AZ::AllocatorInstance<AZ::SystemAllocator>::Destroy();
+        }
+    }
+
+    // Encode an image and return the throughput in MPix/s:
+    double Encode(Format format, const std::vector<uint8_t>& image, std::vector<uint8_t>& out, Kernel kernel, int jobCount)
+    {
+        out.resize(getEncodedSize(kSize, kSize));
+        auto start = std::chrono::high_resolution_clock::now();
+        encodeImage(format, image.data(), kSize, kSize, out.data(), kernel, jobCount);
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        return kSize*kSize/(seconds*1e6);
+    }
+
+    // Root mean square error of the decoded blocks:
+    double ComputeRMSE(Format format, const std::vector<uint8_t>& image, const std::vector<uint8_t>& blocks)
+    {
+        static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        int channels = format == Format_BC5 ? 2 : 4;
+        double error = 0.0;
+        int bw = kSize/4;
+
+        for(int by=0; by<kSize/4; ++by) {
+            for(int bx=0; bx<bw; ++bx) {
+                const uint8_t* block = &blocks[16*(by*bw + bx)];
+                int pixels[16][4];
+
+                if(format == Format_BC5) {
+                    for(int c=0; c<2; ++c) {
+                        const uint8_t* b = block + 8*c;
+                        int palette[8] = { b[0], b[1] };
+                        for(int k=1; k<7; ++k) {
+                            palette[k+1] = b[0] > b[1] ? ((7-k)*b[0] + k*b[1])/7 : (k<5 ? ((5-k)*b[0] + k*b[1])/5 : (k==5 ? 0 : 255));
+                        }
+                        uint64_t bits = 0;
+                        for(int i=0; i<6; ++i) {
+                            bits |= (uint64_t)b[2+i] << (8*i);
+                        }
+                        for(int i=0; i<16; ++i) {
+                            pixels[i][c] = palette[(bits >> (3*i)) & 7];
+                        }
+                    }
+                }
+                else {
+                    // Mode 6 only:
+                    int pos = 0;
+                    auto read = [&](int count) {
+                        int v = 0;
+                        for(int i=0; i<count; ++i, ++pos) {
+                            v |= ((block[pos>>3] >> (pos&7)) & 1) << i;
+                        }
+                        return v;
+                    };
+                    EXPECT_EQ(read(7), 64);
+                    int e[2][4];
+                    for(int c=0; c<4; ++c) {
+                        e[0][c] = read(7);
+                        e[1][c] = read(7);
+                    }
+                    int p0 = read(1);
+                    int p1 = read(1);
+                    for(int c=0; c<4; ++c) {
+                        e[0][c] = (e[0][c] << 1) | p0;
+                        e[1][c] = (e[1][c] << 1) | p1;
+                    }
+                    for(int i=0; i<16; ++i) {
+                        int idx = read(i==0 ? 3 : 4);
+                        for(int c=0; c<4; ++c) {
+                            pixels[i][c] = ((64-weights[idx])*e[0][c] + weights[idx]*e[1][c] + 32) >> 6;
+                        }
+                    }
+                }
+
+                for(int i=0; i<16; ++i) {
+                    const uint8_t* ref = &image[4*((by*4 + i/4)*kSize + bx*4 + i%4)];
+                    for(int c=0; c<channels; ++c) {
+                        double d = pixels[i][c] - ref[c];
+                        error += d*d;
+                    }
+                }
+            }
+        }
+
+        return sqrt(error/(kSize*kSize*channels));
+    }
+
+    void RunBenchmark(Format format, const std::vector<uint8_t>& image, const char* name)
+    {
+        std::vector<uint8_t> reference;
+        double scalar = Encode(format, image, reference, Kernel_Scalar, 1);
+        printf("[%s] %-6s: %8.2f MPix/s per core\n", name, getKernelName(Kernel_Scalar), scalar);
+
+        // The SIMD kernels must produce the same blocks as the scalar reference:
+        for(Kernel kernel: { Kernel_SSE2, Kernel_AVX2 }) {
+            if(!isKernelSupported(kernel)) {
+                printf("[%s] %-6s: not supported\n", name, getKernelName(kernel));
+                continue;
+            }
+
+            std::vector<uint8_t> out;
+            double rate = Encode(format, image, out, kernel, 1);
+            printf("[%s] %-6s: %8.2f MPix/s per core (x%.2f)\n", name, getKernelName(kernel), rate, rate/scalar);
+            EXPECT_TRUE(out == reference);
+        }
+
+        int cores = (int)std::max(std::thread::hardware_concurrency(), 1u);
+        std::vector<uint8_t> out;
+        double rate = Encode(format, image, out, Kernel_Best, cores);
+        printf("[%s] %d jobs: %8.2f MPix/s (%.2f MPix/s per core)\n", name, cores, rate, rate/cores);
+        EXPECT_TRUE(out == reference);
+
+        double rmse = ComputeRMSE(format, image, reference);
+        printf("[%s] RMSE: %.2f\n", name, rmse);
+        EXPECT_LT(rmse, 4.0);
+    }
+
+    std::vector<uint8_t> m_Normals;
+    std::vector<uint8_t> m_Colors;
+    AZ::JobManager* m_JobManager;
+    AZ::JobContext* m_JobContext;
+    bool m_OwnsAllocators;
+};
+
+TEST_F(BlockCompressionBenchmark, BC5Normals)
+{
+    RunBenchmark(Format_BC5, m_Normals, "BC5");
+}
+
+TEST_F(BlockCompressionBenchmark, BC7Colors)
+{
+    RunBenchmark(Format_BC7, m_Colors, "BC7");
+}
+
+TEST_F(BlockCompressionBenchmark, PartialBlocks)
+{
+    // Images smaller than a block and with partial border blocks:
+    for(int size: { 1, 2, 3, 5, 13 }) {
+        std::vector<uint8_t> out(getEncodedSize(size, size+1));
+        encodeImage(Format_BC7, m_Colors.data(), size, size+1, out.data());
+        encodeImage(Format_BC5, m_Normals.data(), size, size+1, out.data());
+    }
+}
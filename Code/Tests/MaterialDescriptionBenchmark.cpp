@@ -0,0 +1,145 @@
+/** @file MaterialDescriptionBenchmark.cpp
+	@brief Benchmark of the parsing of the procedural material and texture files
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include <AzTest/AzTest.h>
+#include "MaterialDescription.h"
+
+#include <chrono>
+#include <string>
+
+class MaterialDescriptionBenchmark
+    : public ::testing::Test
+{
+protected:
+    static const int kParseCount = 2000;
+
+    // Material of a PBR graph with many tweaks, as saved by the editor:
+    static std::string MakeMaterial(int outputCount, int parameterCount)
+    {
+        std::string xml = "<ProceduralMaterial Source=\"materials/substance/rock.sbsar\" Streaming=\"1\">\n";
+        for(int o=0; o<outputCount; ++o) {
+            xml += "  <Output ID=\"" + std::to_string(1000 + o) + "\" Enabled=\"" + (o%3 ? "1" : "0") + "\" Compressed=\"1\" Encode=\"" + (o%2 ? "BC7" : "None") + "\"/>\n";
+        }
+        for(int p=0; p<parameterCount; ++p) {
+            int type = p%3 == 0 ? 0 : (p%3 == 1 ? 3 : 4);
+            xml += "  <Parameter ID=\"input" + std::to_string(p) + "\" Type=\"" + std::to_string(type) + "\" Static=\"" + (p%4 ? "0" : "1") + "\"";
+            xml += " x=\"" + std::to_string(p*0.5f) + "\" y=\"0.25\" z=\"1\" w=\"0.75\"/>\n";
+        }
+        xml += "</ProceduralMaterial>\n";
+        return xml;
+    }
+
+    template<typename Desc>
+    static double Parse(const std::string& xml)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int i=0; i<kParseCount; ++i) {
+            Desc desc;
+            std::string error;
+            EXPECT_TRUE(desc.parse(xml.data(), xml.size(), error));
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count()/kParseCount;
+    }
+};
+
+TEST_F(MaterialDescriptionBenchmark, Material)
+{
+    const std::string xml =
+        "<ProceduralMaterial Source=\"materials/substance/wood.sbsar\" Streaming=\"true\">\n"
+        "  <!-- Outputs of the textures -->\n"
+        "  <Output ID=\"12\" Enabled=\"0\"/>\n"
+        "  <Output ID=\"13\" Compressed=\"false\" Encode=\"BC5\"/>\n"
+        "  <Output ID=\"14\" Encode=\"DXT1\"/>\n"
+        "  <Output Enabled=\"1\"/>\n"
+        "  <Stack Source=\"materials/substance/weathering.sbsar\" PostGraph=\"1\" KeepNonConnected=\"1\">\n"
+        "    <Connection Output=\"12\" Input=\"40\"/>\n"
+        "    <Connection Output=\"13\"/>\n"
+        "  </Stack>\n"
+        "  <Parameter ID=\"$randomseed\" Type=\"4\" x=\"42\" Static=\"1\"/>\n"
+        "  <Parameter ID=\"tint\" Type=\"3\" x=\"0.5\" y=\"0.25\" z=\"1\" w=\"0.125\"/>\n"
+        "  <Parameter ID=\"label\" Type=\"12\" str=\"oak &amp; pine\"/>\n"
+        "  <Parameter ID=\"untyped\" x=\"1\"/>\n"
+        "</ProceduralMaterial>\n";
+
+    MaterialDescription desc;
+    std::string error;
+    ASSERT_TRUE(desc.parse(xml.data(), xml.size(), error));
+    EXPECT_EQ(desc.source, "materials/substance/wood.sbsar");
+    EXPECT_EQ(desc.streaming, 1);
+
+    // The outputs without ID are skipped, the unknown encodings are reported:
+    ASSERT_EQ(desc.outputs.size(), 3u);
+    EXPECT_EQ(desc.outputs[0].id, 12u);
+    EXPECT_FALSE(desc.outputs[0].enabled);
+    EXPECT_TRUE(desc.outputs[0].compressed);
+    EXPECT_EQ(desc.outputs[0].encoding, MaterialDescription::Encoding_None);
+    EXPECT_TRUE(desc.outputs[1].enabled);
+    EXPECT_FALSE(desc.outputs[1].compressed);
+    EXPECT_EQ(desc.outputs[1].encoding, MaterialDescription::Encoding_BC5);
+    EXPECT_EQ(desc.outputs[2].encoding, MaterialDescription::Encoding_None);
+    ASSERT_EQ(desc.warnings.size(), 1u);
+
+    ASSERT_TRUE(desc.stacked);
+    EXPECT_EQ(desc.stack.postPath, "materials/substance/weathering.sbsar");
+    EXPECT_EQ(desc.stack.preGraph, 0);
+    EXPECT_EQ(desc.stack.postGraph, 1);
+    EXPECT_TRUE(desc.stack.keepNonConnected);
+    ASSERT_EQ(desc.stack.connections.size(), 1u);
+    EXPECT_EQ(desc.stack.connections[0], std::make_pair(12u, 40u));
+
+    // The parameters without type are skipped:
+    ASSERT_EQ(desc.parameters.size(), 3u);
+    EXPECT_EQ(desc.parameters[0].id, "$randomseed");
+    EXPECT_TRUE(desc.parameters[0].isStatic);
+    EXPECT_EQ(desc.parameters[0].ints[0], 42);
+    EXPECT_FALSE(desc.parameters[1].isStatic);
+    EXPECT_EQ(desc.parameters[1].type, 3);
+    EXPECT_FLOAT_EQ(desc.parameters[1].floats[1], 0.25f);
+    EXPECT_FLOAT_EQ(desc.parameters[1].floats[3], 0.125f);
+    EXPECT_EQ(desc.parameters[2].str, "oak & pine");
+}
+
+TEST_F(MaterialDescriptionBenchmark, Invalid)
+{
+    std::string error;
+
+    const std::string noSource = "<ProceduralMaterial Streaming=\"0\"/>";
+    MaterialDescription material;
+    EXPECT_FALSE(material.parse(noSource.data(), noSource.size(), error));
+    EXPECT_FALSE(error.empty());
+
+    const std::string noOutput = "<ProceduralTexture Material=\"materials/substance/wood.smtl\"/>";
+    TextureDescription texture;
+    error.clear();
+    EXPECT_FALSE(texture.parse(noOutput.data(), noOutput.size(), error));
+    EXPECT_FALSE(error.empty());
+}
+
+TEST_F(MaterialDescriptionBenchmark, Texture)
+{
+    const std::string xml = "<ProceduralTexture Material=\"materials/substance/wood.smtl\" OutputID=\"4294967295\"/>";
+
+    TextureDescription desc;
+    std::string error;
+    ASSERT_TRUE(desc.parse(xml.data(), xml.size(), error));
+    EXPECT_EQ(desc.material, "materials/substance/wood.smtl");
+    EXPECT_EQ(desc.outputId, 4294967295u);
+}
+
+TEST_F(MaterialDescriptionBenchmark, Parse)
+{
+    const std::string texture = "<ProceduralTexture Material=\"materials/substance/rock.smtl\" OutputID=\"1003\"/>";
+    double textureUs = Parse<TextureDescription>(texture);
+    printf("[Parse] sub: %6.2f us per file (%u bytes)\n", textureUs, (unsigned int)texture.size());
+
+    for(int parameterCount: { 16, 64, 256 }) {
+        const std::string material = MakeMaterial(8, parameterCount);
+        double materialUs = Parse<MaterialDescription>(material);
+        printf("[Parse] smtl with %3d parameters: %8.2f us per file (%u bytes)\n", parameterCount, materialUs, (unsigned int)material.size());
+    }
+}
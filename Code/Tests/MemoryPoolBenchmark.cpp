@@ -0,0 +1,219 @@
+/** @file MemoryPoolBenchmark.cpp
+	@brief Benchmark of the memory pool
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include <AzTest/AzTest.h>
+#include "MemoryPool.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+class MemoryPoolBenchmark
+    : public ::testing::Test
+{
+protected:
+    // Renders of a level: each one allocates the intermediate images of a graph and a few small objects:
+    static const int kRenderCount = 2000;
+    static const int kImagesPerRender = 12;
+    static const int kObjectsPerRender = 64;
+
+    static size_t GetImageSize(int render, int image)
+    {
+        // 256x256 to 1024x1024 RGBA8 images, with a few odd sizes:
+        size_t side = (size_t)256 << ((render + image)%3);
+        return side*side*4 + (image%4 == 3 ? 4096 : 0);
+    }
+
+    template<typename Alloc, typename Free>
+    double Run(Alloc alloc, Free release)
+    {
+        std::vector<void*> buffers;
+        buffers.reserve(kImagesPerRender + kObjectsPerRender);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int r=0; r<kRenderCount; ++r) {
+            for(int i=0; i<kImagesPerRender; ++i) {
+                size_t size = GetImageSize(r, i);
+                void* buffer = alloc(size, i%2 ? 16 : 64);
+                // Touch the buffer like the engine writes its first line:
+                memset(buffer, r, std::min(size, (size_t)4096));
+                buffers.push_back(buffer);
+            }
+            for(int o=0; o<kObjectsPerRender; ++o) {
+                buffers.push_back(alloc(16 + (o*24)%512, 8));
+            }
+            for(void* buffer: buffers) {
+                release(buffer);
+            }
+            buffers.clear();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+};
+
+TEST_F(MemoryPoolBenchmark, Churn)
+{
+    double heap = Run(
+        [](size_t size, size_t alignment) -> void* { return new unsigned char[size + alignment]; },
+        [](void* buffer) { delete [] (unsigned char*)buffer; });
+
+    MemoryPool pool((size_t)512*1024*1024);
+    double pooled = Run(
+        [&pool](size_t size, size_t alignment) { return pool.allocate(size, alignment); },
+        [&pool](void* buffer) { EXPECT_TRUE(pool.release(buffer)); });
+
+    MemoryPool::Stats stats = pool.getStats();
+    printf("[Churn] heap: %8.1f ms, pool: %8.1f ms (x%.2f), %.1f%% reused, peak %.1f MB\n", heap, pooled, heap/pooled,
+        100.0*stats.reuses/stats.allocations, stats.peakLiveBytes/(1024.0*1024.0));
+
+    EXPECT_EQ(stats.liveBytes, 0u);
+    EXPECT_EQ(stats.requestedBytes, 0u);
+    EXPECT_EQ(stats.overruns, 0u);
+    EXPECT_GT(stats.reuses, stats.allocations/2);
+}
+
+TEST_F(MemoryPoolBenchmark, SizeClasses)
+{
+    EXPECT_EQ(MemoryPool::getSizeClass(1), 16u);
+    EXPECT_EQ(MemoryPool::getSizeClass(1024), 1024u);
+    EXPECT_EQ(MemoryPool::getSizeClass(1025), 1280u);
+    EXPECT_EQ(MemoryPool::getSizeClass(4096), 4096u);
+    EXPECT_EQ(MemoryPool::getSizeClass(4097), 5120u);
+
+    // The size class rounding stays under 25%:
+    for(size_t size=1025; size<(1u<<24); size=size*3/2 + 1) {
+        size_t classSize = MemoryPool::getSizeClass(size);
+        EXPECT_GE(classSize, size);
+        EXPECT_LE(classSize - size, size/4);
+    }
+}
+
+TEST_F(MemoryPoolBenchmark, Alignment)
+{
+    MemoryPool pool;
+    for(size_t alignment: { 1, 8, 16, 64, 256, 4096 }) {
+        for(size_t size: { 8, 100, 1000, 5000, 100000 }) {
+            void* buffer = pool.allocate(size, alignment);
+            EXPECT_EQ((size_t)buffer & (alignment - 1), 0u);
+            memset(buffer, 0xff, size);
+            EXPECT_TRUE(pool.release(buffer));
+        }
+    }
+    EXPECT_FALSE(pool.release(&pool));
+}
+
+TEST_F(MemoryPoolBenchmark, Budget)
+{
+    const size_t block = 1024*1024;
+    MemoryPool pool(4*block);
+
+    // Released blocks are cached within the budget:
+    std::vector<void*> buffers;
+    for(int i=0; i<4; ++i) {
+        buffers.push_back(pool.allocate(block, 16));
+    }
+    EXPECT_EQ(pool.getStats().overruns, 0u);
+    for(void* buffer: buffers) {
+        pool.release(buffer);
+    }
+    EXPECT_EQ(pool.getStats().cachedBytes, 4*block);
+
+    // A block of another class releases the cached ones above the budget:
+    void* large = pool.allocate(2*block, 16);
+    EXPECT_EQ(pool.getStats().cachedBytes, 2*block);
+    EXPECT_EQ(pool.getStats().trims, 2u);
+
+    // The allocations above the budget are served and counted:
+    buffers.clear();
+    for(int i=0; i<3; ++i) {
+        buffers.push_back(pool.allocate(block, 16));
+    }
+    EXPECT_EQ(pool.getStats().cachedBytes, 0u);
+    EXPECT_EQ(pool.getStats().overruns, 1u);
+
+    pool.release(large);
+    for(void* buffer: buffers) {
+        pool.release(buffer);
+    }
+    EXPECT_EQ(pool.getStats().liveBytes, 0u);
+    EXPECT_LE(pool.getStats().cachedBytes, 4*block);
+
+    pool.trim();
+    EXPECT_EQ(pool.getStats().cachedBytes, 0u);
+}
+
+TEST_F(MemoryPoolBenchmark, ReleaseSlabs)
+{
+    MemoryPool pool;
+
+    // Scratch objects of a level, spread over the small size classes:
+    std::vector<void*> objects;
+    for(int i=0; i<20000; ++i) {
+        objects.push_back(pool.allocate(16 + (i*24)%512, 8));
+    }
+    unsigned int slabs = pool.getStats().slabs;
+    EXPECT_GT(slabs, 1u);
+
+    // A slab with a live chunk is kept:
+    void* kept = objects.front();
+    for(size_t i=1; i<objects.size(); ++i) {
+        pool.release(objects[i]);
+    }
+    pool.trim();
+    MemoryPool::Stats stats = pool.getStats();
+    EXPECT_EQ(stats.slabs, 1u);
+    EXPECT_EQ(stats.releasedSlabs, slabs - 1);
+    EXPECT_EQ(stats.slabBytes - stats.slabFreeBytes, MemoryPool::getSizeClass(16));
+
+    // The chunks of the released slabs are not handed out again:
+    void* other = pool.allocate(16 + 24, 8);
+    EXPECT_TRUE(pool.contains(other));
+    EXPECT_EQ(pool.getStats().slabs, 2u);
+
+    // The level is unloaded:
+    pool.release(kept);
+    pool.release(other);
+    pool.trim();
+    stats = pool.getStats();
+    EXPECT_EQ(stats.slabs, 0u);
+    EXPECT_EQ(stats.slabBytes, 0u);
+    EXPECT_EQ(stats.slabFreeBytes, 0u);
+    EXPECT_EQ(stats.liveBytes, 0u);
+
+    // The pool carves new slabs afterwards:
+    void* again = pool.allocate(100, 16);
+    EXPECT_EQ(pool.getStats().slabs, 1u);
+    pool.release(again);
+}
+
+TEST_F(MemoryPoolBenchmark, Owners)
+{
+    MemoryPool pool;
+    void* a = pool.allocate(100000, 16, 1);
+    void* b = pool.allocate(100, 16, 2);
+    void* c = pool.allocate(100000, 16);
+
+    auto owners = pool.getOwnerBytes();
+    EXPECT_EQ(owners[1], MemoryPool::getSizeClass(100000));
+    EXPECT_EQ(owners[2], MemoryPool::getSizeClass(100));
+
+    // A result buffer handed over to the texture loader leaves the pool:
+    pool.setOwner(c, 2);
+    EXPECT_TRUE(pool.isArrayAllocated(c));
+    EXPECT_FALSE(pool.isArrayAllocated(b));
+    pool.detach(c);
+    EXPECT_FALSE(pool.contains(c));
+    delete [] (unsigned char*)c;
+
+    owners = pool.getOwnerBytes();
+    EXPECT_EQ(owners[2], MemoryPool::getSizeClass(100));
+
+    pool.release(a);
+    pool.release(b);
+    EXPECT_EQ(pool.getStats().liveBytes, 0u);
+}
@@ -0,0 +1,169 @@
+/** @file RendererPoolBenchmark.cpp
+	@brief Benchmark of the renderer pool
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include <AzTest/AzTest.h>
+#include "RendererPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+class RendererPoolBenchmark
+    : public ::testing::Test
+{
+protected:
+    // Small materials of a level, with a few larger ones:
+    static const int kMaterialCount = 96;
+
+    // Stand-in for the render of a small material: a few octaves of value noise on a 128x128 image,
+    // single threaded like the small graphs which don't scale within the engine.
+    static float RenderMaterial(int material, int size)
+    {
+        float sum = 0.0f;
+        for(int y=0; y<size; ++y) {
+            for(int x=0; x<size; ++x) {
+                float v = 0.0f;
+                float scale = 1.0f;
+                for(int o=0; o<4; ++o) {
+                    v += scale*sinf((x + material)*0.11f/scale)*cosf(y*0.07f/scale);
+                    scale *= 0.5f;
+                }
+                sum += v;
+            }
+        }
+        return sum;
+    }
+
+    static int GetMaterialSize(int material, bool skewed)
+    {
+        // One material out of eight is four times larger in the skewed set:
+        return skewed && material%8 == 0 ? 256 : 128;
+    }
+
+    // Render all the materials and return the throughput in materials/s:
+    double Run(int poolSize, bool skewed, RendererPool::Stats& stats)
+    {
+        RendererPool pool(poolSize, poolSize, (size_t)512*1024*1024, RendererPool::RendererFactory());
+        std::vector<float> results(kMaterialCount, 0.0f);
+        std::atomic<int> count(0);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int m=0; m<kMaterialCount; ++m) {
+            pool.submit([m, skewed, &results, &count](SubstanceAir::Renderer* renderer) {
+                EXPECT_EQ(renderer, nullptr);
+                results[m] = RenderMaterial(m, GetMaterialSize(m, skewed));
+                count++;
+            });
+        }
+        pool.wait();
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        // All the materials are rendered once, whichever worker ran them:
+        EXPECT_EQ((size_t)count.load(), results.size());
+        for(int m=0; m<kMaterialCount; ++m) {
+            EXPECT_EQ(results[m], RenderMaterial(m, GetMaterialSize(m, skewed)));
+        }
+
+        stats = pool.getStats();
+        EXPECT_EQ((size_t)stats.tasks, results.size());
+        return kMaterialCount/seconds;
+    }
+
+    void RunBenchmark(bool skewed, const char* name)
+    {
+        int cores = (int)std::max(std::thread::hardware_concurrency(), 1u);
+        double reference = 0.0;
+        for(int size: { 1, 2, 4, 8, 16, 32 }) {
+            if(size > 1 && size > 2*cores) {
+                break;
+            }
+
+            RendererPool::Stats stats;
+            double rate = Run(size, skewed, stats);
+            if(size == 1) {
+                reference = rate;
+            }
+            printf("[%s] %2d renderers: %8.1f materials/s (x%.2f, %u steals)\n", name, size, rate, rate/reference, stats.steals);
+        }
+    }
+};
+
+TEST_F(RendererPoolBenchmark, SmallMaterials)
+{
+    RunBenchmark(false, "Small");
+}
+
+TEST_F(RendererPoolBenchmark, SkewedMaterials)
+{
+    RunBenchmark(true, "Skewed");
+}
+
+TEST_F(RendererPoolBenchmark, WorkerOptions)
+{
+    // The cores and the memory budget are shared between the renderers:
+    SubstanceAir::RenderOptions options = RendererPool::getWorkerOptions(4, 32, (size_t)512*1024*1024);
+    EXPECT_EQ(options.mCoresCount, 8u);
+    EXPECT_EQ(options.mMemoryBudget, (size_t)128*1024*1024);
+
+    options = RendererPool::getWorkerOptions(8, 4, (size_t)64*1024*1024);
+    EXPECT_EQ(options.mCoresCount, 1u);
+    EXPECT_EQ(options.mMemoryBudget, (size_t)16*1024*1024);
+}
+
+TEST_F(RendererPoolBenchmark, CancelAll)
+{
+    RendererPool pool(1, 1, (size_t)64*1024*1024, RendererPool::RendererFactory());
+
+    // Keep the worker busy while the other tasks are queued:
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    pool.submit([&started, &release](SubstanceAir::Renderer*) {
+        started = true;
+        while(!release) {
+            std::this_thread::yield();
+        }
+    });
+    while(!started) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<int> count(0);
+    for(int i=0; i<16; ++i) {
+        pool.submit([&count](SubstanceAir::Renderer*) { count++; });
+    }
+
+    // A caller waiting for a cancelled task is released, once its task is queued behind the other ones:
+    bool ran = true;
+    std::thread waiter([&pool, &ran]() {
+        ran = pool.run([](SubstanceAir::Renderer*) {});
+    });
+    while(pool.getStats().queued < 17) {
+        std::this_thread::yield();
+    }
+
+    std::thread canceller([&pool]() {
+        pool.cancelAll();
+    });
+    while(pool.getStats().cancelled == 0) {
+        std::this_thread::yield();
+    }
+    release = true;
+    canceller.join();
+    waiter.join();
+
+    EXPECT_FALSE(ran);
+    EXPECT_EQ(count.load(), 0);
+    EXPECT_EQ(pool.getStats().cancelled, 17u);
+    EXPECT_EQ(pool.getStats().tasks, 1u);
+
+    // The pool is still usable:
+    EXPECT_TRUE(pool.run([&count](SubstanceAir::Renderer*) { count++; }));
+    EXPECT_EQ(count.load(), 1);
+}
@@ -0,0 +1,174 @@
+/** @file SpecializationBenchmark.cpp
+	@brief Benchmark of the input specialization
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include <AzTest/AzTest.h>
+
+#if defined(USE_SUBSTANCE)
+#include "GraphInstance.h"
+#include "GraphInput.h"
+#include "GraphOutput.h"
+#include "MaterialRegistry.h"
+#include "RenderSettings.h"
+#include "SubstanceMaterial.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+// Before/after benchmark of the input specialization on a material, set with SUBSTANCE_SPECIALIZATION_MATERIAL
+// (material.smtl path) and SUBSTANCE_SPECIALIZATION_CHANGES (number of input changes, 16 by default).
+// Each graph of the material is rendered on a dedicated renderer, once from scratch and then after each change
+// of a runtime input, first with no input cached, then with the specialized inputs (the static inputs locked
+// and the other ones cached). The engine doesn't expose its own memory use, which is bounded by
+// substance_memoryBudget in both cases.
+class SpecializationBenchmark
+    : public ::testing::Test
+{
+protected:
+    struct Result
+    {
+        double firstMs;         // Render from scratch
+        double changeMs;        // Average render after an input change
+        size_t outputBytes;     // Size of the outputs rendered from scratch
+    };
+
+    static double GetTime()
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Release the results of a graph, which must not outlive the renderer:
+    static size_t ReleaseResults(GraphInstance* graph)
+    {
+        size_t bytes = 0;
+        for(int i=0; i<graph->GetOutputCount(); ++i) {
+            GraphOutput* out = (GraphOutput*)graph->GetOutput(i);
+            auto output = graph->getInstance()->findOutput(out->GetGraphOutputID());
+            for(auto result = output->grabResult(); result; result = output->grabResult()) {
+                const SubstanceTexture& texture = result->getTexture();
+                bytes += out->GetLevelSize((int)texture.pixelFormat, (int)texture.level0Width, (int)texture.level0Height);
+            }
+        }
+
+        return bytes;
+    }
+
+    // Render a graph with or without the specialized inputs:
+    static Result Render(GraphInstance* graph, bool specialized, int changes)
+    {
+        // The inputs changed by the benchmark are the numerical inputs which are not static:
+        std::vector<GraphInput*> inputs;
+        std::vector<GraphValueVariant> values;
+        std::vector<bool> cached;
+        for(int i=0; i<graph->GetInputCount(); ++i) {
+            GraphInput* in = (GraphInput*)graph->GetInput(i);
+            auto instance = in->getInstance();
+            cached.push_back(instance->mUseCache);
+            instance->mUseCache = specialized && !in->isStatic() && !instance->mIsHeavyDuty;
+            if(!in->isStatic() && instance->mDesc.isNumerical()) {
+                inputs.push_back(in);
+                values.push_back(in->GetValue());
+            }
+        }
+
+        Result result;
+        SubstanceAir::Renderer renderer(RenderSettings::readOptions());
+
+        // Render from scratch:
+        for(auto output: graph->getInstance()->getOutputs()) {
+            output->flagAsDirty();
+        }
+        double start = GetTime();
+        renderer.push(*(graph->getInstance()));
+        renderer.run();
+        result.firstMs = GetTime() - start;
+        result.outputBytes = ReleaseResults(graph);
+
+        // Render after each input change, going back and forth between the bounds of the inputs:
+        double total = 0.0;
+        int count = 0;
+        for(int i=0; i<changes && !inputs.empty(); ++i) {
+            GraphInput* in = inputs[i % inputs.size()];
+            GraphValueVariant minValue = in->GetMinValue();
+            in->SetValue(in->GetValue() != minValue ? minValue : in->GetMaxValue());
+
+            // SetValue() caches the changed inputs when specializing:
+            auto instance = in->getInstance();
+            instance->mUseCache = specialized && !instance->mIsHeavyDuty;
+
+            start = GetTime();
+            renderer.push(*(graph->getInstance()));
+            renderer.run();
+            total += GetTime() - start;
+            count++;
+            ReleaseResults(graph);
+        }
+        result.changeMs = count > 0 ? total/count : 0.0;
+
+        // Restore the inputs:
+        for(size_t i=0; i<inputs.size(); ++i) {
+            inputs[i]->SetValue(values[i]);
+        }
+        for(int i=0; i<graph->GetInputCount(); ++i) {
+            ((GraphInput*)graph->GetInput(i))->getInstance()->mUseCache = cached[i];
+        }
+
+        return result;
+    }
+};
+
+INTEG_TEST_F(SpecializationBenchmark, Material)
+{
+    // The material is loaded by the gem, which needs the engine:
+    const char* smtlPath = getenv("SUBSTANCE_SPECIALIZATION_MATERIAL");
+    if(!smtlPath || !gEnv || !gEnv->pSystem) {
+        printf("[Specialization] skipped, SUBSTANCE_SPECIALIZATION_MATERIAL is not set or the engine is not running\n");
+        return;
+    }
+    const char* changesValue = getenv("SUBSTANCE_SPECIALIZATION_CHANGES");
+    int changes = changesValue ? std::max(atoi(changesValue), 0) : 16;
+
+    SubstanceMaterial* smat = MaterialRegistry::instance().acquire(smtlPath, true);
+    ASSERT_NE(smat, nullptr);
+    if(!smat->getPackage() || !smat->getPackage()->isValid()) {
+        smat->Release();
+        FAIL() << "Cannot load procedural material " << smtlPath;
+    }
+
+    const SubstanceAir::string* assembly = smat->getPackage()->getAssemblyData();
+    printf("[Specialization] %s (%.2f KB assembly, %d input changes):\n", smtlPath,
+        assembly ? assembly->size()/1024.0f : 0.0f, changes);
+
+    for(int g=0; g<smat->GetGraphInstanceCount(); ++g) {
+        GraphInstance* graph = (GraphInstance*)smat->GetGraphInstance(g);
+
+        int staticCount = 0;
+        for(int i=0; i<graph->GetInputCount(); ++i) {
+            staticCount += ((GraphInput*)graph->GetInput(i))->isStatic() ? 1 : 0;
+        }
+
+        // The renderers of the gem must not push this graph meanwhile:
+        CryAutoCriticalSection graphLock(graph->getRenderLock());
+        Result before = Render(graph, false, changes);
+        Result after = Render(graph, true, changes);
+
+        printf("[Specialization]   %s: %d inputs, %d static\n", graph->GetName(), graph->GetInputCount(), staticCount);
+        printf("[Specialization]     before: %.2f ms from scratch, %.2f ms per input change, %.2f MB of outputs\n",
+            before.firstMs, before.changeMs, before.outputBytes/(1024.0f*1024.0f));
+        printf("[Specialization]     after:  %.2f ms from scratch, %.2f ms per input change, %.2f MB of outputs\n",
+            after.firstMs, after.changeMs, after.outputBytes/(1024.0f*1024.0f));
+
+        // The cached inputs don't change the rendered outputs:
+        EXPECT_EQ(after.outputBytes, before.outputBytes);
+    }
+
+    smat->Release();
+}
+
+#endif // USE_SUBSTANCE
@@ -0,0 +1,407 @@
+/** @file StandInRenderer.cpp
+	@brief Source File for the CPU stand-in of the substance engine used by the tests
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#include "StdAfx.h"
+
+#include "StandInRenderer.h"
+
+#if !defined(USE_SUBSTANCE)
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace SubstanceAir;
+
+static StandInEngine::Settings s_settings = { 0.25f, 64 };
+
+// Clock of the completion times, shared by all the renderers:
+static double getTime()
+{
+	static const auto origin = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+}
+
+static unsigned int hashPixel(UInt graphUid, UInt outputIndex, int x, int y)
+{
+	unsigned int h = graphUid*0x9E3779B1u ^ outputIndex*0x85EBCA77u ^ (unsigned int)x*0xC2B2AE3Du ^ (unsigned int)y*0x27D4EB2Fu;
+	h ^= h >> 15;
+	h *= 0x2C1B3C6Du;
+	h ^= h >> 12;
+	return h;
+}
+
+namespace SubstanceAir
+{
+namespace Details
+{
+
+class RendererImpl
+{
+public:
+	explicit RendererImpl(const StandInEngine::Settings& settings)
+		: _settings(settings), _callbacks(nullptr), _nextRunUid(1), _running(0), _held(false), _stop(false)
+	{
+		_thread = std::thread(&RendererImpl::work, this);
+	}
+
+	~RendererImpl()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_jobs.clear();
+			_stop = true;
+		}
+		_wakeup.notify_all();
+		_thread.join();
+	}
+
+	void push(UInt graphUid, UInt outputCount)
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		for(UInt i=0; i<outputCount; ++i) {
+			_pushed.push_back(Item(graphUid, i));
+		}
+	}
+
+	UInt run(UInt runOptions, size_t userData)
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		if(_pushed.empty()) {
+			return 0;
+		}
+
+		Job job;
+		job.runUid = _nextRunUid++;
+		job.userData = userData;
+		job.items.assign(_pushed.begin(), _pushed.end());
+		_pushed.clear();
+
+		if(runOptions & Renderer::Run_Replace) {
+			// Drop the outdated outputs of the pushed graphs, the output being computed is kept:
+			std::set<UInt> graphs;
+			for(const Item& item: job.items) {
+				graphs.insert(item.graphUid);
+			}
+			for(auto it = _jobs.begin(); it != _jobs.end();) {
+				it->items.erase(std::remove_if(it->items.begin(), it->items.end(),
+					[&graphs](const Item& item) { return graphs.count(item.graphUid) > 0; }), it->items.end());
+				it = it->items.empty() ? _jobs.erase(it) : it + 1;
+			}
+		}
+
+		UInt runUid = job.runUid;
+		if(runOptions & Renderer::Run_First) {
+			bool preserve = (runOptions & Renderer::Run_PreserveRun) && !_jobs.empty() && _jobs.front().runUid == _running;
+			_jobs.insert(_jobs.begin() + (preserve ? 1 : 0), job);
+		}
+		else {
+			_jobs.push_back(job);
+		}
+		_wakeup.notify_all();
+
+		if(!(runOptions & Renderer::Run_Asynchronous)) {
+			_done.wait(lock, [this, runUid]() { return !isPendingLocked(runUid); });
+		}
+		return runUid;
+	}
+
+	bool cancel(UInt runUid)
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		auto it = std::find_if(_jobs.begin(), _jobs.end(), [runUid](const Job& job) { return job.runUid == runUid; });
+		if(it == _jobs.end()) {
+			return false;
+		}
+		_jobs.erase(it);
+		_done.notify_all();
+		return true;
+	}
+
+	void cancelAll()
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_jobs.clear();
+		_done.notify_all();
+	}
+
+	bool isPending(UInt runUid) const
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		return isPendingLocked(runUid);
+	}
+
+	void hold()
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_held = true;
+	}
+
+	void resume()
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_held = false;
+		_wakeup.notify_all();
+	}
+
+	void flush()
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		_done.wait(lock, [this]() { return _jobs.empty() && _running == 0; });
+	}
+
+	void setCallbacks(RenderCallbacks* callbacks)
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_callbacks = callbacks;
+	}
+
+	std::vector<StandInEngine::ComputedOutput> grabComputed()
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		std::vector<StandInEngine::ComputedOutput> computed;
+		computed.swap(_computed);
+		return computed;
+	}
+
+protected:
+	struct Item
+	{
+		Item(UInt graph, UInt output) : graphUid(graph), outputIndex(output) {}
+
+		UInt graphUid;
+		UInt outputIndex;
+	};
+
+	struct Job
+	{
+		UInt runUid;
+		size_t userData;
+		std::deque<Item> items;
+	};
+
+	bool isPendingLocked(UInt runUid) const
+	{
+		return _running == runUid || std::any_of(_jobs.begin(), _jobs.end(), [runUid](const Job& job) { return job.runUid == runUid; });
+	}
+
+	// Fill the pixels of an output, then spin for the rest of its cost:
+	unsigned int computeOutput(const Item& item)
+	{
+		double start = getTime();
+		int size = std::max(_settings.outputSize, 1);
+		_pixels.resize((size_t)size*size);
+
+		unsigned int checksum = 2166136261u;
+		for(int y=0; y<size; ++y) {
+			for(int x=0; x<size; ++x) {
+				unsigned int pixel = hashPixel(item.graphUid, item.outputIndex, x, y);
+				_pixels[(size_t)y*size + x] = pixel;
+				checksum = (checksum ^ pixel)*16777619u;
+			}
+		}
+
+		while(getTime() - start < _settings.outputCostMs) {
+		}
+		return checksum;
+	}
+
+	// Render thread loop:
+	void work()
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		for(;;) {
+			_wakeup.wait(lock, [this]() { return _stop || (!_held && !_jobs.empty()); });
+			if(_stop) {
+				break;
+			}
+
+			// The running job stays in front of the queue until its last output:
+			Job& job = _jobs.front();
+			Item item = job.items.front();
+			job.items.pop_front();
+			UInt runUid = job.runUid;
+			size_t userData = job.userData;
+			_running = runUid;
+			if(job.items.empty()) {
+				_jobs.pop_front();
+			}
+
+			lock.unlock();
+			unsigned int checksum = computeOutput(item);
+			lock.lock();
+
+			StandInEngine::ComputedOutput computed = { runUid, item.graphUid, item.outputIndex, checksum, getTime() };
+			_computed.push_back(computed);
+			RenderCallbacks* callbacks = _callbacks;
+
+			if(callbacks) {
+				lock.unlock();
+				callbacks->outputComputed(runUid, userData, nullptr, nullptr);
+				lock.lock();
+			}
+
+			_running = 0;
+			_done.notify_all();
+		}
+	}
+
+	const StandInEngine::Settings _settings;
+	RenderCallbacks* _callbacks;
+	std::vector<Item> _pushed;
+	std::deque<Job> _jobs;
+	std::vector<StandInEngine::ComputedOutput> _computed;
+	std::vector<unsigned int> _pixels;
+	UInt _nextRunUid;
+	UInt _running;			// Run of the output being computed, 0 if idle
+	bool _held;
+	bool _stop;
+
+	mutable std::mutex _lock;
+	std::condition_variable _wakeup;
+	std::condition_variable _done;
+	std::thread _thread;
+};
+
+} // namespace Details
+
+Renderer::Renderer(const RenderOptions& renderOptions, void* module)
+	: mRendererImpl(new Details::RendererImpl(StandInEngine::getSettings()))
+{
+}
+
+Renderer::~Renderer()
+{
+	delete mRendererImpl;
+}
+
+void Renderer::push(GraphInstance& graphInstance)
+{
+	mRendererImpl->push(graphInstance.mInstanceUid, (UInt)graphInstance.getOutputs().size());
+}
+
+void Renderer::push(const GraphInstances& graphInstances)
+{
+	for(const auto& graphInstance: graphInstances) {
+		push(*graphInstance.get());
+	}
+}
+
+UInt Renderer::run(UInt runOptions, size_t userData)
+{
+	return mRendererImpl->run(runOptions, userData);
+}
+
+bool Renderer::cancel(UInt runUid)
+{
+	return mRendererImpl->cancel(runUid);
+}
+
+void Renderer::cancelAll()
+{
+	mRendererImpl->cancelAll();
+}
+
+bool Renderer::isPending(UInt runUid) const
+{
+	return mRendererImpl->isPending(runUid);
+}
+
+void Renderer::hold()
+{
+	mRendererImpl->hold();
+}
+
+void Renderer::resume()
+{
+	mRendererImpl->resume();
+}
+
+void Renderer::flush()
+{
+	mRendererImpl->flush();
+}
+
+void Renderer::setOptions(const RenderOptions& renderOptions)
+{
+}
+
+void Renderer::setRenderCallbacks(RenderCallbacks* callbacks)
+{
+	mRendererImpl->setCallbacks(callbacks);
+}
+
+bool Renderer::switchEngineLibrary(void* module)
+{
+	return false;
+}
+
+SubstanceVersion Renderer::getCurrentVersion() const
+{
+	SubstanceVersion version;
+	memset(&version, 0, sizeof(version));
+	version.platformImplName = "StandIn";
+	return version;
+}
+
+RenderCallbacks::~RenderCallbacks()
+{
+}
+
+void RenderCallbacks::outputComputed(UInt runUid, size_t userData, const GraphInstance* graphInstance, OutputInstance* outputInstance)
+{
+	outputComputed(runUid, graphInstance, outputInstance);
+}
+
+void RenderCallbacks::outputComputed(UInt runUid, const GraphInstance* graphInstance, OutputInstance* outputInstance)
+{
+}
+
+bool RenderCallbacks::runRenderProcess(RenderFunction renderFunction, void* renderParams)
+{
+	return false;
+}
+
+void RenderCallbacks::fillSubstanceDevice(SubstanceEngineIDEnum platformId, SubstanceDevice_* substanceDevice)
+{
+}
+
+} // namespace SubstanceAir
+
+// Access to the implementation of a renderer:
+struct RendererAccess : SubstanceAir::Renderer
+{
+	static Details::RendererImpl* get(SubstanceAir::Renderer& renderer)
+	{
+		return renderer.*(&RendererAccess::mRendererImpl);
+	}
+};
+
+void StandInEngine::setSettings(const Settings& settings)
+{
+	s_settings = settings;
+}
+
+StandInEngine::Settings StandInEngine::getSettings()
+{
+	return s_settings;
+}
+
+void StandInEngine::push(SubstanceAir::Renderer& renderer, SubstanceAir::UInt graphUid, SubstanceAir::UInt outputCount)
+{
+	RendererAccess::get(renderer)->push(graphUid, outputCount);
+}
+
+std::vector<StandInEngine::ComputedOutput> StandInEngine::grabComputed(SubstanceAir::Renderer& renderer)
+{
+	return RendererAccess::get(renderer)->grabComputed();
+}
+
+#endif // !USE_SUBSTANCE
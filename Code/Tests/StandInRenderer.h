@@ -0,0 +1,67 @@
+/** @file StandInRenderer.h
+	@brief Header for the CPU stand-in of the substance engine used by the tests
+	@author Emmanuel ROCHE
+	@date 16/10/2026
+	@copyright Emmanuel ROCHE. All rights reserved.
+*/
+#ifndef GEM_SUBSTANCE_STANDINRENDERER_H
+#define GEM_SUBSTANCE_STANDINRENDERER_H
+#pragma once
+
+#include "Substance/framework/renderer.h"
+#include <vector>
+
+#if !defined(USE_SUBSTANCE)
+
+/**
+ Deterministic CPU stand-in of the substance engine, behind the framework renderer.
+
+ The framework and engine libraries are only shipped for Windows. On the other
+ platforms the test target implements SubstanceAir::Renderer with this stand-in,
+ so that the render scheduling of the gem can be benchmarked in CI.
+
+ Each renderer computes its outputs on its own thread, one at a time and in job
+ order. An output is an RGBA8 image filled from a hash of its graph and output
+ index, so its contents only depend on what was rendered, and it takes at least
+ the configured cost. The run options behave like the framework ones:
+ - Run_Asynchronous: run() returns once the job is queued, and not computed,
+ - Run_Replace: the outputs of the pushed graphs are removed from the queued jobs,
+ - Run_First: the job is queued ahead of the other jobs, and runs after the
+   current output, or after the running job with Run_PreserveRun.
+ hold() pauses the renderer after its current output, so a synchronous run on a
+ held renderer never completes.
+ The outputs are reported to the render callbacks without graph or output instance.
+*/
+namespace StandInEngine
+{
+	struct Settings
+	{
+		float outputCostMs;		// Minimum compute time of an output
+		int outputSize;			// Width and height of the outputs
+	};
+
+	struct ComputedOutput
+	{
+		SubstanceAir::UInt runUid;
+		SubstanceAir::UInt graphUid;
+		SubstanceAir::UInt outputIndex;
+		unsigned int checksum;	// Hash of the output pixels
+		double time;			// Completion time, in ms on a clock shared by all the renderers
+	};
+
+	/// Set the settings of the renderers created afterwards (0.25 ms, 64x64 by default).
+	void setSettings(const Settings& settings);
+
+	/// Retrieve the settings of the new renderers.
+	Settings getSettings();
+
+	/// Push the outputs of a synthetic graph for the next run, like Renderer::push() does for a graph instance.
+	void push(SubstanceAir::Renderer& renderer, SubstanceAir::UInt graphUid, SubstanceAir::UInt outputCount);
+
+	/// Retrieve and clear the outputs computed by a renderer, in computation order.
+	std::vector<ComputedOutput> grabComputed(SubstanceAir::Renderer& renderer);
+}
+
+#endif // !USE_SUBSTANCE
+
+#endif //GEM_SUBSTANCE_STANDINRENDERER_H